@@ -0,0 +1,123 @@
+// File: affinity.c
+// Name: Bradley Stephen
+// Date: October 16, 2026
+// Assignment: MP1 - Thread Placement
+//
+// Description:
+//   Linux implementation of affinity.h using sched_getaffinity, pthread_setaffinity_np,
+//   sched_getcpu and /sys/devices/system/cpu/cpuN/nodeM.
+// Usage:
+//   Compile together with a driver and link with -lpthread.
+//
+#define _GNU_SOURCE
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "affinity.h"
+
+static cpu_set_t allowed;   // Process affinity mask saved by affinity_init.
+static int allowed_valid = 0;
+
+void affinity_init(void) {
+    CPU_ZERO(&allowed);
+    allowed_valid = (sched_getaffinity(0, sizeof(allowed), &allowed) == 0);
+}
+
+int pin_policy_parse(const char *name, pin_policy_t *policy) {
+    if (strcmp(name, "none") == 0) *policy = PIN_NONE;
+    else if (strcmp(name, "compact") == 0) *policy = PIN_COMPACT;
+    else if (strcmp(name, "spread") == 0) *policy = PIN_SPREAD;
+    else return -1;
+    return 0;
+}
+
+const char* pin_policy_name(pin_policy_t policy) {
+    switch (policy) {
+    case PIN_NONE:    return "none";
+    case PIN_COMPACT: return "compact";
+    case PIN_SPREAD:  return "spread";
+    }
+    return "unknown";
+}
+
+int affinity_cpu_for(int tid, int nthreads, pin_policy_t policy) {
+    if (policy == PIN_NONE) {
+        return -1;
+    }
+    if (!allowed_valid) {
+        affinity_init();
+        if (!allowed_valid) {
+            return -1;
+        }
+    }
+    int count = CPU_COUNT(&allowed);
+    if (count == 0) {
+        return -1;
+    }
+    // Index into the allowed CPUs; wrap around when there are more threads than CPUs.
+    long index;
+    if (policy == PIN_SPREAD && nthreads < count) {
+        index = (long) tid * count / nthreads;
+    } else {
+        index = tid % count;
+    }
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (CPU_ISSET(cpu, &allowed) && index-- == 0) {
+            return cpu;
+        }
+    }
+    return -1;
+}
+
+int affinity_pin_self(int cpu) {
+    if (cpu < 0) {
+        return 0;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+int affinity_current_cpu(void) {
+    return sched_getcpu();
+}
+
+int affinity_numa_node(int cpu) {
+    if (cpu < 0) {
+        return -1;
+    }
+    char path[64];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d", cpu);
+    DIR *dir = opendir(path);
+    if (!dir) {
+        return -1;
+    }
+    int node = -1;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (sscanf(entry->d_name, "node%d", &node) == 1) {
+            break;
+        }
+        node = -1;
+    }
+    closedir(dir);
+    return node;
+}
+
+void affinity_omp_binding(char *buf, int len) {
+    const char *bind = getenv("OMP_PROC_BIND");
+    const char *places = getenv("OMP_PLACES");
+    snprintf(buf, len, "OMP_PROC_BIND=%s, OMP_PLACES=%s", bind ? bind : "unset", places ? places : "unset");
+}
+
+void affinity_report(const char *how, int nthreads, const int *cpus) {
+    printf("Placement (%s):", how);
+    for (int t = 0; t < nthreads; t++) {
+        printf(" t%d=cpu%d/node%d", t, cpus[t], affinity_numa_node(cpus[t]));
+    }
+    printf("\n");
+}
@@ -0,0 +1,46 @@
+// File: affinity.h
+// Name: Bradley Stephen
+// Date: October 16, 2026
+// Assignment: MP1 - Thread Placement
+//
+// Description:
+//   Thread pinning and placement reporting for the shared-memory benchmarks.
+//   CPUs are taken from the process affinity mask (so taskset/cgroups are respected) and
+//   NUMA nodes are read from sysfs, so no libnuma is needed.
+//     compact - thread t runs on the t-th allowed CPU
+//     spread  - threads are spaced evenly over the allowed CPUs (and therefore over sockets)
+//
+#ifndef AFFINITY_H
+#define AFFINITY_H
+
+typedef enum { PIN_NONE, PIN_COMPACT, PIN_SPREAD } pin_policy_t;
+
+// Record the process affinity mask. Call once at startup, before any thread is pinned,
+// because threads created later inherit the creator's (possibly pinned) mask.
+void affinity_init(void);
+
+// Parse "none", "compact" or "spread". Returns 0 on success, -1 otherwise.
+int pin_policy_parse(const char *name, pin_policy_t *policy);
+const char* pin_policy_name(pin_policy_t policy);
+
+// CPU that thread tid of nthreads should use under the policy (from the mask saved by
+// affinity_init), or -1 for PIN_NONE.
+int affinity_cpu_for(int tid, int nthreads, pin_policy_t policy);
+
+// Pin the calling thread to one CPU. Returns 0 on success, an errno value otherwise.
+int affinity_pin_self(int cpu);
+
+// CPU the calling thread is running on right now (-1 if unknown).
+int affinity_current_cpu(void);
+
+// NUMA node of a CPU, or -1 if sysfs does not say.
+int affinity_numa_node(int cpu);
+
+// Describe the OpenMP binding in effect ("OMP_PROC_BIND=close, OMP_PLACES=cores").
+// OpenMP programs bind through these variables; the value "unset" means the runtime default.
+void affinity_omp_binding(char *buf, int len);
+
+// Print "Placement (<how>): t0=cpuA/nodeX t1=..." for the CPUs the threads were seen on.
+void affinity_report(const char *how, int nthreads, const int *cpus);
+
+#endif
@@ -0,0 +1,82 @@
+// File: arena.c
+// Name: Bradley Stephen
+// Date: October 16, 2026
+// Assignment: MP1 - Benchmark Memory Arena
+//
+// Description:
+//   mmap-backed implementation of arena.h. MAP_HUGETLB needs pages reserved in
+//   /proc/sys/vm/nr_hugepages, so it commonly fails; the fallback maps normal pages
+//   aligned to 2 MB and asks for transparent huge pages with madvise.
+//
+#define _GNU_SOURCE
+#include <stdint.h>
+#include <sys/mman.h>
+#include "arena.h"
+
+#define HUGE_PAGE_SIZE (2UL * 1024 * 1024)
+
+int arena_init(arena_t *arena, size_t bytes) {
+    size_t size = (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    if (size == 0) {
+        size = HUGE_PAGE_SIZE;
+    }
+    arena->used = 0;
+    arena->size = size;
+
+#ifdef MAP_HUGETLB
+    void *p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (p != MAP_FAILED) {
+        arena->base = (char*) p;
+        arena->pages = ARENA_HUGETLB;
+        return 0;
+    }
+#endif
+
+    // Over-map by one huge page so the arena can start on a 2 MB boundary, then trim.
+    char *raw = (char*) mmap(NULL, size + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) {
+        arena->base = NULL;
+        arena->size = 0;
+        return -1;
+    }
+    char *aligned = (char*) (((uintptr_t) raw + HUGE_PAGE_SIZE - 1) & ~(uintptr_t) (HUGE_PAGE_SIZE - 1));
+    if (aligned > raw) {
+        munmap(raw, aligned - raw);
+    }
+    munmap(aligned + size, (raw + HUGE_PAGE_SIZE) - aligned);
+    arena->base = aligned;
+    arena->pages = ARENA_NORMAL;
+#ifdef MADV_HUGEPAGE
+    if (madvise(aligned, size, MADV_HUGEPAGE) == 0) {
+        arena->pages = ARENA_THP;
+    }
+#endif
+    return 0;
+}
+
+void* arena_alloc(arena_t *arena, size_t bytes, size_t align) {
+    size_t start = (arena->used + align - 1) & ~(align - 1);
+    if (start + bytes > arena->size) {
+        return NULL;
+    }
+    arena->used = start + bytes;
+    return arena->base + start;
+}
+
+void arena_destroy(arena_t *arena) {
+    if (arena->base) {
+        munmap(arena->base, arena->size);
+    }
+    arena->base = NULL;
+    arena->size = arena->used = 0;
+}
+
+const char* arena_pages_name(const arena_t *arena) {
+    switch (arena->pages) {
+    case ARENA_HUGETLB: return "hugetlb";
+    case ARENA_THP:     return "thp";
+    case ARENA_NORMAL:  return "normal";
+    }
+    return "unknown";
+}
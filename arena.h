@@ -0,0 +1,38 @@
+// File: arena.h
+// Name: Bradley Stephen
+// Date: October 16, 2026
+// Assignment: MP1 - Benchmark Memory Arena
+//
+// Description:
+//   Bump allocator over one large mapping, used to allocate and warm the benchmark data once
+//   and reuse it across runs. The mapping is backed by explicit huge pages (MAP_HUGETLB) when
+//   the system has them reserved, otherwise by normal pages with MADV_HUGEPAGE so transparent
+//   huge pages can back it. Individual allocations are never freed; the whole arena is.
+//
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+typedef enum { ARENA_HUGETLB, ARENA_THP, ARENA_NORMAL } arena_pages_t;
+
+typedef struct {
+    char *base;
+    size_t size;   // Bytes mapped.
+    size_t used;   // Bytes handed out so far.
+    arena_pages_t pages;
+} arena_t;
+
+// Map an arena of at least `bytes`. Returns 0 on success, -1 if nothing could be mapped.
+int arena_init(arena_t *arena, size_t bytes);
+
+// Carve `bytes` aligned to `align` (a power of two). Returns NULL when the arena is full.
+void* arena_alloc(arena_t *arena, size_t bytes, size_t align);
+
+// Unmap the arena and everything allocated from it.
+void arena_destroy(arena_t *arena);
+
+// "hugetlb", "thp" or "normal".
+const char* arena_pages_name(const arena_t *arena);
+
+#endif
@@ -0,0 +1,187 @@
+// File: bench.c
+// Name: Bradley Stephen
+// Date: October 16, 2026
+// Assignment: MP1 - Benchmark Harness
+//
+// Description:
+//   Implementation of bench.h. Percentiles use the nearest-rank method on the sorted kept
+//   samples; the median averages the two middle samples when the count is even.
+//   CSV output writes a header line only when the output file is new or empty.
+//
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "bench.h"
+
+void bench_defaults(bench_t *b) {
+    memset(b, 0, sizeof(*b));
+    b->warmup = 1;
+    b->format = BENCH_TEXT;
+}
+
+int bench_parse_arg(bench_t *b, const char *arg) {
+    if (strncmp(arg, "--warmup=", 9) == 0) {
+        char *end;
+        long warmup = strtol(arg + 9, &end, 10);
+        if (*end != '\0' || warmup < 0) {
+            return -1;
+        }
+        b->warmup = (int) warmup;
+    } else if (strncmp(arg, "--format=", 9) == 0) {
+        if (strcmp(arg + 9, "text") == 0) b->format = BENCH_TEXT;
+        else if (strcmp(arg + 9, "json") == 0) b->format = BENCH_JSON;
+        else if (strcmp(arg + 9, "csv") == 0) b->format = BENCH_CSV;
+        else return -1;
+    } else if (strncmp(arg, "--output=", 9) == 0) {
+        if (arg[9] == '\0') {
+            return -1;
+        }
+        b->output = arg + 9;
+    } else {
+        return 0;
+    }
+    return 1;
+}
+
+int bench_start(bench_t *b, int runs) {
+    b->runs = runs;
+    b->seen = 0;
+    b->samples = (double*) calloc(runs > 0 ? runs : 1, sizeof(double));
+    return b->samples ? 0 : -1;
+}
+
+int bench_total_runs(const bench_t *b) {
+    return b->warmup + b->runs;
+}
+
+uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ull + (uint64_t) ts.tv_nsec;
+}
+
+void bench_record(bench_t *b, uint64_t elapsed_ns) {
+    int kept = b->seen - b->warmup;
+    b->seen++;
+    if (kept >= 0 && kept < b->runs) {
+        b->samples[kept] = elapsed_ns * 1e-9;
+    }
+}
+
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double*) a, y = *(const double*) b;
+    return (x > y) - (x < y);
+}
+
+void bench_stats(const bench_t *b, bench_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+    int n = b->seen - b->warmup;
+    if (n > b->runs) n = b->runs;
+    if (n <= 0) {
+        return;
+    }
+    double *sorted = (double*) malloc(n * sizeof(double));
+    if (!sorted) {
+        perror("Memory allocation failed");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(sorted, b->samples, n * sizeof(double));
+    qsort(sorted, n, sizeof(double), compare_doubles);
+
+    double sum = 0.0;
+    for (int i = 0; i < n; i++) {
+        sum += sorted[i];
+    }
+    stats->mean = sum / n;
+    double var = 0.0;
+    for (int i = 0; i < n; i++) {
+        var += (sorted[i] - stats->mean) * (sorted[i] - stats->mean);
+    }
+    stats->stddev = (n > 1) ? sqrt(var / (n - 1)) : 0.0;
+    stats->min = sorted[0];
+    stats->max = sorted[n - 1];
+    stats->median = (n % 2) ? sorted[n / 2] : 0.5 * (sorted[n / 2 - 1] + sorted[n / 2]);
+    int p90 = (int) ceil(0.9 * n) - 1;
+    stats->p90 = sorted[p90 < 0 ? 0 : p90];
+    free(sorted);
+}
+
+// Rate in units of 1e9 per second at time t, or 0 when t is not positive.
+static double giga_rate(double amount, double t) {
+    return (t > 0.0) ? amount / t / 1e9 : 0.0;
+}
+
+static const char* or_dash(const char *s) {
+    return (s && *s) ? s : "-";
+}
+
+static void write_json(FILE *f, const bench_t *b, const bench_info_t *info, const bench_stats_t *s) {
+    fprintf(f, "{\"program\":\"%s\",\"scaling\":\"%s\",\"kernel\":\"%s\",\"config\":\"%s\","
+               "\"threads\":%d,\"procs\":%d,\"m\":%ld,\"n\":%ld,\"k\":%ld,\"warmup\":%d,\"runs\":%d,"
+               "\"min_s\":%.9f,\"median_s\":%.9f,\"p90_s\":%.9f,\"max_s\":%.9f,\"mean_s\":%.9f,\"stddev_s\":%.9f,"
+               "\"gflops\":%.3f,\"gbps\":%.3f}\n",
+            or_dash(info->program), or_dash(info->scaling), or_dash(info->kernel), or_dash(info->config),
+            info->threads, info->procs, info->m, info->n, info->k, b->warmup, b->runs,
+            s->min, s->median, s->p90, s->max, s->mean, s->stddev,
+            giga_rate(info->flops, s->median), giga_rate(info->bytes, s->median));
+}
+
+static void write_csv(FILE *f, int header, const bench_t *b, const bench_info_t *info, const bench_stats_t *s) {
+    if (header) {
+        fprintf(f, "program,scaling,kernel,config,threads,procs,m,n,k,warmup,runs,"
+                   "min_s,median_s,p90_s,max_s,mean_s,stddev_s,gflops,gbps\n");
+    }
+    fprintf(f, "%s,%s,%s,%s,%d,%d,%ld,%ld,%ld,%d,%d,%.9f,%.9f,%.9f,%.9f,%.9f,%.9f,%.3f,%.3f\n",
+            or_dash(info->program), or_dash(info->scaling), or_dash(info->kernel), or_dash(info->config),
+            info->threads, info->procs, info->m, info->n, info->k, b->warmup, b->runs,
+            s->min, s->median, s->p90, s->max, s->mean, s->stddev,
+            giga_rate(info->flops, s->median), giga_rate(info->bytes, s->median));
+}
+
+void bench_report(const bench_t *b, const bench_info_t *info) {
+    bench_stats_t s;
+    bench_stats(b, &s);
+    printf("Time (seconds): min %.9f, median %.9f, p90 %.9f, max %.9f, stddev %.9f (%d runs, %d warm-up)\n",
+           s.min, s.median, s.p90, s.max, s.stddev, b->runs, b->warmup);
+    printf("Average Time (seconds): %.9f\n", s.mean);
+    printf("GFLOP/s: %.3f, GB/s: %.3f (at median)\n", giga_rate(info->flops, s.median), giga_rate(info->bytes, s.median));
+    if (b->format == BENCH_TEXT) {
+        return;
+    }
+    FILE *f = stdout;
+    if (b->output) {
+        f = fopen(b->output, "a");
+        if (!f) {
+            perror(b->output);
+            return;
+        }
+    }
+    if (b->format == BENCH_JSON) {
+        write_json(f, b, info, &s);
+    } else {
+        int header = (f == stdout);
+        if (f != stdout) {
+            fseek(f, 0, SEEK_END);
+            header = (ftell(f) == 0);
+        }
+        write_csv(f, header, b, info, &s);
+    }
+    if (f != stdout) {
+        fclose(f);
+    }
+}
+
+void bench_compare(const bench_t *b, const bench_t *baseline, const char *label) {
+    bench_stats_t s, base;
+    bench_stats(b, &s);
+    bench_stats(baseline, &base);
+    double overhead = (base.median > 0.0) ? 100.0 * (s.median / base.median - 1.0) : 0.0;
+    printf("%s: median %.9f s vs %.9f s, overhead %+.1f%%\n", label, s.median, base.median, overhead);
+}
+
+void bench_finish(bench_t *b) {
+    free(b->samples);
+    b->samples = NULL;
+}
@@ -0,0 +1,76 @@
+// File: bench.h
+// Name: Bradley Stephen
+// Date: October 16, 2026
+// Assignment: MP1 - Benchmark Harness
+//
+// Description:
+//   Timing harness shared by the perf drivers and the MPI programs. Runs are timed with
+//   clock_gettime(CLOCK_MONOTONIC) in nanoseconds. The first --warmup runs are timed but
+//   dropped, so cold caches and page faults do not leak into the statistics. After the runs,
+//   bench_report() prints min/median/p90/max/stddev and GFLOP/s and GB/s at the median.
+//   With --format=json|csv it also writes one record per invocation, appended to --output=FILE
+//   (or printed to stdout), so sweeps can be collected without scraping the text output.
+//   Common options: --warmup=N (default 1), --format=text|json|csv, --output=FILE.
+//
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+
+typedef enum { BENCH_TEXT, BENCH_JSON, BENCH_CSV } bench_format_t;
+
+typedef struct {
+    int warmup;             // Runs timed and discarded before the kept ones.
+    bench_format_t format;  // Record format; BENCH_TEXT writes no record.
+    const char *output;     // File records are appended to, or NULL for stdout.
+    int runs;               // Kept runs.
+    int seen;               // Samples offered so far, warm-up included.
+    double *samples;        // Kept samples in seconds.
+} bench_t;
+
+// What was measured, for the report and the records.
+typedef struct {
+    const char *program;
+    const char *scaling;    // "strong" or "weak".
+    const char *kernel;     // Kernel variant.
+    const char *config;     // Other settings that tell runs apart, e.g. "dispatch=pool reduce=tree".
+    int threads;            // Threads per process.
+    int procs;              // MPI processes (1 for the threaded drivers).
+    long m, n, k;           // Rows, columns (or vector length) and batch; 1 where unused.
+    double flops;           // Floating-point operations per run.
+    double bytes;           // Bytes that must move to or from memory per run.
+} bench_info_t;
+
+typedef struct {
+    double min, median, p90, max, mean, stddev;
+} bench_stats_t;
+
+// Set the defaults (1 warm-up run, text only).
+void bench_defaults(bench_t *b);
+
+// Consume a common option. Returns 1 if arg was one, 0 if it is not ours, -1 if its value is bad.
+int bench_parse_arg(bench_t *b, const char *arg);
+
+// Prepare for `runs` kept runs. Returns 0 on success, -1 if allocation fails.
+int bench_start(bench_t *b, int runs);
+
+// Warm-up plus kept runs: the loop bound for the run loop.
+int bench_total_runs(const bench_t *b);
+
+// Monotonic clock in nanoseconds.
+uint64_t bench_now_ns(void);
+
+// Offer one run's time; the first b->warmup samples are dropped.
+void bench_record(bench_t *b, uint64_t elapsed_ns);
+
+void bench_stats(const bench_t *b, bench_stats_t *stats);
+
+// Print the statistics and write the record, if a record format was chosen.
+void bench_report(const bench_t *b, const bench_info_t *info);
+
+// Print b's median against that of baseline, timed over the same runs, as "<label>: ... overhead +x%".
+void bench_compare(const bench_t *b, const bench_t *baseline, const char *label);
+
+void bench_finish(bench_t *b);
+
+#endif
@@ -0,0 +1,142 @@
+// File: dot_kernels.c
+// Name: Bradley Stephen
+// Date: October 16, 2026
+// Assignment: MP1 - Shared Dot Product Kernels
+//
+// Description:
+//   Scalar, SSE2, AVX2 and AVX-512 dot product kernels with runtime dispatch.
+//   The SIMD kernels are compiled with per-function target attributes, so this file
+//   builds without any -m flags and only runs a variant if the CPU reports support for it.
+//   Each SIMD kernel unrolls by four vector accumulators and finishes the tail with scalar code.
+// Usage:
+//   Compile together with a driver, e.g. gcc -O2 -fopenmp perf_dot_product_omp.c dot_kernels.c
+//
+#include <string.h>
+#include "dot_kernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define DOT_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+// Baseline: one serial accumulator, same loop the drivers used to inline.
+static double dot_scalar(const double *A, const double *B, long n) {
+    double sum = 0.0;
+    for (long i = 0; i < n; i++) {
+        sum += A[i] * B[i];
+    }
+    return sum;
+}
+
+#ifdef DOT_KERNELS_X86
+__attribute__((target("sse2")))
+static double dot_sse(const double *A, const double *B, long n) {
+    __m128d acc0 = _mm_setzero_pd(), acc1 = _mm_setzero_pd();
+    __m128d acc2 = _mm_setzero_pd(), acc3 = _mm_setzero_pd();
+    long i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_loadu_pd(A + i),     _mm_loadu_pd(B + i)));
+        acc1 = _mm_add_pd(acc1, _mm_mul_pd(_mm_loadu_pd(A + i + 2), _mm_loadu_pd(B + i + 2)));
+        acc2 = _mm_add_pd(acc2, _mm_mul_pd(_mm_loadu_pd(A + i + 4), _mm_loadu_pd(B + i + 4)));
+        acc3 = _mm_add_pd(acc3, _mm_mul_pd(_mm_loadu_pd(A + i + 6), _mm_loadu_pd(B + i + 6)));
+    }
+    acc0 = _mm_add_pd(_mm_add_pd(acc0, acc1), _mm_add_pd(acc2, acc3));
+    double lanes[2];
+    _mm_storeu_pd(lanes, acc0);
+    double sum = lanes[0] + lanes[1];
+    for (; i < n; i++) {
+        sum += A[i] * B[i];
+    }
+    return sum;
+}
+
+__attribute__((target("avx2,fma")))
+static double dot_avx2(const double *A, const double *B, long n) {
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    __m256d acc2 = _mm256_setzero_pd(), acc3 = _mm256_setzero_pd();
+    long i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(A + i),      _mm256_loadu_pd(B + i),      acc0);
+        acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(A + i + 4),  _mm256_loadu_pd(B + i + 4),  acc1);
+        acc2 = _mm256_fmadd_pd(_mm256_loadu_pd(A + i + 8),  _mm256_loadu_pd(B + i + 8),  acc2);
+        acc3 = _mm256_fmadd_pd(_mm256_loadu_pd(A + i + 12), _mm256_loadu_pd(B + i + 12), acc3);
+    }
+    acc0 = _mm256_add_pd(_mm256_add_pd(acc0, acc1), _mm256_add_pd(acc2, acc3));
+    double lanes[4];
+    _mm256_storeu_pd(lanes, acc0);
+    double sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    for (; i < n; i++) {
+        sum += A[i] * B[i];
+    }
+    return sum;
+}
+
+__attribute__((target("avx512f")))
+static double dot_avx512(const double *A, const double *B, long n) {
+    __m512d acc0 = _mm512_setzero_pd(), acc1 = _mm512_setzero_pd();
+    __m512d acc2 = _mm512_setzero_pd(), acc3 = _mm512_setzero_pd();
+    long i = 0;
+    for (; i + 32 <= n; i += 32) {
+        acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(A + i),      _mm512_loadu_pd(B + i),      acc0);
+        acc1 = _mm512_fmadd_pd(_mm512_loadu_pd(A + i + 8),  _mm512_loadu_pd(B + i + 8),  acc1);
+        acc2 = _mm512_fmadd_pd(_mm512_loadu_pd(A + i + 16), _mm512_loadu_pd(B + i + 16), acc2);
+        acc3 = _mm512_fmadd_pd(_mm512_loadu_pd(A + i + 24), _mm512_loadu_pd(B + i + 24), acc3);
+    }
+    acc0 = _mm512_add_pd(_mm512_add_pd(acc0, acc1), _mm512_add_pd(acc2, acc3));
+    double sum = _mm512_reduce_add_pd(acc0);
+    for (; i < n; i++) {
+        sum += A[i] * B[i];
+    }
+    return sum;
+}
+#endif
+
+int dot_kernel_parse(const char *name, dot_kernel_t *kernel) {
+    if (strcmp(name, "auto") == 0) *kernel = DOT_KERNEL_AUTO;
+    else if (strcmp(name, "scalar") == 0) *kernel = DOT_KERNEL_SCALAR;
+    else if (strcmp(name, "sse") == 0) *kernel = DOT_KERNEL_SSE;
+    else if (strcmp(name, "avx2") == 0) *kernel = DOT_KERNEL_AVX2;
+    else if (strcmp(name, "avx512") == 0) *kernel = DOT_KERNEL_AVX512;
+    else return -1;
+    return 0;
+}
+
+dot_kernel_t dot_kernel_resolve(dot_kernel_t kernel) {
+    if (kernel != DOT_KERNEL_AUTO) {
+        return kernel;
+    }
+    if (dot_kernel_get(DOT_KERNEL_AVX512)) return DOT_KERNEL_AVX512;
+    if (dot_kernel_get(DOT_KERNEL_AVX2)) return DOT_KERNEL_AVX2;
+    if (dot_kernel_get(DOT_KERNEL_SSE)) return DOT_KERNEL_SSE;
+    return DOT_KERNEL_SCALAR;
+}
+
+dot_kernel_fn dot_kernel_get(dot_kernel_t kernel) {
+    switch (kernel) {
+    case DOT_KERNEL_AUTO:
+        return dot_kernel_get(dot_kernel_resolve(kernel));
+    case DOT_KERNEL_SCALAR:
+        return dot_scalar;
+#ifdef DOT_KERNELS_X86
+    case DOT_KERNEL_SSE:
+        return __builtin_cpu_supports("sse2") ? dot_sse : NULL;
+    case DOT_KERNEL_AVX2:
+        return (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) ? dot_avx2 : NULL;
+    case DOT_KERNEL_AVX512:
+        return __builtin_cpu_supports("avx512f") ? dot_avx512 : NULL;
+#endif
+    default:
+        return NULL;
+    }
+}
+
+const char* dot_kernel_name(dot_kernel_t kernel) {
+    switch (kernel) {
+    case DOT_KERNEL_AUTO:   return "auto";
+    case DOT_KERNEL_SCALAR: return "scalar";
+    case DOT_KERNEL_SSE:    return "sse";
+    case DOT_KERNEL_AVX2:   return "avx2";
+    case DOT_KERNEL_AVX512: return "avx512";
+    }
+    return "unknown";
+}
@@ -0,0 +1,37 @@
+// File: dot_kernels.h
+// Name: Bradley Stephen
+// Date: October 16, 2026
+// Assignment: MP1 - Shared Dot Product Kernels
+//
+// Description:
+//   Interface to the dot product kernels shared by every dot product driver.
+//   Each kernel computes sum(A[i] * B[i]) over a contiguous range. The SIMD variants
+//   keep several independent accumulators so the loop is not bound by the latency
+//   of a single add/FMA chain. The variant is picked at runtime from the CPU features,
+//   or forced with --kernel=scalar|sse|avx2|avx512.
+//
+#ifndef DOT_KERNELS_H
+#define DOT_KERNELS_H
+
+typedef enum {
+    DOT_KERNEL_AUTO = 0,
+    DOT_KERNEL_SCALAR,
+    DOT_KERNEL_SSE,
+    DOT_KERNEL_AVX2,
+    DOT_KERNEL_AVX512
+} dot_kernel_t;
+
+typedef double (*dot_kernel_fn)(const double *A, const double *B, long n);
+
+// Parse a kernel name ("auto", "scalar", "sse", "avx2", "avx512"). Returns 0 on success, -1 otherwise.
+int dot_kernel_parse(const char *name, dot_kernel_t *kernel);
+
+// Resolve DOT_KERNEL_AUTO to the widest variant this CPU supports.
+dot_kernel_t dot_kernel_resolve(dot_kernel_t kernel);
+
+// Return the function for a kernel, or NULL if the CPU (or compiler) cannot run it.
+dot_kernel_fn dot_kernel_get(dot_kernel_t kernel);
+
+const char* dot_kernel_name(dot_kernel_t kernel);
+
+#endif
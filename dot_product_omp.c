@@ -6,18 +6,35 @@
 //   This program calculates the dot product of two vectors using OpenMP.
 //   It uses a parallel for loop with a reduction clause so that no manual synchronization is needed.
 //   A sequential version verifies the computed result.
+//   Each thread's share of the sum is computed with the shared kernels in dot_kernels.h.
 // Usage:
-//   Compile with: gcc -fopenmp dot_product_omp.c -o dot_product_omp
-//   Run with: ./dot_product_omp
+//   Compile with: gcc -O2 -fopenmp dot_product_omp.c dot_kernels.c -o dot_product_omp
+//   Run with: ./dot_product_omp [--kernel=auto|scalar|sse|avx2|avx512]
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <omp.h>
+#include "dot_kernels.h"
 
 #define VECTOR_SIZE 10
 #define NUM_THREADS 8
 
-int main() {
+int main(int argc, char *argv[]) {
+    dot_kernel_t kernel = DOT_KERNEL_AUTO;
+    if (argc >= 2 && strncmp(argv[1], "--kernel=", 9) == 0) {
+        if (dot_kernel_parse(argv[1] + 9, &kernel) != 0) {
+            printf("Unknown kernel: %s\n", argv[1] + 9);
+            return 1;
+        }
+    }
+    kernel = dot_kernel_resolve(kernel);
+    dot_kernel_fn dot_kernel = dot_kernel_get(kernel);
+    if (!dot_kernel) {
+        printf("Kernel %s is not supported on this CPU\n", dot_kernel_name(kernel));
+        return 1;
+    }
+
     double *A = (double*) malloc(VECTOR_SIZE * sizeof(double));
     double *B = (double*) malloc(VECTOR_SIZE * sizeof(double));
     double dot_product = 0.0;
@@ -37,9 +54,16 @@ int main() {
     omp_set_num_threads(NUM_THREADS);
 
     // Use OpenMP to compute the dot product in parallel.
-#pragma omp parallel for reduction(+:dot_product)
-    for (int i = 0; i < VECTOR_SIZE; i++) {
-        dot_product += A[i] * B[i];
+#pragma omp parallel reduction(+:dot_product)
+    {
+        // Each thread runs the kernel over its own contiguous chunk.
+        int tid = omp_get_thread_num();
+        int num_threads = omp_get_num_threads();
+        int chunk = VECTOR_SIZE / num_threads;
+        int remainder = VECTOR_SIZE % num_threads;
+        int start = tid * chunk + (tid < remainder ? tid : remainder);
+        int len = chunk + (tid < remainder ? 1 : 0);
+        dot_product += dot_kernel(A + start, B + start, len);
     }
 
     // Compute the dot product sequentially for verification.
@@ -49,7 +73,7 @@ int main() {
     }
 
     // Print the results.
-    printf("=== Dot Product (OpenMP) ===\n");
+    printf("=== Dot Product (OpenMP, %s kernel) ===\n", dot_kernel_name(kernel));
     printf("Parallel  : %f\n", dot_product);
     printf("Sequential: %f\n", seq_dot);
 
@@ -5,23 +5,27 @@
 // Description:
 //   This program computes the dot product of two vectors using Pthreads.
 //   Each thread calculates a part of the dot product, then safely updates the shared result.
+//   The partial sums are combined with the reducer from reduce.h (mutex, atomic, slots or tree).
 //   A sequential computation is also done to verify the correctness.
 // Usage:
-//   Compile with: gcc dot_product_pthreads.c -o dot_product_pthreads -lpthread
-//   Run with: ./dot_product_pthreads
+//   Compile with: gcc dot_product_pthreads.c reduce.c -o dot_product_pthreads -lpthread
+//   Run with: ./dot_product_pthreads [--reduce=mutex|atomic|slots|tree]
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <pthread.h>
+#include "reduce.h"
 
 #define VECTOR_SIZE 10   // Small size for demonstration; change as needed.
 #define NUM_THREADS 8    // We'll use 8 threads as per the assignment requirements.
 
 double *A, *B;              // Global vectors to be processed.
 double dot_product = 0.0;   // Global result variable for the dot product.
-pthread_mutex_t mutex;      // Mutex to protect the shared dot_product during updates.
+reducer_t reducer;          // Combines the partial sums (slots and tree avoid a shared cache line).
 
 typedef struct {
+    int tid;
     int start;
     int end;
 } ThreadData;
@@ -34,16 +38,22 @@ void* dot_product_thread(void* arg) {
     for (int i = data->start; i < data->end; i++) {
         partial_sum += A[i] * B[i];
     }
-    // Lock the mutex to update the global dot_product safely.
-    pthread_mutex_lock(&mutex);
-    dot_product += partial_sum;
-    pthread_mutex_unlock(&mutex);
+    // Hand the partial sum to the reducer.
+    reducer_contribute(&reducer, data->tid, partial_sum);
 
     free(data);
     return NULL;
 }
 
-int main() {
+int main(int argc, char *argv[]) {
+    reduce_mode_t reduce_mode = REDUCE_TREE;
+    if (argc >= 2 && strncmp(argv[1], "--reduce=", 9) == 0) {
+        if (reduce_mode_parse(argv[1] + 9, &reduce_mode) != 0) {
+            printf("Unknown reduction: %s\n", argv[1] + 9);
+            return 1;
+        }
+    }
+
     // Allocate memory for the two vectors.
     A = (double*) malloc(VECTOR_SIZE * sizeof(double));
     B = (double*) malloc(VECTOR_SIZE * sizeof(double));
@@ -58,8 +68,12 @@ int main() {
         B[i] = 1.0;
     }
 
-    // Initialize mutex for thread synchronization.
-    pthread_mutex_init(&mutex, NULL);
+    // Set up the reducer for thread synchronization.
+    if (reducer_init(&reducer, reduce_mode, NUM_THREADS) != 0) {
+        perror("Memory allocation failed");
+        exit(EXIT_FAILURE);
+    }
+    reducer_reset(&reducer);
     pthread_t threads[NUM_THREADS];
 
     // Determine the workload for each thread.
@@ -70,18 +84,21 @@ int main() {
     // Create threads to compute parts of the dot product.
     for (int t = 0; t < NUM_THREADS; t++) {
         ThreadData *data = (ThreadData*) malloc(sizeof(ThreadData));
+        data->tid = t;
         data->start = start_index;
         // Distribute any leftover elements among the first few threads.
         data->end = start_index + chunk_size + (t < remainder ? 1 : 0);
-        pthread_create(&threads[t], NULL, dot_product_thread, data);
+        // Advance before pthread_create: the thread frees data when it finishes.
         start_index = data->end;
+        pthread_create(&threads[t], NULL, dot_product_thread, data);
     }
 
     // Wait for all threads to finish.
     for (int t = 0; t < NUM_THREADS; t++) {
         pthread_join(threads[t], NULL);
     }
-    pthread_mutex_destroy(&mutex);
+    dot_product = reducer_result(&reducer);
+    reducer_destroy(&reducer);
 
     // Do a sequential computation to verify correctness.
     double seq_dot = 0.0;
@@ -90,7 +107,7 @@ int main() {
     }
 
     // Print results.
-    printf("=== Dot Product (Pthreads) ===\n");
+    printf("=== Dot Product (Pthreads, %s reduction) ===\n", reduce_mode_name(reduce_mode));
     printf("Parallel  : %f\n", dot_product);
     printf("Sequential: %f\n", seq_dot);
 
@@ -0,0 +1,318 @@
+// File: gemv_kernels.c
+// Name: Bradley Stephen
+// Date: October 16, 2026
+// Assignment: MP1 - Register-Blocked Matrix-Vector Kernel
+//
+// Description:
+//   Implementation of the blocked GEMV kernel (see gemv_kernels.h).
+//   The 4-row block kernels keep two vector accumulators per row (eight independent FMA chains)
+//   and are dispatched at runtime like the dot product kernels. Rows left over when the
+//   row range is not a multiple of four go through the shared dot product kernel.
+//   The batched kernels vectorize along the K vectors instead: each element of A is broadcast
+//   and multiplied into a row of the N x K block of B, with masked loads for the K tail.
+//   Short row blocks reuse the last valid row pointer and simply do not store the extra rows.
+// Usage:
+//   Compile together with a driver and its dependencies: gemv_kernels.c matrix.c dot_kernels.c
+//
+#include <stdio.h>
+#include <unistd.h>
+#include "gemv_kernels.h"
+#include "dot_kernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define GEMV_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+#define DEFAULT_L1_BYTES (32L * 1024)
+#define DEFAULT_L2_BYTES (1024L * 1024)
+
+static void block_scalar(const double *a, long lda, const double *B, int n, double *out) {
+    const double *a0 = a, *a1 = a + lda, *a2 = a + 2 * lda, *a3 = a + 3 * lda;
+    double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+    for (int j = 0; j < n; j++) {
+        double b = B[j];
+        s0 += a0[j] * b;
+        s1 += a1[j] * b;
+        s2 += a2[j] * b;
+        s3 += a3[j] * b;
+    }
+    out[0] = s0; out[1] = s1; out[2] = s2; out[3] = s3;
+}
+
+static void batch_scalar(const double *a, long lda, int nrows, const double *B, int n, int K, double *P, int first) {
+    for (int r = 0; r < nrows; r++) {
+        const double *ar = a + r * lda;
+        double *pr = P + (long) r * K;
+        if (first) {
+            for (int k = 0; k < K; k++) pr[k] = 0.0;
+        }
+        for (int j = 0; j < n; j++) {
+            const double x = ar[j];
+            const double *bj = B + (long) j * K;
+            for (int k = 0; k < K; k++) {
+                pr[k] += x * bj[k];
+            }
+        }
+    }
+}
+
+#ifdef GEMV_KERNELS_X86
+__attribute__((target("avx2,fma")))
+static double hsum256(__m256d v) {
+    __m128d lo = _mm256_castpd256_pd128(v);
+    __m128d hi = _mm256_extractf128_pd(v, 1);
+    lo = _mm_add_pd(lo, hi);
+    return _mm_cvtsd_f64(_mm_add_sd(lo, _mm_unpackhi_pd(lo, lo)));
+}
+
+__attribute__((target("avx2,fma")))
+static void block_avx2(const double *a, long lda, const double *B, int n, double *out) {
+    const double *a0 = a, *a1 = a + lda, *a2 = a + 2 * lda, *a3 = a + 3 * lda;
+    __m256d c00 = _mm256_setzero_pd(), c01 = _mm256_setzero_pd();
+    __m256d c10 = _mm256_setzero_pd(), c11 = _mm256_setzero_pd();
+    __m256d c20 = _mm256_setzero_pd(), c21 = _mm256_setzero_pd();
+    __m256d c30 = _mm256_setzero_pd(), c31 = _mm256_setzero_pd();
+    int j = 0;
+    for (; j + 8 <= n; j += 8) {
+        __m256d b0 = _mm256_loadu_pd(B + j);
+        __m256d b1 = _mm256_loadu_pd(B + j + 4);
+        c00 = _mm256_fmadd_pd(_mm256_loadu_pd(a0 + j), b0, c00);
+        c01 = _mm256_fmadd_pd(_mm256_loadu_pd(a0 + j + 4), b1, c01);
+        c10 = _mm256_fmadd_pd(_mm256_loadu_pd(a1 + j), b0, c10);
+        c11 = _mm256_fmadd_pd(_mm256_loadu_pd(a1 + j + 4), b1, c11);
+        c20 = _mm256_fmadd_pd(_mm256_loadu_pd(a2 + j), b0, c20);
+        c21 = _mm256_fmadd_pd(_mm256_loadu_pd(a2 + j + 4), b1, c21);
+        c30 = _mm256_fmadd_pd(_mm256_loadu_pd(a3 + j), b0, c30);
+        c31 = _mm256_fmadd_pd(_mm256_loadu_pd(a3 + j + 4), b1, c31);
+    }
+    double s0 = hsum256(_mm256_add_pd(c00, c01));
+    double s1 = hsum256(_mm256_add_pd(c10, c11));
+    double s2 = hsum256(_mm256_add_pd(c20, c21));
+    double s3 = hsum256(_mm256_add_pd(c30, c31));
+    for (; j < n; j++) {
+        double b = B[j];
+        s0 += a0[j] * b;
+        s1 += a1[j] * b;
+        s2 += a2[j] * b;
+        s3 += a3[j] * b;
+    }
+    out[0] = s0; out[1] = s1; out[2] = s2; out[3] = s3;
+}
+
+__attribute__((target("avx2,fma")))
+static void batch_avx2(const double *a, long lda, int nrows, const double *B, int n, int K, double *P, int first) {
+    const double *a0 = a;
+    const double *a1 = a + (nrows > 1 ? 1 : 0) * lda;
+    const double *a2 = a + (nrows > 2 ? 2 : nrows - 1) * lda;
+    const double *a3 = a + (nrows > 3 ? 3 : nrows - 1) * lda;
+    const __m256i lane = _mm256_set_epi64x(3, 2, 1, 0);
+    for (int k0 = 0; k0 < K; k0 += 4) {
+        __m256i m = _mm256_cmpgt_epi64(_mm256_set1_epi64x(K - k0), lane);
+        __m256d c0 = _mm256_setzero_pd(), c1 = _mm256_setzero_pd();
+        __m256d c2 = _mm256_setzero_pd(), c3 = _mm256_setzero_pd();
+        if (!first) {
+            c0 = _mm256_maskload_pd(P + k0, m);
+            if (nrows > 1) c1 = _mm256_maskload_pd(P + K + k0, m);
+            if (nrows > 2) c2 = _mm256_maskload_pd(P + 2L * K + k0, m);
+            if (nrows > 3) c3 = _mm256_maskload_pd(P + 3L * K + k0, m);
+        }
+        for (int j = 0; j < n; j++) {
+            __m256d b = _mm256_maskload_pd(B + (long) j * K + k0, m);
+            c0 = _mm256_fmadd_pd(_mm256_broadcast_sd(a0 + j), b, c0);
+            c1 = _mm256_fmadd_pd(_mm256_broadcast_sd(a1 + j), b, c1);
+            c2 = _mm256_fmadd_pd(_mm256_broadcast_sd(a2 + j), b, c2);
+            c3 = _mm256_fmadd_pd(_mm256_broadcast_sd(a3 + j), b, c3);
+        }
+        _mm256_maskstore_pd(P + k0, m, c0);
+        if (nrows > 1) _mm256_maskstore_pd(P + K + k0, m, c1);
+        if (nrows > 2) _mm256_maskstore_pd(P + 2L * K + k0, m, c2);
+        if (nrows > 3) _mm256_maskstore_pd(P + 3L * K + k0, m, c3);
+    }
+}
+
+__attribute__((target("avx512f")))
+static void block_avx512(const double *a, long lda, const double *B, int n, double *out) {
+    const double *a0 = a, *a1 = a + lda, *a2 = a + 2 * lda, *a3 = a + 3 * lda;
+    __m512d c00 = _mm512_setzero_pd(), c01 = _mm512_setzero_pd();
+    __m512d c10 = _mm512_setzero_pd(), c11 = _mm512_setzero_pd();
+    __m512d c20 = _mm512_setzero_pd(), c21 = _mm512_setzero_pd();
+    __m512d c30 = _mm512_setzero_pd(), c31 = _mm512_setzero_pd();
+    int j = 0;
+    for (; j + 16 <= n; j += 16) {
+        __m512d b0 = _mm512_loadu_pd(B + j);
+        __m512d b1 = _mm512_loadu_pd(B + j + 8);
+        c00 = _mm512_fmadd_pd(_mm512_loadu_pd(a0 + j), b0, c00);
+        c01 = _mm512_fmadd_pd(_mm512_loadu_pd(a0 + j + 8), b1, c01);
+        c10 = _mm512_fmadd_pd(_mm512_loadu_pd(a1 + j), b0, c10);
+        c11 = _mm512_fmadd_pd(_mm512_loadu_pd(a1 + j + 8), b1, c11);
+        c20 = _mm512_fmadd_pd(_mm512_loadu_pd(a2 + j), b0, c20);
+        c21 = _mm512_fmadd_pd(_mm512_loadu_pd(a2 + j + 8), b1, c21);
+        c30 = _mm512_fmadd_pd(_mm512_loadu_pd(a3 + j), b0, c30);
+        c31 = _mm512_fmadd_pd(_mm512_loadu_pd(a3 + j + 8), b1, c31);
+    }
+    double s0 = _mm512_reduce_add_pd(_mm512_add_pd(c00, c01));
+    double s1 = _mm512_reduce_add_pd(_mm512_add_pd(c10, c11));
+    double s2 = _mm512_reduce_add_pd(_mm512_add_pd(c20, c21));
+    double s3 = _mm512_reduce_add_pd(_mm512_add_pd(c30, c31));
+    for (; j < n; j++) {
+        double b = B[j];
+        s0 += a0[j] * b;
+        s1 += a1[j] * b;
+        s2 += a2[j] * b;
+        s3 += a3[j] * b;
+    }
+    out[0] = s0; out[1] = s1; out[2] = s2; out[3] = s3;
+}
+
+__attribute__((target("avx512f")))
+static void batch_avx512(const double *a, long lda, int nrows, const double *B, int n, int K, double *P, int first) {
+    const double *a0 = a;
+    const double *a1 = a + (nrows > 1 ? 1 : 0) * lda;
+    const double *a2 = a + (nrows > 2 ? 2 : nrows - 1) * lda;
+    const double *a3 = a + (nrows > 3 ? 3 : nrows - 1) * lda;
+    for (int k0 = 0; k0 < K; k0 += 8) {
+        __mmask8 m = (K - k0 >= 8) ? (__mmask8) 0xFF : (__mmask8) ((1u << (K - k0)) - 1);
+        __m512d c0 = _mm512_setzero_pd(), c1 = _mm512_setzero_pd();
+        __m512d c2 = _mm512_setzero_pd(), c3 = _mm512_setzero_pd();
+        if (!first) {
+            c0 = _mm512_maskz_loadu_pd(m, P + k0);
+            if (nrows > 1) c1 = _mm512_maskz_loadu_pd(m, P + K + k0);
+            if (nrows > 2) c2 = _mm512_maskz_loadu_pd(m, P + 2L * K + k0);
+            if (nrows > 3) c3 = _mm512_maskz_loadu_pd(m, P + 3L * K + k0);
+        }
+        for (int j = 0; j < n; j++) {
+            __m512d b = _mm512_maskz_loadu_pd(m, B + (long) j * K + k0);
+            c0 = _mm512_fmadd_pd(_mm512_set1_pd(a0[j]), b, c0);
+            c1 = _mm512_fmadd_pd(_mm512_set1_pd(a1[j]), b, c1);
+            c2 = _mm512_fmadd_pd(_mm512_set1_pd(a2[j]), b, c2);
+            c3 = _mm512_fmadd_pd(_mm512_set1_pd(a3[j]), b, c3);
+        }
+        _mm512_mask_storeu_pd(P + k0, m, c0);
+        if (nrows > 1) _mm512_mask_storeu_pd(P + K + k0, m, c1);
+        if (nrows > 2) _mm512_mask_storeu_pd(P + 2L * K + k0, m, c2);
+        if (nrows > 3) _mm512_mask_storeu_pd(P + 3L * K + k0, m, c3);
+    }
+}
+#endif
+
+// Cache size in bytes: the sysconf value if it is usable, else sysfs, else a default.
+static long cache_size(long sc_bytes, int sysfs_index, long fallback) {
+    long bytes = sc_bytes;
+    if (bytes <= 0) {
+        char path[128];
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/size", sysfs_index);
+        FILE *f = fopen(path, "r");
+        if (f) {
+            long kb;
+            if (fscanf(f, "%ldK", &kb) == 1) {
+                bytes = kb * 1024;
+            }
+            fclose(f);
+        }
+    }
+    return bytes > 0 ? bytes : fallback;
+}
+
+void gemv_plan_init(gemv_plan_t *plan, int cols) {
+#ifdef _SC_LEVEL1_DCACHE_SIZE
+    long sc_l1 = sysconf(_SC_LEVEL1_DCACHE_SIZE);
+    long sc_l2 = sysconf(_SC_LEVEL2_CACHE_SIZE);
+#else
+    long sc_l1 = -1, sc_l2 = -1;
+#endif
+    // sysfs index0 is the L1 data cache, index2 the unified L2.
+    plan->l1_bytes = cache_size(sc_l1, 0, DEFAULT_L1_BYTES);
+    plan->l2_bytes = cache_size(sc_l2, 2, DEFAULT_L2_BYTES);
+
+    // The B tile takes half of L1, leaving room for the streaming rows of A.
+    // Keep it a multiple of 16 doubles so the AVX-512 main loop never splits a tile.
+    long tile = plan->l1_bytes / 2 / (long) sizeof(double);
+    tile = tile / 16 * 16;
+    if (tile < 16) tile = 16;
+    plan->col_tile = (tile >= cols) ? (cols > 0 ? cols : 1) : (int) tile;
+
+    // A panel of rows covers half of L2 for one column tile, so the neighbouring
+    // lines fetched for the next tile of the same rows are still cached.
+    long panel = plan->l2_bytes / 2 / ((long) plan->col_tile * (long) sizeof(double));
+    panel = panel / GEMV_BLOCK_ROWS * GEMV_BLOCK_ROWS;
+    if (panel < GEMV_BLOCK_ROWS) panel = GEMV_BLOCK_ROWS;
+    plan->row_panel = (int) panel;
+
+    plan->dot = dot_kernel_get(DOT_KERNEL_AUTO);
+    plan->isa = "scalar";
+    plan->block = block_scalar;
+    plan->batch = batch_scalar;
+#ifdef GEMV_KERNELS_X86
+    if (__builtin_cpu_supports("avx512f")) {
+        plan->isa = "avx512";
+        plan->block = block_avx512;
+        plan->batch = batch_avx512;
+    } else if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        plan->isa = "avx2";
+        plan->block = block_avx2;
+        plan->batch = batch_avx2;
+    }
+#endif
+}
+
+void gemv_blocked(const Matrix *A, const double *B, double *P, int row_begin, int row_end,
+                  const gemv_plan_t *plan) {
+    const int N = A->cols;
+    double out[GEMV_BLOCK_ROWS];
+
+    if (N == 0) {
+        // No column tiles: every product is the empty sum.
+        for (int i = row_begin; i < row_end; i++) {
+            P[i] = 0.0;
+        }
+        return;
+    }
+    for (int p0 = row_begin; p0 < row_end; p0 += plan->row_panel) {
+        int p1 = (p0 + plan->row_panel < row_end) ? p0 + plan->row_panel : row_end;
+        for (int j0 = 0; j0 < N; j0 += plan->col_tile) {
+            int len = (j0 + plan->col_tile < N) ? plan->col_tile : N - j0;
+            int first = (j0 == 0);
+            int i = p0;
+            for (; i + GEMV_BLOCK_ROWS <= p1; i += GEMV_BLOCK_ROWS) {
+                plan->block(matrix_row(A, i) + j0, A->ld, B + j0, len, out);
+                for (int r = 0; r < GEMV_BLOCK_ROWS; r++) {
+                    P[i + r] = first ? out[r] : P[i + r] + out[r];
+                }
+            }
+            for (; i < p1; i++) {
+                double s = plan->dot(matrix_row(A, i) + j0, B + j0, len);
+                P[i] = first ? s : P[i] + s;
+            }
+        }
+    }
+}
+
+void gemv_batched(const Matrix *A, const double *B, int K, double *P, int row_begin, int row_end,
+                  const gemv_plan_t *plan) {
+    const int N = A->cols;
+    // The current tile of B (tile x K doubles) takes half of L1.
+    long tile = plan->l1_bytes / 2 / ((long) K * (long) sizeof(double));
+    tile = tile / 8 * 8;
+    if (tile < 8) tile = 8;
+    if (tile > N) tile = (N > 0) ? N : 1;
+
+    if (N == 0) {
+        for (long i = (long) row_begin * K; i < (long) row_end * K; i++) {
+            P[i] = 0.0;
+        }
+        return;
+    }
+
+    for (int p0 = row_begin; p0 < row_end; p0 += plan->row_panel) {
+        int p1 = (p0 + plan->row_panel < row_end) ? p0 + plan->row_panel : row_end;
+        for (int j0 = 0; j0 < N; j0 += (int) tile) {
+            int len = (j0 + tile < N) ? (int) tile : N - j0;
+            for (int i = p0; i < p1; i += GEMV_BLOCK_ROWS) {
+                int nrows = (p1 - i < GEMV_BLOCK_ROWS) ? p1 - i : GEMV_BLOCK_ROWS;
+                plan->batch(matrix_row(A, i) + j0, A->ld, nrows, B + (long) j0 * K, len, K,
+                            P + (long) i * K, j0 == 0);
+            }
+        }
+    }
+}
@@ -0,0 +1,48 @@
+// File: gemv_kernels.h
+// Name: Bradley Stephen
+// Date: October 16, 2026
+// Assignment: MP1 - Register-Blocked Matrix-Vector Kernel
+//
+// Description:
+//   Blocked P = A * B for the contiguous Matrix type. Four rows of A are processed
+//   together so every SIMD load of B feeds four FMAs, and B is walked in column tiles
+//   sized from the L1 data cache so the current tile stays resident while a panel of
+//   rows streams past it. Tile sizes come from the cache sizes read at startup.
+//   gemv_batched multiplies A by a block of K vectors in the same single pass over A.
+//
+#ifndef GEMV_KERNELS_H
+#define GEMV_KERNELS_H
+
+#include "matrix.h"
+
+#define GEMV_BLOCK_ROWS 4
+
+typedef struct {
+    long l1_bytes;   // L1 data cache size used for tiling.
+    long l2_bytes;   // L2 cache size used for tiling.
+    int col_tile;    // Columns of B per tile (tile occupies half of L1).
+    int row_panel;   // Rows per panel (panel of A tiles occupies half of L2).
+    const char *isa; // SIMD variant picked for this CPU.
+    // Dot product of one row with B[0..n), for the rows left over after the blocks of GEMV_BLOCK_ROWS.
+    double (*dot)(const double *a, const double *B, long n);
+    // Dot products of GEMV_BLOCK_ROWS rows (stride lda) with B[0..n), written to out.
+    void (*block)(const double *a, long lda, const double *B, int n, double *out);
+    // Adds rows [a, a + nrows*lda) times the n x K tile B into the nrows x K block P
+    // (overwriting P instead when first is set). nrows is at most GEMV_BLOCK_ROWS.
+    void (*batch)(const double *a, long lda, int nrows, const double *B, int n, int K, double *P, int first);
+} gemv_plan_t;
+
+// Read cache sizes and pick tile sizes and the SIMD variant for a matrix with `cols` columns.
+void gemv_plan_init(gemv_plan_t *plan, int cols);
+
+// P[i] = A[i,:] . B for row_begin <= i < row_end.
+void gemv_blocked(const Matrix *A, const double *B, double *P, int row_begin, int row_end,
+                  const gemv_plan_t *plan);
+
+// P[i*K + k] = A[i,:] . B[:,k] for row_begin <= i < row_end and 0 <= k < K, where B is N x K
+// and P is M x K, both row-major. A is read once for all K vectors; the B tile height is chosen
+// so an N-tile of all K vectors fits in half of L1.
+void gemv_batched(const Matrix *A, const double *B, int K, double *P, int row_begin, int row_end,
+                  const gemv_plan_t *plan);
+
+#endif
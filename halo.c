@@ -0,0 +1,212 @@
+// File: halo.c
+// Name: Bradley Stephen
+// Date: October 16, 2026
+// Assignment: MP1 - Sparse Halo Exchange
+//
+// Description:
+//   Implementation of halo.h. The plan is built once: each rank counts the remote columns it needs
+//   from every owner (MPI_Alltoall), sends the owners their lists (MPI_Alltoallv), and the graph
+//   communicator is made from the ranks with non-zero counts in either direction. Remote columns
+//   are sorted by global index, and owners hold increasing ranges, so the entries from one source
+//   arrive as one contiguous run of x.
+//
+#include <stdlib.h>
+#include <string.h>
+#include "halo.h"
+
+// First global index of block p when n indices are split evenly over parts.
+static int block_first(int n, int parts, int p) {
+    int base = n / parts;
+    int rem = n % parts;
+    return p * base + (p < rem ? p : rem);
+}
+
+// Block that holds global index j.
+static int block_owner(int n, int parts, int j) {
+    int base = n / parts;
+    int rem = n % parts;
+    int big = rem * (base + 1);  // Indices in the rem blocks of base + 1.
+    return (j < big) ? j / (base + 1) : rem + (j - big) / base;
+}
+
+static int by_value(const void *a, const void *b) {
+    int x = *(const int*) a, y = *(const int*) b;
+    return (x > y) - (x < y);
+}
+
+// 1 if any rank of comm failed. Every rank takes the same branch after it, so none is left
+// waiting in a collective the others skipped.
+static int any_failed(int failed, MPI_Comm comm) {
+    int any;
+    MPI_Allreduce(&failed, &any, 1, MPI_INT, MPI_LOR, comm);
+    return any;
+}
+
+// Free what halo_create() allocated in h so far and clear it (h->comm is still the caller's).
+static void discard(halo_t *h) {
+    free(h->recv_counts);
+    free(h->recv_displs);
+    free(h->send_counts);
+    free(h->send_displs);
+    free(h->send_index);
+    free(h->send_buf);
+    memset(h, 0, sizeof(*h));
+}
+
+int halo_create(halo_t *h, halo_mode_t mode, csr_t *A, int n, MPI_Comm comm) {
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    memset(h, 0, sizeof(*h));
+    h->mode = mode;
+    h->comm = comm;
+    h->own_first = block_first(n, size, rank);
+    h->own_count = block_first(n, size, rank + 1) - h->own_first;
+
+    if (mode == HALO_ALLGATHER) {
+        h->recv_counts = (int*) malloc(size * sizeof(int));
+        h->recv_displs = (int*) malloc(size * sizeof(int));
+        if (any_failed(!h->recv_counts || !h->recv_displs, comm)) {
+            discard(h);
+            return -1;
+        }
+        for (int r = 0; r < size; r++) {
+            h->recv_displs[r] = block_first(n, size, r);
+            h->recv_counts[r] = block_first(n, size, r + 1) - h->recv_displs[r];
+        }
+        h->own_at = h->own_first;
+        h->x_size = n;
+        h->halo_count = n - h->own_count;
+        return 0;
+    }
+
+    // The remote columns, sorted and without repeats.
+    const int own_end = h->own_first + h->own_count;
+    long remote = 0;
+    for (long p = 0; p < A->nnz; p++) {
+        remote += (A->col[p] < h->own_first || A->col[p] >= own_end);
+    }
+    int *halo_cols = (int*) malloc((size_t) (remote > 0 ? remote : 1) * sizeof(int));
+    int *need = (int*) calloc(size, sizeof(int));
+    int *give = (int*) malloc(size * sizeof(int));
+    int *need_displs = (int*) malloc(size * sizeof(int));
+    int *give_displs = (int*) malloc(size * sizeof(int));
+    int *sources = (int*) malloc(size * sizeof(int));
+    int *dests = (int*) malloc(size * sizeof(int));
+    int status = -1;
+    if (any_failed(!halo_cols || !need || !give || !need_displs || !give_displs || !sources || !dests, comm)) {
+        goto done;
+    }
+    long count = 0;
+    for (long p = 0; p < A->nnz; p++) {
+        if (A->col[p] < h->own_first || A->col[p] >= own_end) {
+            halo_cols[count++] = A->col[p];
+        }
+    }
+    qsort(halo_cols, (size_t) count, sizeof(int), by_value);
+    int unique = 0;
+    for (long i = 0; i < count; i++) {
+        if (unique == 0 || halo_cols[i] != halo_cols[unique - 1]) {
+            halo_cols[unique++] = halo_cols[i];
+        }
+    }
+    h->halo_count = unique;
+    h->x_size = h->own_count + unique;
+    h->own_at = 0;
+
+    // Columns become x indices: owned ones first, then the remote ones in sorted order.
+#pragma omp parallel for schedule(static)
+    for (long p = 0; p < A->nnz; p++) {
+        int c = A->col[p];
+        if (c >= h->own_first && c < own_end) {
+            A->col[p] = c - h->own_first;
+        } else {
+            const int *at = (const int*) bsearch(&c, halo_cols, (size_t) unique, sizeof(int), by_value);
+            A->col[p] = h->own_count + (int) (at - halo_cols);
+        }
+    }
+
+    // Tell every owner which of its entries this rank needs.
+    for (int i = 0; i < unique; i++) {
+        need[block_owner(n, size, halo_cols[i])]++;
+    }
+    MPI_Alltoall(need, 1, MPI_INT, give, 1, MPI_INT, comm);
+    int total_give = 0;
+    for (int r = 0; r < size; r++) {
+        need_displs[r] = (r == 0) ? 0 : need_displs[r - 1] + need[r - 1];
+        give_displs[r] = total_give;
+        total_give += give[r];
+    }
+    h->send_index = (int*) malloc((size_t) (total_give > 0 ? total_give : 1) * sizeof(int));
+    h->send_buf = (double*) malloc((size_t) (total_give > 0 ? total_give : 1) * sizeof(double));
+    h->recv_counts = (int*) malloc(size * sizeof(int));
+    h->recv_displs = (int*) malloc(size * sizeof(int));
+    h->send_counts = (int*) malloc(size * sizeof(int));
+    h->send_displs = (int*) malloc(size * sizeof(int));
+    if (any_failed(!h->send_index || !h->send_buf || !h->recv_counts || !h->recv_displs || !h->send_counts ||
+                   !h->send_displs, comm)) {
+        goto done;
+    }
+    MPI_Alltoallv(halo_cols, need, need_displs, MPI_INT, h->send_index, give, give_displs, MPI_INT, comm);
+    for (int i = 0; i < total_give; i++) {
+        h->send_index[i] -= h->own_first;
+    }
+
+    // Only the ranks with something to exchange become neighbours.
+    for (int r = 0; r < size; r++) {
+        if (need[r] > 0) {
+            sources[h->nsources] = r;
+            h->recv_counts[h->nsources] = need[r];
+            h->recv_displs[h->nsources] = h->own_count + need_displs[r];
+            h->nsources++;
+        }
+        if (give[r] > 0) {
+            dests[h->ndests] = r;
+            h->send_counts[h->ndests] = give[r];
+            h->send_displs[h->ndests] = give_displs[r];
+            h->ndests++;
+        }
+    }
+    // Edges are weighted by the entries they carry.
+    MPI_Dist_graph_create_adjacent(comm, h->nsources, sources, h->recv_counts, h->ndests, dests, h->send_counts,
+                                   MPI_INFO_NULL, 0, &h->comm);
+    status = 0;
+done:
+    if (status != 0) {
+        discard(h);
+    }
+    free(halo_cols);
+    free(need);
+    free(give);
+    free(need_displs);
+    free(give_displs);
+    free(sources);
+    free(dests);
+    return status;
+}
+
+void halo_exchange(halo_t *h, double *x) {
+    if (h->mode == HALO_ALLGATHER) {
+        MPI_Allgatherv(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL, x, h->recv_counts, h->recv_displs, MPI_DOUBLE, h->comm);
+        return;
+    }
+    int total = (h->ndests > 0) ? h->send_displs[h->ndests - 1] + h->send_counts[h->ndests - 1] : 0;
+    for (int i = 0; i < total; i++) {
+        h->send_buf[i] = x[h->send_index[i]];
+    }
+    MPI_Neighbor_alltoallv(h->send_buf, h->send_counts, h->send_displs, MPI_DOUBLE,
+                           x, h->recv_counts, h->recv_displs, MPI_DOUBLE, h->comm);
+}
+
+void halo_free(halo_t *h) {
+    if (h->mode == HALO_NEIGHBOR && h->comm != MPI_COMM_NULL) {
+        MPI_Comm_free(&h->comm);
+    }
+    free(h->recv_counts);
+    free(h->recv_displs);
+    free(h->send_counts);
+    free(h->send_displs);
+    free(h->send_index);
+    free(h->send_buf);
+    memset(h, 0, sizeof(*h));
+}
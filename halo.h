@@ -0,0 +1,49 @@
+// File: halo.h
+// Name: Bradley Stephen
+// Date: October 16, 2026
+// Assignment: MP1 - Sparse Halo Exchange
+//
+// Description:
+//   Distribution of B for the MPI sparse matrix-vector product. B is split into even blocks, one
+//   per rank (the same split as the rows when the matrix is square), and every rank generates only
+//   the block it owns. Before a multiply each rank needs the entries of B its rows touch:
+//     HALO_NEIGHBOR   fetch just those: halo_create() finds the remote columns of the local CSR
+//                     rows, renumbers the matrix to a local x (owned entries, then the remote ones
+//                     sorted by global column), and tells every owner which of its entries to send.
+//                     halo_exchange() is one MPI_Neighbor_alltoallv over a distributed graph
+//                     linking each rank only to the ranks it shares columns with.
+//     HALO_ALLGATHER  assemble all of B everywhere with MPI_Allgatherv; x is B in global order.
+//   A banded matrix then moves only its band edges per rank instead of all N entries.
+//
+#ifndef HALO_H
+#define HALO_H
+
+#include <mpi.h>
+#include "sparse.h"
+
+typedef enum { HALO_NEIGHBOR, HALO_ALLGATHER } halo_mode_t;
+
+typedef struct {
+    halo_mode_t mode;
+    MPI_Comm comm;                   // HALO_NEIGHBOR: the graph; HALO_ALLGATHER: the communicator given.
+    int own_first, own_count;        // Owned entries: global [own_first, own_first + own_count),
+    int own_at;                      // stored from x[own_at].
+    int x_size;                      // Entries of x.
+    int halo_count;                  // Entries received per exchange.
+    int nsources, ndests;            // HALO_NEIGHBOR: ranks received from and sent to.
+    int *recv_counts, *recv_displs;  // Per source (per rank for HALO_ALLGATHER); displacements into x.
+    int *send_counts, *send_displs;  // Per destination.
+    int *send_index;                 // x index of every entry sent, grouped by destination.
+    double *send_buf;
+} halo_t;
+
+// Collective over comm. Plans the exchange of an n-entry B for the local rows A, renumbering A's
+// columns to x indices for HALO_NEIGHBOR. Returns 0 on success, -1 if an allocation fails.
+int halo_create(halo_t *h, halo_mode_t mode, csr_t *A, int n, MPI_Comm comm);
+
+// Collective. Fill the entries of x this rank does not own; the owned ones must be set.
+void halo_exchange(halo_t *h, double *x);
+
+void halo_free(halo_t *h);
+
+#endif
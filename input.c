@@ -0,0 +1,118 @@
+// File: input.c
+// Name: Bradley Stephen
+// Date: October 16, 2026
+// Assignment: MP1 - Input Generation
+//
+// Description:
+//   Implementation of input.h. Philox4x32-10 follows Salmon et al., "Parallel Random Numbers:
+//   As Easy as 1, 2, 3" (SC 2011): the counter is (index, row, stream), the key is the seed, and
+//   the four output words give two 53-bit uniforms.
+//
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "input.h"
+
+static const char *dist_names[] = { "ones", "uniform", "normal", "ill", "sparse" };
+
+void input_defaults(input_t *in) {
+    in->dist = INPUT_UNIFORM;
+    in->seed = 1;
+}
+
+int input_parse_arg(input_t *in, const char *arg) {
+    if (strncmp(arg, "--init=", 7) == 0) {
+        for (int d = INPUT_ONES; d <= INPUT_SPARSE; d++) {
+            if (strcmp(arg + 7, dist_names[d]) == 0) {
+                in->dist = (input_dist_t) d;
+                return 1;
+            }
+        }
+        return -1;
+    } else if (strncmp(arg, "--seed=", 7) == 0) {
+        char *end;
+        unsigned long long seed = strtoull(arg + 7, &end, 10);
+        if (arg[7] == '\0' || *end != '\0') {
+            return -1;
+        }
+        in->seed = seed;
+        return 1;
+    }
+    return 0;
+}
+
+const char* input_name(const input_t *in) {
+    return dist_names[in->dist];
+}
+
+// Ten Philox rounds on ctr with the key bumped by the Weyl constants between rounds.
+static void philox4x32_10(uint32_t ctr[4], uint32_t k0, uint32_t k1) {
+    for (int round = 0; round < 10; round++) {
+        uint64_t p0 = (uint64_t) 0xD2511F53u * ctr[0];
+        uint64_t p1 = (uint64_t) 0xCD9E8D57u * ctr[2];
+        uint32_t next[4] = { (uint32_t) (p1 >> 32) ^ ctr[1] ^ k0, (uint32_t) p1,
+                             (uint32_t) (p0 >> 32) ^ ctr[3] ^ k1, (uint32_t) p0 };
+        memcpy(ctr, next, sizeof(next));
+        k0 += 0x9E3779B9u;
+        k1 += 0xBB67AE85u;
+    }
+}
+
+// Uniform on [0, 1) from 53 bits of two words.
+static double unit(uint32_t hi, uint32_t lo) {
+    return (double) (((uint64_t) hi << 21) | (lo >> 11)) * 0x1p-53;
+}
+
+// Integer in [-2^25, 2^25) scaled by 2^-25: 26 significant bits at most.
+static double bits26(uint32_t w) {
+    return ldexp((double) ((int32_t) (w >> 6) - (1 << 25)), -25);
+}
+
+// The four output words for (counter, row, stream).
+static void draw(const input_t *in, input_stream_t stream, uint64_t row, uint64_t counter, uint32_t w[4]) {
+    w[0] = (uint32_t) counter;
+    w[1] = (uint32_t) (counter >> 32);
+    w[2] = (uint32_t) row;
+    w[3] = (uint32_t) stream;
+    philox4x32_10(w, (uint32_t) in->seed, (uint32_t) (in->seed >> 32));
+}
+
+double input_value(const input_t *in, input_stream_t stream, uint64_t row, uint64_t index) {
+    if (in->dist == INPUT_ONES) {
+        return 1.0;
+    }
+    // "ill" draws once per pair of elements so both halves of a pair see the same words.
+    uint32_t w[4];
+    draw(in, stream, row, (in->dist == INPUT_ILL) ? index / 2 : index, w);
+
+    switch (in->dist) {
+    case INPUT_NORMAL:
+        return sqrt(-2.0 * log(1.0 - unit(w[0], w[1]))) * cos(2.0 * M_PI * unit(w[2], w[3]));
+    case INPUT_ILL:
+        if (stream == INPUT_A) {
+            int e = (int) (w[1] % (2 * INPUT_ILL_EXP + 1)) - INPUT_ILL_EXP;
+            return ldexp(bits26(w[0]), e);
+        } else {
+            double s = bits26(w[2]);
+            double d = (w[3] & 1) ? 0x1p-25 : -0x1p-25;
+            return (index % 2 == 0) ? s : -s + d;
+        }
+    case INPUT_SPARSE:
+        return (w[3] % INPUT_SPARSE_EVERY == 0) ? 2.0 * unit(w[0], w[1]) - 1.0 : 0.0;
+    default:
+        return 2.0 * unit(w[0], w[1]) - 1.0;
+    }
+}
+
+double input_unit(const input_t *in, input_stream_t stream, uint64_t row, uint64_t index) {
+    uint32_t w[4];
+    draw(in, stream, row, index, w);
+    return unit(w[0], w[1]);
+}
+
+void input_fill(const input_t *in, input_stream_t stream, uint64_t row, uint64_t first, double *x, long stride,
+                long n) {
+    for (long i = 0; i < n; i++) {
+        x[i * stride] = input_value(in, stream, row, first + i);
+    }
+}
@@ -0,0 +1,65 @@
+// File: input.h
+// Name: Bradley Stephen
+// Date: October 16, 2026
+// Assignment: MP1 - Input Generation
+//
+// Description:
+//   Seeded input data for every driver, selected with --init=DIST and --seed=S.
+//   Each element is a pure function of (seed, stream, row, index), computed from one call of the
+//   counter-based Philox4x32-10 generator, so any thread or rank can generate any slice on its own
+//   and the data is the same for every thread count, rank count and fill order. Callers fill in
+//   parallel over the chunks their kernels later read, which also first-touches the pages there.
+//   Distributions:
+//     ones     every element 1.0 (the original programs' data)
+//     uniform  uniform on [-1, 1) (default)
+//     normal   standard normal (Box-Muller)
+//     ill      ill-conditioned dot products: elements 2p and 2p+1 of an A row share one value
+//              a = r * 2^e, with e spread over 2^-INPUT_ILL_EXP .. 2^INPUT_ILL_EXP, and the B entries
+//              are s and -s + d * 2^-25 (d = +-1), so each pair contributes exactly a * d * 2^-25
+//              while its products are as large as a * s. All operands have at most 26 significant
+//              bits, so every product is exact and the compensated reference (verify.h) stays exact
+//              up to its own final roundings, while a plain sum loses about log2(cond) bits.
+//     sparse   uniform values in about 1 of INPUT_SPARSE_EVERY elements, zero elsewhere
+//   Stream INPUT_A is the left operand (vector A or the matrix, row = matrix row) and INPUT_B the
+//   right one (vector B, row = batch column); "ill" depends on which one is generated.
+//   Stream INPUT_PATTERN draws the structure of generated sparse matrices (see sparse.h) through
+//   input_unit(), which is uniform whatever the distribution, so --init only changes the values.
+//
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <stdint.h>
+
+typedef enum { INPUT_ONES, INPUT_UNIFORM, INPUT_NORMAL, INPUT_ILL, INPUT_SPARSE } input_dist_t;
+
+typedef enum { INPUT_A = 0, INPUT_B = 1, INPUT_PATTERN = 2 } input_stream_t;
+
+#define INPUT_ILL_EXP 40
+#define INPUT_SPARSE_EVERY 16
+
+typedef struct {
+    input_dist_t dist;
+    uint64_t seed;
+} input_t;
+
+// Set the defaults (uniform, seed 1).
+void input_defaults(input_t *in);
+
+// Consume --init=ones|uniform|normal|ill|sparse or --seed=S. Returns 1 if arg was one, 0 if it is
+// not ours, -1 if its value is bad (the bench_parse_arg() convention).
+int input_parse_arg(input_t *in, const char *arg);
+
+const char* input_name(const input_t *in);
+
+// Element `index` of row `row` of a stream.
+double input_value(const input_t *in, input_stream_t stream, uint64_t row, uint64_t index);
+
+// Uniform on [0, 1) from the same counter, for every distribution.
+double input_unit(const input_t *in, input_stream_t stream, uint64_t row, uint64_t index);
+
+// x[i * stride] = element (first + i) of row `row`, for i in [0, n). Serial; callers split the
+// range over their threads.
+void input_fill(const input_t *in, input_stream_t stream, uint64_t row, uint64_t first, double *x, long stride,
+                long n);
+
+#endif
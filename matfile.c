@@ -0,0 +1,169 @@
+// File: matfile.c
+// Name: Bradley Stephen
+// Date: October 16, 2026
+// Assignment: MP1 - Matrix File Format
+//
+// Description:
+//   Implementation of matfile.h. mmap offsets must be page-aligned, so a row range is mapped from
+//   the page holding its first byte and data points past the leading bytes of other rows.
+//   Releasing a panel uses MADV_DONTNEED for this process's mapping and POSIX_FADV_DONTNEED for the
+//   page cache; the data is clean, so nothing is written back.
+//
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "matfile.h"
+
+static size_t page_size(void) {
+    return (size_t) sysconf(_SC_PAGESIZE);
+}
+
+int matfile_open(matfile_t *f, const char *path) {
+    memset(f, 0, sizeof(*f));
+    f->fd = open(path, O_RDONLY);
+    if (f->fd < 0) {
+        return -1;
+    }
+    struct stat st;
+    const matfile_header_t *h = &f->header;
+    // The sizes come from the file, so the data is checked to fit by division: a product of
+    // crafted rows and ld could wrap around. data_offset must be page-aligned (in the format's
+    // MATFILE_HEADER_BYTES pages) and past the header, and the row starts it and ld give must be
+    // multiples of the alignment the header claims.
+    if (pread(f->fd, &f->header, sizeof(f->header), 0) != (ssize_t) sizeof(f->header) || fstat(f->fd, &st) != 0 ||
+        memcmp(h->magic, MATFILE_MAGIC, 8) != 0 || h->version != MATFILE_VERSION || h->dtype != MATFILE_F64 ||
+        h->layout != MATFILE_ROW_MAJOR || h->ld < h->cols || h->ld == 0 || h->ld > SIZE_MAX / sizeof(double) ||
+        h->data_offset < MATFILE_HEADER_BYTES || h->data_offset % MATFILE_HEADER_BYTES != 0 ||
+        h->data_offset > (uint64_t) st.st_size || h->alignment == 0 || h->data_offset % h->alignment != 0 ||
+        h->ld * sizeof(double) % h->alignment != 0 ||
+        h->rows > ((uint64_t) st.st_size - h->data_offset) / (h->ld * sizeof(double))) {
+        close(f->fd);
+        f->fd = -1;
+        errno = EINVAL;
+        return -1;
+    }
+    return 0;
+}
+
+int matfile_map_rows(matfile_t *f, long row_begin, long row_end) {
+    size_t begin = f->header.data_offset + (size_t) row_begin * f->header.ld * sizeof(double);
+    size_t end = f->header.data_offset + (size_t) row_end * f->header.ld * sizeof(double);
+    size_t start = begin - begin % page_size();
+    f->row_begin = row_begin;
+    f->row_end = row_end;
+    f->map = NULL;
+    f->map_bytes = 0;
+    f->data = NULL;
+    if (end <= begin) {
+        return 0;
+    }
+    void *map = mmap(NULL, end - start, PROT_READ, MAP_SHARED, f->fd, (off_t) start);
+    if (map == MAP_FAILED) {
+        return -1;
+    }
+    f->map = (char*) map;
+    f->map_bytes = end - start;
+    f->data = (double*) (f->map + (begin - start));
+    return 0;
+}
+
+void matfile_view(const matfile_t *f, Matrix *m) {
+    m->rows = (int) (f->row_end - f->row_begin);
+    m->cols = (int) f->header.cols;
+    m->ld = (long) f->header.ld;
+    m->data = f->data;
+}
+
+// Page-aligned part of the mapping that holds rows [row_begin, row_end): [*addr, *addr + *len).
+static int row_pages(const matfile_t *f, long row_begin, long row_end, char **addr, size_t *len) {
+    if (!f->map || row_end <= row_begin) {
+        return -1;
+    }
+    char *first = (char*) matfile_row(f, row_begin);
+    char *last = (char*) matfile_row(f, row_end);
+    *addr = f->map + (size_t) (first - f->map) / page_size() * page_size();
+    *len = (size_t) (last - *addr);
+    return 0;
+}
+
+void matfile_prefetch(const matfile_t *f, long row_begin, long row_end) {
+    char *addr;
+    size_t len;
+    if (row_pages(f, row_begin, row_end, &addr, &len) == 0) {
+        madvise(addr, len, MADV_WILLNEED);
+    }
+}
+
+void matfile_release(const matfile_t *f, long row_begin, long row_end) {
+    char *addr;
+    size_t len;
+    if (row_pages(f, row_begin, row_end, &addr, &len) == 0) {
+        // madvise() rounds the length up, which would also drop the first page of the next panel,
+        // just read ahead; keep the page the two panels share unless nothing follows in the mapping.
+        if (row_end < f->row_end) {
+            len -= len % page_size();
+        }
+        madvise(addr, len, MADV_DONTNEED);
+        off_t offset = (off_t) (f->header.data_offset + (size_t) row_begin * f->header.ld * sizeof(double));
+        posix_fadvise(f->fd, offset, (off_t) ((size_t) (row_end - row_begin) * f->header.ld * sizeof(double)),
+                      POSIX_FADV_DONTNEED);
+    }
+}
+
+void matfile_close(matfile_t *f) {
+    if (f->map) {
+        munmap(f->map, f->map_bytes);
+    }
+    if (f->fd >= 0) {
+        close(f->fd);
+    }
+    memset(f, 0, sizeof(*f));
+    f->fd = -1;
+}
+
+// Write all of buf at offset, retrying short writes.
+static int write_all(int fd, const void *buf, size_t bytes, off_t offset) {
+    const char *p = (const char*) buf;
+    while (bytes > 0) {
+        ssize_t n = pwrite(fd, p, bytes, offset);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        p += n;
+        bytes -= (size_t) n;
+        offset += n;
+    }
+    return 0;
+}
+
+int matfile_write(const char *path, const Matrix *m) {
+    char header_bytes[MATFILE_HEADER_BYTES] = {0};
+    matfile_header_t *h = (matfile_header_t*) header_bytes;
+    memcpy(h->magic, MATFILE_MAGIC, 8);
+    h->version = MATFILE_VERSION;
+    h->dtype = MATFILE_F64;
+    h->layout = MATFILE_ROW_MAJOR;
+    h->alignment = (m->ld % 8 == 0) ? MATRIX_ALIGNMENT : sizeof(double);
+    h->rows = (uint64_t) m->rows;
+    h->cols = (uint64_t) m->cols;
+    h->ld = (uint64_t) m->ld;
+    h->data_offset = MATFILE_HEADER_BYTES;
+
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return -1;
+    }
+    if (write_all(fd, header_bytes, sizeof(header_bytes), 0) != 0 ||
+        write_all(fd, m->data, (size_t) m->rows * m->ld * sizeof(double), MATFILE_HEADER_BYTES) != 0) {
+        int saved = errno;
+        close(fd);
+        errno = saved;
+        return -1;
+    }
+    return close(fd);
+}
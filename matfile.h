@@ -0,0 +1,89 @@
+// File: matfile.h
+// Name: Bradley Stephen
+// Date: October 16, 2026
+// Assignment: MP1 - Matrix File Format
+//
+// Description:
+//   Binary container for matrices and vectors, read zero-copy with mmap. A file is a
+//   MATFILE_HEADER_BYTES header followed by raw row-major data:
+//     offset  0  magic "MP1MATRX"
+//             8  version (uint32, MATFILE_VERSION)
+//            12  dtype (uint32, MATFILE_F64: little-endian IEEE doubles)
+//            16  layout (uint32, MATFILE_ROW_MAJOR)
+//            20  alignment (uint32): bytes every row start is a multiple of, counted from the file start
+//            24  rows, cols (uint64)
+//            40  ld (uint64): elements from one row start to the next, >= cols; padding is zero
+//            48  data_offset (uint64): byte offset of row 0, a multiple of the page size
+//                (MATFILE_HEADER_BYTES), which matfile_open() checks along with the data fitting the file
+//                and data_offset and ld * 8 being multiples of alignment
+//   A vector of n entries is an n x 1 file; a batch of K vectors is n x K (entry j of vector k at
+//   row j, column k, like the batched kernels' B).
+//   matfile_map_rows() maps just the pages holding a range of rows, so a process can map its own
+//   row block without touching the rest of the file. For matrices larger than memory, stream the
+//   rows in panels: matfile_prefetch() starts readahead on the next panel and matfile_release()
+//   drops a finished one from the process and from the page cache, so resident memory stays at a
+//   few panels and every run reads the matrix from storage again.
+//
+#ifndef MATFILE_H
+#define MATFILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "matrix.h"
+
+#define MATFILE_MAGIC "MP1MATRX"
+#define MATFILE_VERSION 1
+#define MATFILE_HEADER_BYTES 4096
+
+enum { MATFILE_F64 = 1 };
+enum { MATFILE_ROW_MAJOR = 0 };
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t dtype;
+    uint32_t layout;
+    uint32_t alignment;
+    uint64_t rows;
+    uint64_t cols;
+    uint64_t ld;
+    uint64_t data_offset;
+} matfile_header_t;
+
+typedef struct {
+    matfile_header_t header;
+    int fd;
+    long row_begin, row_end;  // Rows mapped by matfile_map_rows().
+    char *map;                // The mapping, starting on the page that holds row_begin.
+    size_t map_bytes;
+    double *data;             // Row row_begin.
+} matfile_t;
+
+// Open a file and check its header. Returns 0 on success, -1 with errno set otherwise (EINVAL
+// for a file that is not a matrix file this code can read).
+int matfile_open(matfile_t *f, const char *path);
+
+// Map rows [row_begin, row_end) read-only. Returns 0 on success, -1 with errno set otherwise.
+int matfile_map_rows(matfile_t *f, long row_begin, long row_end);
+
+// Global row i, which must be mapped.
+static inline double* matfile_row(const matfile_t *f, long i) {
+    return f->data + (i - f->row_begin) * (long) f->header.ld;
+}
+
+// The mapped rows as a Matrix (rows row_begin .. row_end-1 become rows 0 ..). Do not matrix_free it.
+void matfile_view(const matfile_t *f, Matrix *m);
+
+// Ask the kernel to start reading mapped rows [row_begin, row_end) ahead of use.
+void matfile_prefetch(const matfile_t *f, long row_begin, long row_end);
+
+// Drop mapped rows [row_begin, row_end) from memory; they are read from the file again if touched.
+void matfile_release(const matfile_t *f, long row_begin, long row_end);
+
+// Unmap and close.
+void matfile_close(matfile_t *f);
+
+// Write m to path in this format, keeping its leading dimension. Returns 0 on success, -1 with errno set otherwise.
+int matfile_write(const char *path, const Matrix *m);
+
+#endif
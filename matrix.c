@@ -0,0 +1,51 @@
+// File: matrix.c
+// Name: Bradley Stephen
+// Date: October 16, 2026
+// Assignment: MP1 - Shared Matrix Storage
+//
+// Description:
+//   Allocation for the contiguous, padded row-major Matrix type (see matrix.h).
+//   A whole matrix is a single posix_memalign call instead of one malloc per row.
+//
+#include <stdlib.h>
+#include <string.h>
+#include "matrix.h"
+
+// Row stride in doubles: cols rounded up to a whole number of MATRIX_ALIGNMENT blocks.
+static long padded_ld(int cols) {
+    const long pad = MATRIX_ALIGNMENT / sizeof(double);
+    return (cols + pad - 1) / pad * pad;
+}
+
+size_t matrix_bytes(int rows, int cols) {
+    size_t bytes = (size_t) rows * padded_ld(cols) * sizeof(double);
+    return bytes > 0 ? bytes : MATRIX_ALIGNMENT;
+}
+
+void matrix_wrap(Matrix *m, int rows, int cols, double *storage) {
+    m->rows = rows;
+    m->cols = cols;
+    m->ld = padded_ld(cols);
+    m->data = storage;
+    // Zero the padding once so kernels may safely read whole cache lines.
+    if (m->ld > cols) {
+        for (long i = 0; i < rows; i++) {
+            memset(matrix_row(m, i) + cols, 0, (m->ld - cols) * sizeof(double));
+        }
+    }
+}
+
+int matrix_alloc(Matrix *m, int rows, int cols) {
+    double *storage = NULL;
+    if (posix_memalign((void**) &storage, MATRIX_ALIGNMENT, matrix_bytes(rows, cols)) != 0) {
+        m->data = NULL;
+        return -1;
+    }
+    matrix_wrap(m, rows, cols, storage);
+    return 0;
+}
+
+void matrix_free(Matrix *m) {
+    free(m->data);
+    m->data = NULL;
+}
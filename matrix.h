@@ -0,0 +1,42 @@
+// File: matrix.h
+// Name: Bradley Stephen
+// Date: October 16, 2026
+// Assignment: MP1 - Shared Matrix Storage
+//
+// Description:
+//   Dense row-major matrix stored in one contiguous, 64-byte-aligned buffer.
+//   Each row is padded to a leading dimension (ld) that is a multiple of 8 doubles,
+//   so every row starts on its own cache line and SIMD loads never straddle rows.
+//   Row i starts at data + i * ld; the padding columns are zeroed.
+//
+#ifndef MATRIX_H
+#define MATRIX_H
+
+#include <stddef.h>
+
+#define MATRIX_ALIGNMENT 64
+
+typedef struct {
+    int rows;
+    int cols;
+    long ld;       // Leading dimension (row stride) in doubles, >= cols.
+    double *data;  // rows * ld doubles, MATRIX_ALIGNMENT-aligned.
+} Matrix;
+
+// Allocate a rows x cols matrix. Returns 0 on success, -1 if the allocation fails.
+int matrix_alloc(Matrix *m, int rows, int cols);
+
+void matrix_free(Matrix *m);
+
+// Bytes of storage a rows x cols matrix needs, including row padding.
+size_t matrix_bytes(int rows, int cols);
+
+// Lay a rows x cols matrix over caller-owned, MATRIX_ALIGNMENT-aligned storage of
+// matrix_bytes(rows, cols) bytes (e.g. from an arena). Do not matrix_free the result.
+void matrix_wrap(Matrix *m, int rows, int cols, double *storage);
+
+static inline double* matrix_row(const Matrix *m, long i) {
+    return m->data + i * m->ld;
+}
+
+#endif
@@ -7,31 +7,29 @@
 //   The approach taken is similar to computing a dot product for each row of the matrix.
 //   It also computes the same operation sequentially to ensure correctness.
 // Usage:
-//   Compile with: gcc -fopenmp matrix_vector_omp_dot.c -o matrix_vector_omp_dot
+//   Compile with: gcc -O2 -fopenmp matrix_vector_omp_dot.c matrix.c -o matrix_vector_omp_dot
 //   Run with: ./matrix_vector_omp_dot
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <omp.h>
+#include "matrix.h"
 
 #define M 10   // Number of rows in the matrix.
 #define N 10   // Number of columns in the matrix.
 #define NUM_THREADS 8
 
 int main() {
-    double **A;      // Matrix A.
+    Matrix A;        // Matrix A (contiguous, row-major).
     double *B, *P;   // Vector B and result vector P.
 
-    // Allocate memory for matrix A.
-    A = (double**) malloc(M * sizeof(double*));
-    for (int i = 0; i < M; i++) {
-        A[i] = (double*) malloc(N * sizeof(double));
-    }
+    // Allocate matrix A as a single aligned block.
+    int a_failed = matrix_alloc(&A, M, N);
     // Allocate memory for vectors B and P.
     B = (double*) malloc(N * sizeof(double));
     P = (double*) malloc(M * sizeof(double));
 
-    if (!A || !B || !P) {
+    if (a_failed || !B || !P) {
         perror("Memory allocation failed");
         exit(EXIT_FAILURE);
     }
@@ -39,7 +37,7 @@ int main() {
     // Initialize the matrix and vector with 1.0.
     for (int i = 0; i < M; i++)
         for (int j = 0; j < N; j++)
-            A[i][j] = 1.0;
+            matrix_row(&A, i)[j] = 1.0;
     for (int j = 0; j < N; j++)
         B[j] = 1.0;
 
@@ -48,9 +46,10 @@ int main() {
     // Use OpenMP to calculate each row's dot product.
 #pragma omp parallel for
     for (int i = 0; i < M; i++) {
+        const double *row = matrix_row(&A, i);
         double sum = 0.0;
         for (int j = 0; j < N; j++) {
-            sum += A[i][j] * B[j];
+            sum += row[j] * B[j];
         }
         P[i] = sum;
     }
@@ -58,9 +57,10 @@ int main() {
     // Sequential calculation for verification.
     double *P_seq = (double*) malloc(M * sizeof(double));
     for (int i = 0; i < M; i++) {
+        const double *row = matrix_row(&A, i);
         double sum = 0.0;
         for (int j = 0; j < N; j++) {
-            sum += A[i][j] * B[j];
+            sum += row[j] * B[j];
         }
         P_seq[i] = sum;
     }
@@ -80,10 +80,7 @@ int main() {
         printf("=== Matrix-Vector Multiplication (Dot Approach) ===\nThere was an error in the computation.\n");
 
     // Free all allocated memory.
-    for (int i = 0; i < M; i++) {
-        free(A[i]);
-    }
-    free(A);
+    matrix_free(&A);
     free(B);
     free(P);
     free(P_seq);
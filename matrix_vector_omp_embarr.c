@@ -6,32 +6,43 @@
 //   This program computes matrix-vector multiplication using OpenMP in an embarrassingly parallel way.
 //   Each thread processes a chunk of rows independently with no shared variable updates.
 //   A sequential version is used to verify the result.
+//   By default each thread takes one contiguous chunk of rows; --schedule=dynamic|guided|steal[:C]
+//   hands the rows out in chunks instead (see schedule.h), and each thread's busy time is printed.
 // Usage:
-//   Compile with: gcc -fopenmp matrix_vector_omp_embarr.c -o matrix_vector_omp_embarr
-//   Run with: ./matrix_vector_omp_embarr
+//   Compile with: gcc -O2 -fopenmp matrix_vector_omp_embarr.c matrix.c schedule.c -o matrix_vector_omp_embarr
+//   Run with: ./matrix_vector_omp_embarr [--schedule=static|dynamic|guided|steal[:C]]
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <omp.h>
+#include "matrix.h"
+#include "schedule.h"
 
 #define M 10   // Number of rows.
 #define N 10   // Number of columns.
 #define NUM_THREADS 8
 
-int main() {
-    double **A;      // Matrix A.
+int main(int argc, char *argv[]) {
+    Matrix A;        // Matrix A (contiguous, row-major).
     double *B, *P;   // Vector B and result vector P.
+    sched_opts_t schedule;
+    sched_t sched;
 
-    // Allocate memory for matrix A.
-    A = (double**) malloc(M * sizeof(double*));
-    for (int i = 0; i < M; i++) {
-        A[i] = (double*) malloc(N * sizeof(double));
+    sched_defaults(&schedule);
+    for (int i = 1; i < argc; i++) {
+        if (sched_parse_arg(&schedule, argv[i]) != 1) {
+            printf("Usage: %s [--schedule=static|dynamic|guided|steal[:C]]\n", argv[0]);
+            return 1;
+        }
     }
+
+    // Allocate matrix A as a single aligned block.
+    int a_failed = matrix_alloc(&A, M, N);
     // Allocate memory for vectors B and P.
     B = (double*) malloc(N * sizeof(double));
     P = (double*) malloc(M * sizeof(double));
 
-    if (!A || !B || !P) {
+    if (a_failed || !B || !P || sched_init(&sched, &schedule, NUM_THREADS) != 0) {
         perror("Memory allocation failed");
         exit(EXIT_FAILURE);
     }
@@ -39,41 +50,43 @@ int main() {
     // Initialize matrix A and vector B with 1.0.
     for (int i = 0; i < M; i++)
         for (int j = 0; j < N; j++)
-            A[i][j] = 1.0;
+            matrix_row(&A, i)[j] = 1.0;
     for (int j = 0; j < N; j++)
         B[j] = 1.0;
 
     omp_set_num_threads(NUM_THREADS);
 
-    // Use an embarrassingly parallel approach where each thread works on its own rows.
+    // Use an embarrassingly parallel approach where each thread works on its own rows:
+    // the contiguous chunk the static schedule gives it, or the chunks it claims or steals.
 #pragma omp parallel
     {
         int tid = omp_get_thread_num();
-        int num_threads = omp_get_num_threads();
-        // Calculate the number of rows per thread.
-        int rows_per_thread = M / num_threads;
-        int remainder = M % num_threads;
+        long start, end;
 
-        // Determine the start and end indices for this thread.
-        int start = tid * rows_per_thread + (tid < remainder ? tid : remainder);
-        int end = start + rows_per_thread + (tid < remainder ? 1 : 0);
+        // Split the rows among the team that actually started, which may be fewer than NUM_THREADS.
+#pragma omp single
+        sched_start(&sched, M, omp_get_num_threads());
 
         // Compute the partial result for assigned rows.
-        for (int i = start; i < end; i++) {
-            double sum = 0.0;
-            for (int j = 0; j < N; j++) {
-                sum += A[i][j] * B[j];
+        while (sched_next(&sched, tid, &start, &end)) {
+            for (int i = start; i < end; i++) {
+                const double *row = matrix_row(&A, i);
+                double sum = 0.0;
+                for (int j = 0; j < N; j++) {
+                    sum += row[j] * B[j];
+                }
+                P[i] = sum;
             }
-            P[i] = sum;
         }
     }
 
     // Sequential computation for verification.
     double *P_seq = (double*) malloc(M * sizeof(double));
     for (int i = 0; i < M; i++) {
+        const double *row = matrix_row(&A, i);
         double sum = 0.0;
         for (int j = 0; j < N; j++) {
-            sum += A[i][j] * B[j];
+            sum += row[j] * B[j];
         }
         P_seq[i] = sum;
     }
@@ -91,15 +104,14 @@ int main() {
         printf("=== Matrix-Vector Multiplication (Embarrassingly Parallel) ===\nResult is correct.\n");
     else
         printf("=== Matrix-Vector Multiplication (Embarrassingly Parallel) ===\nThere was an error in the computation.\n");
+    sched_report(&sched, "rows", 1);
 
     // Free all allocated memory.
-    for (int i = 0; i < M; i++) {
-        free(A[i]);
-    }
-    free(A);
+    matrix_free(&A);
     free(B);
     free(P);
     free(P_seq);
+    sched_destroy(&sched);
 
     return 0;
 }
@@ -0,0 +1,514 @@
+// File: mixed.c
+// Name: Bradley Stephen
+// Date: October 16, 2026
+// Assignment: MP1 - Mixed-Precision Kernels
+//
+// Description:
+//   Implementation of mixed.h. The SIMD loops are written once as macro templates over an ISA
+//   (avx2, avx512) and a storage format (fp32, bf16, fp16); each ISA supplies its vector types,
+//   width and a few helpers named <isa>_<op>, and each format a load that widens one vector of
+//   elements to fp32. With fp32 accumulation the products are fused into fp32 lanes; with fp64
+//   accumulation each fp32 vector is split into two fp64 halves first. Like gemv_kernels.c, a dot
+//   keeps four accumulators and a block two per row, and tails are finished with scalar code.
+//   The conversions are written out in C for the scalar variants and for packing, so this file
+//   builds without any -m flags.
+// Usage:
+//   Compile together with a driver and its dependencies, e.g. gcc -O2 -fopenmp perf_dot_product_omp.c mixed.c ...
+//
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "mixed.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define MIXED_X86 1
+#include <immintrin.h>
+#endif
+
+static inline float fp32_to_float(float x) {
+    return x;
+}
+
+// bf16 is the high half of an fp32.
+static inline float bf16_to_float(uint16_t h) {
+    uint32_t bits = (uint32_t) h << 16;
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+static inline float fp16_to_float(uint16_t h) {
+    uint32_t sign = (uint32_t) (h & 0x8000) << 16;
+    uint32_t exponent = (h >> 10) & 0x1F, mantissa = h & 0x3FF;
+    uint32_t bits;
+    if (exponent == 0) {
+        float f = (float) mantissa * 0x1p-24f;  // Zero or subnormal.
+        return sign ? -f : f;
+    } else if (exponent == 31) {
+        bits = sign | 0x7F800000 | (mantissa << 13);
+    } else {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    }
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+static uint16_t float_to_bf16(float f) {
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    if ((bits & 0x7FFFFFFF) > 0x7F800000) {
+        return (uint16_t) ((bits >> 16) | 0x40);  // Keep NaN a (quiet) NaN.
+    }
+    return (uint16_t) ((bits + 0x7FFF + ((bits >> 16) & 1)) >> 16);
+}
+
+static uint16_t float_to_fp16(float f) {
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    uint16_t sign = (uint16_t) ((bits >> 16) & 0x8000);
+    uint32_t magnitude = bits & 0x7FFFFFFF;
+    if (magnitude > 0x7F800000) {
+        return sign | 0x7E00;
+    }
+    if (magnitude >= 0x477FF000) {
+        return sign | 0x7C00;  // 65520 and up round to infinity.
+    }
+    if (magnitude < 0x38800000) {
+        // Below 2^-14: a multiple of 2^-24, rounded to nearest even by the current rounding mode.
+        return sign | (uint16_t) nearbyintf(fabsf(f) * 0x1p24f);
+    }
+    uint32_t rebias = magnitude - (112u << 23);  // Exponent bias 127 to 15.
+    return sign | (uint16_t) ((rebias + 0xFFF + ((rebias >> 13) & 1)) >> 13);
+}
+
+// One scalar dot and block per storage format and accumulation type.
+#define SCALAR_KERNELS(TYPE, CTYPE, ACC, ACCNAME)                                                    \
+static double dot_##TYPE##_##ACCNAME##_scalar(const void *A_, const void *B_, long n) {             \
+    const CTYPE *A = (const CTYPE*) A_, *B = (const CTYPE*) B_;                                      \
+    ACC sum = 0;                                                                                     \
+    for (long i = 0; i < n; i++) {                                                                   \
+        sum += (ACC) TYPE##_to_float(A[i]) * (ACC) TYPE##_to_float(B[i]);                            \
+    }                                                                                                \
+    return sum;                                                                                      \
+}                                                                                                    \
+static void block_##TYPE##_##ACCNAME##_scalar(const void *a, long lda, const void *B_, int n,       \
+                                              double *out) {                                         \
+    const CTYPE *a0 = (const CTYPE*) a, *a1 = a0 + lda, *a2 = a0 + 2 * lda, *a3 = a0 + 3 * lda;      \
+    const CTYPE *B = (const CTYPE*) B_;                                                              \
+    ACC s0 = 0, s1 = 0, s2 = 0, s3 = 0;                                                              \
+    for (int j = 0; j < n; j++) {                                                                    \
+        ACC b = TYPE##_to_float(B[j]);                                                               \
+        s0 += (ACC) TYPE##_to_float(a0[j]) * b;                                                      \
+        s1 += (ACC) TYPE##_to_float(a1[j]) * b;                                                      \
+        s2 += (ACC) TYPE##_to_float(a2[j]) * b;                                                      \
+        s3 += (ACC) TYPE##_to_float(a3[j]) * b;                                                      \
+    }                                                                                                \
+    out[0] = s0; out[1] = s1; out[2] = s2; out[3] = s3;                                              \
+}
+
+SCALAR_KERNELS(fp32, float, double, fp64)
+SCALAR_KERNELS(fp32, float, float, fp32)
+SCALAR_KERNELS(bf16, uint16_t, double, fp64)
+SCALAR_KERNELS(bf16, uint16_t, float, fp32)
+SCALAR_KERNELS(fp16, uint16_t, double, fp64)
+SCALAR_KERNELS(fp16, uint16_t, float, fp32)
+
+#ifdef MIXED_X86
+// AVX2: 8 floats per vector, 4 doubles per half.
+#define avx2_target "avx2,fma,f16c"
+#define avx2_width 8
+#define avx2_ps __m256
+#define avx2_pd __m256d
+#define avx2_zero_ps _mm256_setzero_ps
+#define avx2_zero_pd _mm256_setzero_pd
+#define avx2_fma_ps _mm256_fmadd_ps
+#define avx2_fma_pd _mm256_fmadd_pd
+
+__attribute__((target(avx2_target)))
+static inline __m256 avx2_load_fp32(const float *p) {
+    return _mm256_loadu_ps(p);
+}
+
+__attribute__((target(avx2_target)))
+static inline __m256 avx2_load_bf16(const uint16_t *p) {
+    __m256i wide = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*) p));
+    return _mm256_castsi256_ps(_mm256_slli_epi32(wide, 16));
+}
+
+__attribute__((target(avx2_target)))
+static inline __m256 avx2_load_fp16(const uint16_t *p) {
+    return _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*) p));
+}
+
+__attribute__((target(avx2_target)))
+static inline __m256d avx2_lo(__m256 v) {
+    return _mm256_cvtps_pd(_mm256_castps256_ps128(v));
+}
+
+__attribute__((target(avx2_target)))
+static inline __m256d avx2_hi(__m256 v) {
+    return _mm256_cvtps_pd(_mm256_extractf128_ps(v, 1));
+}
+
+__attribute__((target(avx2_target)))
+static inline float avx2_hsum_ps(__m256 v) {
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    return _mm_cvtss_f32(_mm_add_ss(s, _mm_movehdup_ps(s)));
+}
+
+__attribute__((target(avx2_target)))
+static inline double avx2_hsum_pd(__m256d v) {
+    __m128d s = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(s, s)));
+}
+
+// AVX-512: 16 floats per vector, 8 doubles per half.
+#define avx512_target "avx512f"
+#define avx512_width 16
+#define avx512_ps __m512
+#define avx512_pd __m512d
+#define avx512_zero_ps _mm512_setzero_ps
+#define avx512_zero_pd _mm512_setzero_pd
+#define avx512_fma_ps _mm512_fmadd_ps
+#define avx512_fma_pd _mm512_fmadd_pd
+#define avx512_hsum_ps _mm512_reduce_add_ps
+#define avx512_hsum_pd _mm512_reduce_add_pd
+
+__attribute__((target(avx512_target)))
+static inline __m512 avx512_load_fp32(const float *p) {
+    return _mm512_loadu_ps(p);
+}
+
+__attribute__((target(avx512_target)))
+static inline __m512 avx512_load_bf16(const uint16_t *p) {
+    __m512i wide = _mm512_cvtepu16_epi32(_mm256_loadu_si256((const __m256i*) p));
+    return _mm512_castsi512_ps(_mm512_slli_epi32(wide, 16));
+}
+
+__attribute__((target(avx512_target)))
+static inline __m512 avx512_load_fp16(const uint16_t *p) {
+    return _mm512_cvtph_ps(_mm256_loadu_si256((const __m256i*) p));
+}
+
+__attribute__((target(avx512_target)))
+static inline __m512d avx512_lo(__m512 v) {
+    return _mm512_cvtps_pd(_mm512_castps512_ps256(v));
+}
+
+__attribute__((target(avx512_target)))
+static inline __m512d avx512_hi(__m512 v) {
+    return _mm512_cvtps_pd(_mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(v), 1)));
+}
+
+// Dot product, fp32 lanes: four accumulators of W floats.
+#define DOT_FP32(ISA, TYPE, CTYPE)                                                                   \
+__attribute__((target(ISA##_target)))                                                               \
+static double dot_##TYPE##_fp32_##ISA(const void *A_, const void *B_, long n) {                     \
+    const CTYPE *A = (const CTYPE*) A_, *B = (const CTYPE*) B_;                                      \
+    const long W = ISA##_width;                                                                      \
+    ISA##_ps acc0 = ISA##_zero_ps(), acc1 = ISA##_zero_ps();                                         \
+    ISA##_ps acc2 = ISA##_zero_ps(), acc3 = ISA##_zero_ps();                                         \
+    long i = 0;                                                                                      \
+    for (; i + 4 * W <= n; i += 4 * W) {                                                             \
+        acc0 = ISA##_fma_ps(ISA##_load_##TYPE(A + i), ISA##_load_##TYPE(B + i), acc0);               \
+        acc1 = ISA##_fma_ps(ISA##_load_##TYPE(A + i + W), ISA##_load_##TYPE(B + i + W), acc1);       \
+        acc2 = ISA##_fma_ps(ISA##_load_##TYPE(A + i + 2 * W), ISA##_load_##TYPE(B + i + 2 * W), acc2); \
+        acc3 = ISA##_fma_ps(ISA##_load_##TYPE(A + i + 3 * W), ISA##_load_##TYPE(B + i + 3 * W), acc3); \
+    }                                                                                                \
+    float sum = (ISA##_hsum_ps(acc0) + ISA##_hsum_ps(acc1)) + (ISA##_hsum_ps(acc2) + ISA##_hsum_ps(acc3)); \
+    for (; i < n; i++) {                                                                             \
+        sum += TYPE##_to_float(A[i]) * TYPE##_to_float(B[i]);                                        \
+    }                                                                                                \
+    return sum;                                                                                      \
+}
+
+// Dot product, fp64 lanes: each pair of loaded vectors feeds two accumulators per half.
+#define DOT_FP64(ISA, TYPE, CTYPE)                                                                   \
+__attribute__((target(ISA##_target)))                                                               \
+static double dot_##TYPE##_fp64_##ISA(const void *A_, const void *B_, long n) {                     \
+    const CTYPE *A = (const CTYPE*) A_, *B = (const CTYPE*) B_;                                      \
+    const long W = ISA##_width;                                                                      \
+    ISA##_pd acc0 = ISA##_zero_pd(), acc1 = ISA##_zero_pd();                                         \
+    ISA##_pd acc2 = ISA##_zero_pd(), acc3 = ISA##_zero_pd();                                         \
+    long i = 0;                                                                                      \
+    for (; i + 2 * W <= n; i += 2 * W) {                                                             \
+        ISA##_ps a = ISA##_load_##TYPE(A + i), b = ISA##_load_##TYPE(B + i);                         \
+        acc0 = ISA##_fma_pd(ISA##_lo(a), ISA##_lo(b), acc0);                                         \
+        acc1 = ISA##_fma_pd(ISA##_hi(a), ISA##_hi(b), acc1);                                         \
+        a = ISA##_load_##TYPE(A + i + W);                                                            \
+        b = ISA##_load_##TYPE(B + i + W);                                                            \
+        acc2 = ISA##_fma_pd(ISA##_lo(a), ISA##_lo(b), acc2);                                         \
+        acc3 = ISA##_fma_pd(ISA##_hi(a), ISA##_hi(b), acc3);                                         \
+    }                                                                                                \
+    double sum = (ISA##_hsum_pd(acc0) + ISA##_hsum_pd(acc1)) + (ISA##_hsum_pd(acc2) + ISA##_hsum_pd(acc3)); \
+    for (; i < n; i++) {                                                                             \
+        sum += (double) TYPE##_to_float(A[i]) * TYPE##_to_float(B[i]);                               \
+    }                                                                                                \
+    return sum;                                                                                      \
+}
+
+// Four rows, fp32 lanes: every load of B feeds four rows, two accumulators per row.
+#define BLOCK_FP32(ISA, TYPE, CTYPE)                                                                 \
+__attribute__((target(ISA##_target)))                                                               \
+static void block_##TYPE##_fp32_##ISA(const void *a, long lda, const void *B_, int n, double *out) { \
+    const CTYPE *a0 = (const CTYPE*) a, *a1 = a0 + lda, *a2 = a0 + 2 * lda, *a3 = a0 + 3 * lda;      \
+    const CTYPE *B = (const CTYPE*) B_;                                                              \
+    const int W = ISA##_width;                                                                       \
+    ISA##_ps c00 = ISA##_zero_ps(), c01 = ISA##_zero_ps(), c10 = ISA##_zero_ps(), c11 = ISA##_zero_ps(); \
+    ISA##_ps c20 = ISA##_zero_ps(), c21 = ISA##_zero_ps(), c30 = ISA##_zero_ps(), c31 = ISA##_zero_ps(); \
+    int j = 0;                                                                                       \
+    for (; j + 2 * W <= n; j += 2 * W) {                                                             \
+        ISA##_ps b0 = ISA##_load_##TYPE(B + j), b1 = ISA##_load_##TYPE(B + j + W);                   \
+        c00 = ISA##_fma_ps(ISA##_load_##TYPE(a0 + j), b0, c00);                                      \
+        c01 = ISA##_fma_ps(ISA##_load_##TYPE(a0 + j + W), b1, c01);                                  \
+        c10 = ISA##_fma_ps(ISA##_load_##TYPE(a1 + j), b0, c10);                                      \
+        c11 = ISA##_fma_ps(ISA##_load_##TYPE(a1 + j + W), b1, c11);                                  \
+        c20 = ISA##_fma_ps(ISA##_load_##TYPE(a2 + j), b0, c20);                                      \
+        c21 = ISA##_fma_ps(ISA##_load_##TYPE(a2 + j + W), b1, c21);                                  \
+        c30 = ISA##_fma_ps(ISA##_load_##TYPE(a3 + j), b0, c30);                                      \
+        c31 = ISA##_fma_ps(ISA##_load_##TYPE(a3 + j + W), b1, c31);                                  \
+    }                                                                                                \
+    float s0 = ISA##_hsum_ps(c00) + ISA##_hsum_ps(c01), s1 = ISA##_hsum_ps(c10) + ISA##_hsum_ps(c11); \
+    float s2 = ISA##_hsum_ps(c20) + ISA##_hsum_ps(c21), s3 = ISA##_hsum_ps(c30) + ISA##_hsum_ps(c31); \
+    for (; j < n; j++) {                                                                             \
+        float b = TYPE##_to_float(B[j]);                                                             \
+        s0 += TYPE##_to_float(a0[j]) * b;                                                            \
+        s1 += TYPE##_to_float(a1[j]) * b;                                                            \
+        s2 += TYPE##_to_float(a2[j]) * b;                                                            \
+        s3 += TYPE##_to_float(a3[j]) * b;                                                            \
+    }                                                                                                \
+    out[0] = s0; out[1] = s1; out[2] = s2; out[3] = s3;                                              \
+}
+
+// Four rows, fp64 lanes: B's vector is split once and its halves feed four rows.
+#define BLOCK_FP64(ISA, TYPE, CTYPE)                                                                 \
+__attribute__((target(ISA##_target)))                                                               \
+static void block_##TYPE##_fp64_##ISA(const void *a, long lda, const void *B_, int n, double *out) { \
+    const CTYPE *a0 = (const CTYPE*) a, *a1 = a0 + lda, *a2 = a0 + 2 * lda, *a3 = a0 + 3 * lda;      \
+    const CTYPE *B = (const CTYPE*) B_;                                                              \
+    const int W = ISA##_width;                                                                       \
+    ISA##_pd c00 = ISA##_zero_pd(), c01 = ISA##_zero_pd(), c10 = ISA##_zero_pd(), c11 = ISA##_zero_pd(); \
+    ISA##_pd c20 = ISA##_zero_pd(), c21 = ISA##_zero_pd(), c30 = ISA##_zero_pd(), c31 = ISA##_zero_pd(); \
+    int j = 0;                                                                                       \
+    for (; j + W <= n; j += W) {                                                                     \
+        ISA##_ps b = ISA##_load_##TYPE(B + j);                                                       \
+        ISA##_pd b0 = ISA##_lo(b), b1 = ISA##_hi(b);                                                 \
+        ISA##_ps r = ISA##_load_##TYPE(a0 + j);                                                      \
+        c00 = ISA##_fma_pd(ISA##_lo(r), b0, c00);                                                    \
+        c01 = ISA##_fma_pd(ISA##_hi(r), b1, c01);                                                    \
+        r = ISA##_load_##TYPE(a1 + j);                                                               \
+        c10 = ISA##_fma_pd(ISA##_lo(r), b0, c10);                                                    \
+        c11 = ISA##_fma_pd(ISA##_hi(r), b1, c11);                                                    \
+        r = ISA##_load_##TYPE(a2 + j);                                                               \
+        c20 = ISA##_fma_pd(ISA##_lo(r), b0, c20);                                                    \
+        c21 = ISA##_fma_pd(ISA##_hi(r), b1, c21);                                                    \
+        r = ISA##_load_##TYPE(a3 + j);                                                               \
+        c30 = ISA##_fma_pd(ISA##_lo(r), b0, c30);                                                    \
+        c31 = ISA##_fma_pd(ISA##_hi(r), b1, c31);                                                    \
+    }                                                                                                \
+    double s0 = ISA##_hsum_pd(c00) + ISA##_hsum_pd(c01), s1 = ISA##_hsum_pd(c10) + ISA##_hsum_pd(c11); \
+    double s2 = ISA##_hsum_pd(c20) + ISA##_hsum_pd(c21), s3 = ISA##_hsum_pd(c30) + ISA##_hsum_pd(c31); \
+    for (; j < n; j++) {                                                                             \
+        double b = TYPE##_to_float(B[j]);                                                            \
+        s0 += TYPE##_to_float(a0[j]) * b;                                                            \
+        s1 += TYPE##_to_float(a1[j]) * b;                                                            \
+        s2 += TYPE##_to_float(a2[j]) * b;                                                            \
+        s3 += TYPE##_to_float(a3[j]) * b;                                                            \
+    }                                                                                                \
+    out[0] = s0; out[1] = s1; out[2] = s2; out[3] = s3;                                              \
+}
+
+#define SIMD_KERNELS(ISA, TYPE, CTYPE) \
+    DOT_FP32(ISA, TYPE, CTYPE)         \
+    DOT_FP64(ISA, TYPE, CTYPE)         \
+    BLOCK_FP32(ISA, TYPE, CTYPE)       \
+    BLOCK_FP64(ISA, TYPE, CTYPE)
+
+SIMD_KERNELS(avx2, fp32, float)
+SIMD_KERNELS(avx2, bf16, uint16_t)
+SIMD_KERNELS(avx2, fp16, uint16_t)
+SIMD_KERNELS(avx512, fp32, float)
+SIMD_KERNELS(avx512, bf16, uint16_t)
+SIMD_KERNELS(avx512, fp16, uint16_t)
+#endif
+
+typedef struct {
+    mixed_dot_fn dot;
+    mixed_block_fn block;
+} kernel_pair_t;
+
+// Indexed [storage - DTYPE_FP32][accum == DTYPE_FP32].
+#define KERNEL_ROW(ISA, TYPE) \
+    { { dot_##TYPE##_fp64_##ISA, block_##TYPE##_fp64_##ISA }, { dot_##TYPE##_fp32_##ISA, block_##TYPE##_fp32_##ISA } }
+
+static const kernel_pair_t scalar_kernels[3][2] = {
+    KERNEL_ROW(scalar, fp32), KERNEL_ROW(scalar, bf16), KERNEL_ROW(scalar, fp16)
+};
+#ifdef MIXED_X86
+static const kernel_pair_t avx2_kernels[3][2] = {
+    KERNEL_ROW(avx2, fp32), KERNEL_ROW(avx2, bf16), KERNEL_ROW(avx2, fp16)
+};
+static const kernel_pair_t avx512_kernels[3][2] = {
+    KERNEL_ROW(avx512, fp32), KERNEL_ROW(avx512, bf16), KERNEL_ROW(avx512, fp16)
+};
+#endif
+
+void mixed_defaults(mixed_t *m) {
+    memset(m, 0, sizeof(*m));
+    m->storage = DTYPE_FP64;
+    m->accum = DTYPE_FP64;
+}
+
+static int parse_dtype(const char *name, dtype_t *t) {
+    if (strcmp(name, "fp64") == 0) *t = DTYPE_FP64;
+    else if (strcmp(name, "fp32") == 0) *t = DTYPE_FP32;
+    else if (strcmp(name, "bf16") == 0) *t = DTYPE_BF16;
+    else if (strcmp(name, "fp16") == 0) *t = DTYPE_FP16;
+    else return -1;
+    return 0;
+}
+
+int mixed_parse_arg(mixed_t *m, const char *arg) {
+    if (strncmp(arg, "--dtype=", 8) == 0) {
+        return parse_dtype(arg + 8, &m->storage) == 0 ? 1 : -1;
+    }
+    if (strncmp(arg, "--accum=", 8) == 0) {
+        dtype_t t;
+        if (parse_dtype(arg + 8, &t) != 0 || (t != DTYPE_FP64 && t != DTYPE_FP32)) {
+            return -1;
+        }
+        m->accum = t;
+        return 1;
+    }
+    return 0;
+}
+
+int mixed_init(mixed_t *m, dot_kernel_t kernel) {
+    m->isa = NULL;
+    m->dot = NULL;
+    m->block = NULL;
+    if (m->storage == DTYPE_FP64) {
+        return (m->accum == DTYPE_FP64) ? 0 : -1;
+    }
+    const kernel_pair_t (*table)[2] = NULL;
+    const char *isa = NULL;
+#ifdef MIXED_X86
+    int avx512 = __builtin_cpu_supports("avx512f");
+    int avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") && __builtin_cpu_supports("f16c");
+    if ((kernel == DOT_KERNEL_AUTO || kernel == DOT_KERNEL_AVX512) && avx512) {
+        table = avx512_kernels;
+        isa = "avx512";
+    } else if ((kernel == DOT_KERNEL_AUTO || kernel == DOT_KERNEL_AVX2) && avx2) {
+        table = avx2_kernels;
+        isa = "avx2";
+    }
+#endif
+    if (!table && (kernel == DOT_KERNEL_AUTO || kernel == DOT_KERNEL_SCALAR)) {
+        table = scalar_kernels;
+        isa = "scalar";
+    }
+    if (!table) {
+        return -1;
+    }
+    const kernel_pair_t *pair = &table[m->storage - DTYPE_FP32][m->accum == DTYPE_FP32];
+    m->isa = isa;
+    m->dot = pair->dot;
+    m->block = pair->block;
+    return 0;
+}
+
+size_t dtype_bytes(dtype_t t) {
+    switch (t) {
+    case DTYPE_FP64: return sizeof(double);
+    case DTYPE_FP32: return sizeof(float);
+    case DTYPE_BF16:
+    case DTYPE_FP16: return sizeof(uint16_t);
+    }
+    return sizeof(double);
+}
+
+const char* dtype_name(dtype_t t) {
+    switch (t) {
+    case DTYPE_FP64: return "fp64";
+    case DTYPE_FP32: return "fp32";
+    case DTYPE_BF16: return "bf16";
+    case DTYPE_FP16: return "fp16";
+    }
+    return "unknown";
+}
+
+void mixed_name(const mixed_t *m, char *buf, size_t size) {
+    snprintf(buf, size, "%s/%s", dtype_name(m->storage), dtype_name(m->accum));
+}
+
+double mixed_store_error(const mixed_t *m) {
+    // The 16-bit formats are rounded through fp32, which adds at most 2^-24 (plus a product term).
+    switch (m->storage) {
+    case DTYPE_FP64: return 0.0;
+    case DTYPE_FP32: return 0x1p-24;
+    case DTYPE_BF16: return 0x1p-8 + 0x1p-23;
+    case DTYPE_FP16: return 0x1p-11 + 0x1p-23;
+    }
+    return 0.0;
+}
+
+double mixed_sum_error(const mixed_t *m) {
+    return (m->accum == DTYPE_FP32) ? 0x1p-24 : 0x1p-53;
+}
+
+void mixed_pack(dtype_t t, const double *src, void *dst, long n) {
+    switch (t) {
+    case DTYPE_FP64:
+        memcpy(dst, src, (size_t) n * sizeof(double));
+        break;
+    case DTYPE_FP32:
+        for (long i = 0; i < n; i++) {
+            ((float*) dst)[i] = (float) src[i];
+        }
+        break;
+    case DTYPE_BF16:
+        for (long i = 0; i < n; i++) {
+            ((uint16_t*) dst)[i] = float_to_bf16((float) src[i]);
+        }
+        break;
+    case DTYPE_FP16:
+        for (long i = 0; i < n; i++) {
+            ((uint16_t*) dst)[i] = float_to_fp16((float) src[i]);
+        }
+        break;
+    }
+}
+
+void mixed_gemv(const mixed_t *m, const void *A, long lda, int cols, const void *B, double *P, int row_begin,
+                int row_end, const gemv_plan_t *plan) {
+    double out[GEMV_BLOCK_ROWS];
+    if (cols == 0) {
+        // No column tiles: every product is the empty sum.
+        for (int i = row_begin; i < row_end; i++) {
+            P[i] = 0.0;
+        }
+        return;
+    }
+    for (int p0 = row_begin; p0 < row_end; p0 += plan->row_panel) {
+        int p1 = (p0 + plan->row_panel < row_end) ? p0 + plan->row_panel : row_end;
+        for (int j0 = 0; j0 < cols; j0 += plan->col_tile) {
+            int len = (j0 + plan->col_tile < cols) ? plan->col_tile : cols - j0;
+            int first = (j0 == 0);
+            const void *Bj = mixed_at(m->storage, B, j0);
+            int i = p0;
+            for (; i + GEMV_BLOCK_ROWS <= p1; i += GEMV_BLOCK_ROWS) {
+                m->block(mixed_at(m->storage, A, (long) i * lda + j0), lda, Bj, len, out);
+                for (int r = 0; r < GEMV_BLOCK_ROWS; r++) {
+                    P[i + r] = first ? out[r] : P[i + r] + out[r];
+                }
+            }
+            for (; i < p1; i++) {
+                double s = m->dot(mixed_at(m->storage, A, (long) i * lda + j0), Bj, len);
+                P[i] = first ? s : P[i] + s;
+            }
+        }
+    }
+}
@@ -0,0 +1,87 @@
+// File: mixed.h
+// Name: Bradley Stephen
+// Date: October 16, 2026
+// Assignment: MP1 - Mixed-Precision Kernels
+//
+// Description:
+//   Dot product and matrix-vector kernels on vectors stored in a narrower format than double,
+//   selected with --dtype=fp64|fp32|bf16|fp16 (storage) and --accum=fp64|fp32 (accumulation).
+//   Both operands are stored in the --dtype format, widened to fp32 in registers (bf16 by a shift,
+//   fp16 with the F16C/AVX-512 conversions) and their products summed in fp32 lanes or, after a
+//   further conversion, in fp64 lanes. The kernels are memory-bound, so halving or quartering the
+//   bytes per element is meant to raise throughput by about as much; --accum=fp64 keeps the sum's
+//   rounding at the fp64 level, so the only added error is the rounding of the stored inputs.
+//   fp64 storage is the drivers' original path (dot_kernels.h, gemv_kernels.h); these kernels cover
+//   the narrow formats. Each variant (scalar, AVX2, AVX-512) is generated from one macro template
+//   per loop, for every storage format and accumulation.
+//   Drivers keep the generated fp64 data for the reference (see verify.h) and time packed copies,
+//   so the error they report is against the unrounded inputs.
+//
+#ifndef MIXED_H
+#define MIXED_H
+
+#include <stddef.h>
+#include "dot_kernels.h"
+#include "gemv_kernels.h"
+
+typedef enum { DTYPE_FP64, DTYPE_FP32, DTYPE_BF16, DTYPE_FP16 } dtype_t;
+
+// sum(A[i] * B[i]) for i in [0, n).
+typedef double (*mixed_dot_fn)(const void *A, const void *B, long n);
+
+// Dot products of GEMV_BLOCK_ROWS rows (stride lda elements) with B[0..n), written to out.
+typedef void (*mixed_block_fn)(const void *a, long lda, const void *B, int n, double *out);
+
+typedef struct {
+    dtype_t storage;       // Format of A and B (--dtype).
+    dtype_t accum;         // DTYPE_FP64 or DTYPE_FP32: format the products are summed in (--accum).
+    const char *isa;       // Variant picked by mixed_init(), or NULL for fp64 storage.
+    mixed_dot_fn dot;
+    mixed_block_fn block;
+} mixed_t;
+
+// Set the defaults (fp64 storage and accumulation: the original kernels).
+void mixed_defaults(mixed_t *m);
+
+// Consume --dtype=fp64|fp32|bf16|fp16 or --accum=fp64|fp32. Returns 1 if arg was one, 0 if it is
+// not ours, -1 if its value is bad (the bench_parse_arg() convention).
+int mixed_parse_arg(mixed_t *m, const char *arg);
+
+// Pick the kernels: the widest variant this CPU runs for DOT_KERNEL_AUTO, or the one forced with
+// --kernel. Returns 0 on success, -1 if the combination has no kernel (fp32 accumulation of fp64
+// storage, or the sse variant, which has no narrow loads) or the CPU cannot run it.
+int mixed_init(mixed_t *m, dot_kernel_t kernel);
+
+// 1 if the data is stored narrower than fp64, so the mixed kernels run.
+static inline int mixed_reduced(const mixed_t *m) {
+    return m->storage != DTYPE_FP64;
+}
+
+size_t dtype_bytes(dtype_t t);
+
+const char* dtype_name(dtype_t t);
+
+// "bf16/fp32": storage, then accumulation.
+void mixed_name(const mixed_t *m, char *buf, size_t size);
+
+// Largest relative error of rounding an fp64 input to the storage format (0 for fp64), and the
+// unit roundoff of the accumulation; together they bound the error (verify_check_mixed()).
+double mixed_store_error(const mixed_t *m);
+double mixed_sum_error(const mixed_t *m);
+
+// Round src[0..n) to format t into dst[0..n): round to nearest even, through fp32 for the 16-bit
+// formats; fp16 overflows to infinity above 65504.
+void mixed_pack(dtype_t t, const double *src, void *dst, long n);
+
+// Element `index` of a vector stored in format t.
+static inline void* mixed_at(dtype_t t, const void *base, long index) {
+    return (char*) base + index * (long) dtype_bytes(t);
+}
+
+// P[i] = A[i,:] . B for row_begin <= i < row_end, where A is row-major with stride lda elements
+// and A and B are stored in m's format. Tiled like gemv_blocked() with plan's tile sizes; each
+// tile's partial is summed in the accumulation format and the tiles are added in fp64.
+void mixed_gemv(const mixed_t *m, const void *A, long lda, int cols, const void *B, double *P, int row_begin,
+                int row_end, const gemv_plan_t *plan);
+
+#endif
@@ -5,117 +5,706 @@
 //
 // Description:
 //   This MPI program computes the dot product of two vectors.
-//   Process 0 initializes two global vectors (filled with 1.0) and distributes
-//   them among all processes using MPI_Scatterv. Each process computes its local
-//   dot product, and then all partial sums are reduced (summed) to process 0.
-//   The parallel computation is timed using MPI_Wtime() over several runs,
-//   and the average runtime is printed along with a correctness check.
+//   With --dist=local (default) every process generates its own slice of the two vectors, so no
+//   process holds the global vectors and sizes beyond INT_MAX work. The data comes from the seeded
+//   generators in input.h (--init=ones|uniform|normal|ill|sparse, --seed=S; uniform by default);
+//   an element depends only on its global index, so every distribution sees the same vectors.
+//   With --dist=scatter, process 0 generates the global vectors and distributes them among
+//   all processes once using MPI_Scatterv; the slices then stay resident for every run.
+//   --dist=rescatter scatters again before every run, as the original program did. Both scatter
+//   modes are limited to INT_MAX elements by MPI's int displacements. Each process computes its
+//   local dot product, and then all partial sums are combined with the --reduce algorithm:
+//     reduce             - MPI_Reduce to process 0 (default; the original program)
+//     allreduce          - MPI_Allreduce, so every rank has the result, as an iterative solver needs
+//     iallreduce         - MPI_Iallreduce followed by MPI_Wait
+//     recursive-doubling - hand-written allreduce: log2(p) rounds of MPI_Sendrecv with partner
+//                          rank ^ 2^r. With p not a power of two, the first 2 * (p - p2) ranks pair up
+//                          beforehand so p2 (the largest power of two <= p) ranks take part, and the
+//                          odd partners pass the result back afterwards.
+//   With the allreduce variants every rank checks its own copy of the result.
+//   For latency, give a tiny vector and many runs (run_all_mpi.sh sweeps these): the run is then
+//   almost entirely the collective.
+//   --sum=repro makes the result bit-for-bit independent of the rank count, thread count and
+//   --reduce algorithm (see repro.h): the slices are cut on fixed block boundaries, each thread adds
+//   its blocks' partials into an exact accumulator, and the ranks combine the accumulators' digits
+//   (REPRO_DIGITS 64-bit integers) with the selected algorithm. Each run then also times the fast
+//   path (one double per rank) right after; its phases and the overhead are printed.
+//   Each run is timed on every rank with the shared harness (see bench.h); the slowest rank's time
+//   counts. Warm-up runs are dropped, and min/median/p90/max/stddev, GFLOP/s and GB/s of the whole
+//   run are printed with a correctness check, optionally as JSON/CSV records. The setup
+//   (generate or scatter) and each run's phases (scatter with rescatter, compute, reduce) are
+//   also timed per rank and reported as max/min/mean/imbalance across ranks (see phase_timer.h).
+//   --scaling only labels the records, since the global size is given directly.
+//   The local dot product uses the shared kernels in dot_kernels.h, selected with --kernel.
+//   The result is checked against a compensated reference with an n-scaled tolerance (see verify.h);
+//   each rank builds the reference for its own slice once, outside the timed region. --no-verify skips it.
+//   Hybrid mode: --threads=T runs T OpenMP threads inside every rank (MPI_THREAD_FUNNELED, so only
+//   the main thread calls MPI). Each thread first-touches, and later reads, its own contiguous chunk
+//   of the rank's slice; the kernel and the reference are split over the same chunks. Launch
+//   ranks-per-node x T = cores per node, e.g. mpirun -np 4 --map-by ppr:2:node:pe=8 with --threads=8.
+//   --dtype=fp32|bf16|fp16 stores the slices in a narrower format and runs the mixed-precision kernels
+//   (see mixed.h), summing in fp64 or, with --accum=fp32, in fp32. The fp64 slices are still generated
+//   or scattered for the reference, and each thread rounds its chunk into packed copies (setup phase
+//   "pack"); --dist=rescatter scatters the packed vectors, so every run moves the narrower data too.
+//   The error of the result against the fp64 reference is printed.
 //
 // Usage:
-//   mpicc mpi_dot_product.c -o mpi_dot_product
+//   mpicc -O2 -fopenmp mpi_dot_product.c dot_kernels.c bench.c verify.c phase_timer.c repro.c input.c mixed.c -o mpi_dot_product -lm
 //   mpirun -np <num_processes> ./mpi_dot_product <global_vector_size> [num_runs]
+//          [--kernel=auto|scalar|sse|avx2|avx512] [--scaling=strong|weak] [--dist=local|scatter|rescatter]
+//          [--threads=T] [--reduce=reduce|allreduce|iallreduce|recursive-doubling] [--sum=fast|repro]
+//          [--init=ones|uniform|normal|ill|sparse] [--seed=S] [--dtype=fp64|fp32|bf16|fp16] [--accum=fp64|fp32]
+//          [--warmup=N] [--format=text|json|csv] [--output=FILE] [--no-verify]
 #include <mpi.h>
+#include <limits.h>
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <omp.h>
+#include "dot_kernels.h"
+#include "bench.h"
+#include "verify.h"
+#include "phase_timer.h"
+#include "repro.h"
+#include "input.h"
+#include "mixed.h"
+
+typedef enum { DIST_LOCAL, DIST_SCATTER, DIST_RESCATTER } dist_mode_t;
+
+static const char *dist_names[] = { "local", "scatter", "rescatter" };
+
+typedef enum { COLL_REDUCE, COLL_ALLREDUCE, COLL_IALLREDUCE, COLL_RECURSIVE_DOUBLING } collective_t;
+
+static const char *coll_names[] = { "reduce", "allreduce", "iallreduce", "recursive-doubling" };
+
+// Largest payload recursive_doubling_allreduce() receives into a stack buffer (one exact
+// accumulator's digits); larger ones get a heap buffer.
+#define RD_MAX_BYTES (REPRO_DIGITS * sizeof(int64_t))
+
+// Sum of buf over comm (count elements of type), left in buf on every rank. The p - p2 ranks beyond
+// the largest power of two p2 first fold into a partner (the even rank of each of the first (p - p2)
+// pairs sends to the odd one), the p2 remaining ranks exchange with rank ^ mask for each bit of mask,
+// and the folded ranks get the result back. a + b == b + a, so both partners of an exchange hold the
+// same sum.
+static void recursive_doubling_allreduce(void *buf, int count, MPI_Datatype type, MPI_Comm comm) {
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    int p2 = 1;
+    while (p2 * 2 <= size) {
+        p2 *= 2;
+    }
+    int extra = size - p2;
+    MPI_Aint lb, extent;
+    MPI_Type_get_extent(type, &lb, &extent);
+    size_t bytes = (size_t) count * (size_t) extent;
+    char local[RD_MAX_BYTES];
+    char *other = local;
+    if (bytes > sizeof(local)) {
+        other = (char*) malloc(bytes);
+        if (!other) {
+            perror("Memory allocation failed");
+            exit(EXIT_FAILURE);
+        }
+    }
+    
+    // Fold: ranks below 2 * extra pair up and the even one drops out.
+    int vrank;  // Rank among the p2 taking part, or -1.
+    if (rank < 2 * extra) {
+        if (rank % 2 == 0) {
+            MPI_Send(buf, count, type, rank + 1, 0, comm);
+            vrank = -1;
+        } else {
+            MPI_Recv(other, count, type, rank - 1, 0, comm, MPI_STATUS_IGNORE);
+            MPI_Reduce_local(other, buf, count, type, MPI_SUM);
+            vrank = rank / 2;
+        }
+    } else {
+        vrank = rank - extra;
+    }
+    
+    if (vrank >= 0) {
+        for (int mask = 1; mask < p2; mask <<= 1) {
+            int vpartner = vrank ^ mask;
+            int partner = (vpartner < extra) ? vpartner * 2 + 1 : vpartner + extra;
+            MPI_Sendrecv(buf, count, type, partner, 1, other, count, type, partner, 1, comm, MPI_STATUS_IGNORE);
+            MPI_Reduce_local(other, buf, count, type, MPI_SUM);
+        }
+    }
+    
+    // Unfold: the odd ranks hand the result to the partners that dropped out.
+    if (rank < 2 * extra) {
+        if (rank % 2 == 0)
+            MPI_Recv(buf, count, type, rank + 1, 2, comm, MPI_STATUS_IGNORE);
+        else
+            MPI_Send(buf, count, type, rank - 1, 2, comm);
+    }
+    if (other != local) {
+        free(other);
+    }
+}
+
+// Sum send over MPI_COMM_WORLD into recv with the selected algorithm: on process 0 for
+// COLL_REDUCE, on every rank otherwise.
+static void combine(collective_t coll, const void *send, void *recv, int count, MPI_Datatype type) {
+    if (coll == COLL_REDUCE) {
+        MPI_Reduce(send, recv, count, type, MPI_SUM, 0, MPI_COMM_WORLD);
+    } else if (coll == COLL_ALLREDUCE) {
+        MPI_Allreduce(send, recv, count, type, MPI_SUM, MPI_COMM_WORLD);
+    } else if (coll == COLL_IALLREDUCE) {
+        MPI_Request request;
+        MPI_Iallreduce(send, recv, count, type, MPI_SUM, MPI_COMM_WORLD, &request);
+        MPI_Wait(&request, MPI_STATUS_IGNORE);
+    } else {
+        int type_size;
+        MPI_Type_size(type, &type_size);
+        memcpy(recv, send, (size_t) count * type_size);
+        recursive_doubling_allreduce(recv, count, type, MPI_COMM_WORLD);
+    }
+}
+
+// Reproducible local dot product: each thread adds its whole blocks of the slice (which starts on a
+// block boundary) into its accumulator in accs; the merged, normalized total goes to local.
+static void local_repro(dot_kernel_fn dot_kernel, const double *A, const double *B, long n, repro_acc_t *accs,
+                        repro_acc_t *local) {
+    int nthreads = 1;
+#pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        long start, end;
+        if (tid == 0) {
+            nthreads = omp_get_num_threads();
+        }
+        repro_range(n, tid, omp_get_num_threads(), &start, &end);
+        repro_init(&accs[tid]);
+        repro_dot(&accs[tid], dot_kernel, A + start, B + start, end - start);
+    }
+    repro_init(local);
+    for (int t = 0; t < nthreads; t++) {
+        repro_merge(local, &accs[t]);
+    }
+    repro_normalize(local);
+}
+
+// Set x[0..n) to value, each thread writing the chunk it later reads in parallel_dot.
+static void fill_parallel(double *x, long n, double value) {
+#pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        int nthreads = omp_get_num_threads();
+        long chunk = n / nthreads;
+        long remainder = n % nthreads;
+        long start = tid * chunk + (tid < remainder ? tid : remainder);
+        long end = start + chunk + (tid < remainder ? 1 : 0);
+        for (long i = start; i < end; i++) {
+            x[i] = value;
+        }
+    }
+}
+
+// Generate elements first .. first+n-1 of a stream into x[0..n), each thread the chunk it later
+// reads in parallel_dot.
+static void generate_parallel(const input_t *input, input_stream_t stream, long first, double *x, long n) {
+#pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        int nthreads = omp_get_num_threads();
+        long chunk = n / nthreads;
+        long remainder = n % nthreads;
+        long start = tid * chunk + (tid < remainder ? tid : remainder);
+        long len = chunk + (tid < remainder ? 1 : 0);
+        input_fill(input, stream, 0, first + start, x + start, 1, len);
+    }
+}
+
+// Round x[0..n) into x_low in the --dtype format, each thread the chunk it later reads in parallel_dot.
+static void pack_parallel(const mixed_t *mixed, const double *x, void *x_low, long n) {
+#pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        int nthreads = omp_get_num_threads();
+        long chunk = n / nthreads;
+        long remainder = n % nthreads;
+        long start = tid * chunk + (tid < remainder ? tid : remainder);
+        long len = chunk + (tid < remainder ? 1 : 0);
+        mixed_pack(mixed->storage, x + start, mixed_at(mixed->storage, x_low, start), len);
+    }
+}
+
+// MPI type of one element stored in format t.
+static MPI_Datatype storage_type(dtype_t t) {
+    switch (t) {
+    case DTYPE_FP32: return MPI_FLOAT;
+    case DTYPE_BF16:
+    case DTYPE_FP16: return MPI_UINT16_T;
+    default:         return MPI_DOUBLE;
+    }
+}
+
+// Local dot product: one contiguous chunk per thread through the selected kernel, or through the
+// mixed-precision kernel on the packed A_low and B_low when the data is stored narrower.
+static double parallel_dot(dot_kernel_fn dot_kernel, const mixed_t *mixed, const double *A, const double *B,
+                           const void *A_low, const void *B_low, long n) {
+    double sum = 0.0;
+#pragma omp parallel reduction(+:sum)
+    {
+        int tid = omp_get_thread_num();
+        int nthreads = omp_get_num_threads();
+        long chunk = n / nthreads;
+        long remainder = n % nthreads;
+        long start = tid * chunk + (tid < remainder ? tid : remainder);
+        long len = chunk + (tid < remainder ? 1 : 0);
+        if (mixed_reduced(mixed)) {
+            sum += mixed->dot(mixed_at(mixed->storage, A_low, start), mixed_at(mixed->storage, B_low, start), len);
+        } else {
+            sum += dot_kernel(A + start, B + start, len);
+        }
+    }
+    return sum;
+}
+
+// Compensated reference for the local slice, built over the kernel's chunks and merged in thread order.
+static void dot_reference(const double *A, const double *B, long n, verify_ref_t *ref) {
+    int max_threads = omp_get_max_threads();
+    verify_ref_t *parts = (verify_ref_t*) calloc(max_threads, sizeof(verify_ref_t));
+    if (!parts) {
+        perror("Memory allocation failed");
+        exit(EXIT_FAILURE);
+    }
+#pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        int nthreads = omp_get_num_threads();
+        long chunk = n / nthreads;
+        long remainder = n % nthreads;
+        long start = tid * chunk + (tid < remainder ? tid : remainder);
+        long len = chunk + (tid < remainder ? 1 : 0);
+        verify_dot_ref(A + start, B + start, 1, len, &parts[tid]);
+    }
+    verify_ref_t total = {0};
+    for (int t = 0; t < max_threads; t++) {
+        verify_ref_merge(&total, &parts[t]);
+    }
+    *ref = total;
+    free(parts);
+}
 
 int main(int argc, char* argv[]) {
     int rank, size;
-    int global_n, num_runs = 5;
+    long global_n;
+    int num_runs = 5;
     double *A = NULL, *B = NULL; // Full vectors on root.
     double *local_A, *local_B;
+    void *A_low = NULL, *B_low = NULL;              // Packed full vectors on root (--dist=rescatter).
+    void *local_A_low = NULL, *local_B_low = NULL;  // Packed slices (--dtype narrower than fp64).
     double local_dot, global_dot;
-    double start_time, end_time, total_time = 0.0;
     
-    MPI_Init(&argc, &argv);
+    // Only the main thread calls MPI; the OpenMP regions contain none.
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
     MPI_Comm_size(MPI_COMM_WORLD, &size);
     
+    dot_kernel_t kernel = DOT_KERNEL_AUTO;
+    const char *scaling = "strong";
+    int verify = 1;
+    dist_mode_t dist = DIST_LOCAL;
+    int threads = 1;  // OpenMP threads per rank.
+    collective_t coll = COLL_REDUCE;
+    int repro = 0;  // --sum=fast
+    bench_t bench;
+    bench_defaults(&bench);
+    input_t input;
+    input_defaults(&input);
+    mixed_t mixed;
+    mixed_defaults(&mixed);
+    // Pull --option=value flags out of argv so the positional arguments keep their places.
+    int nargs = 1, rc;
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--kernel=", 9) == 0) {
+            if (dot_kernel_parse(argv[i] + 9, &kernel) != 0) {
+                if (rank == 0)
+                    printf("Unknown kernel: %s\n", argv[i] + 9);
+                MPI_Finalize();
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--scaling=", 10) == 0) {
+            scaling = argv[i] + 10;
+        } else if (strncmp(argv[i], "--dist=", 7) == 0) {
+            if (strcmp(argv[i] + 7, "local") == 0) {
+                dist = DIST_LOCAL;
+            } else if (strcmp(argv[i] + 7, "scatter") == 0) {
+                dist = DIST_SCATTER;
+            } else if (strcmp(argv[i] + 7, "rescatter") == 0) {
+                dist = DIST_RESCATTER;
+            } else {
+                if (rank == 0)
+                    printf("Unknown distribution: %s\n", argv[i] + 7);
+                MPI_Finalize();
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--threads=", 10) == 0) {
+            threads = atoi(argv[i] + 10);
+            if (threads < 1) {
+                if (rank == 0)
+                    printf("Thread count must be at least 1\n");
+                MPI_Finalize();
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--reduce=", 9) == 0) {
+            int found = 0;
+            for (int c = COLL_REDUCE; c <= COLL_RECURSIVE_DOUBLING; c++) {
+                if (strcmp(argv[i] + 9, coll_names[c]) == 0) {
+                    coll = (collective_t) c;
+                    found = 1;
+                }
+            }
+            if (!found) {
+                if (rank == 0)
+                    printf("Unknown reduction: %s\n", argv[i] + 9);
+                MPI_Finalize();
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--sum=", 6) == 0) {
+            if (strcmp(argv[i] + 6, "fast") == 0) {
+                repro = 0;
+            } else if (strcmp(argv[i] + 6, "repro") == 0) {
+                repro = 1;
+            } else {
+                if (rank == 0)
+                    printf("Unknown summation mode: %s\n", argv[i] + 6);
+                MPI_Finalize();
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--no-verify") == 0) {
+            verify = 0;
+        } else if ((rc = bench_parse_arg(&bench, argv[i])) != 0 || (rc = input_parse_arg(&input, argv[i])) != 0 ||
+                   (rc = mixed_parse_arg(&mixed, argv[i])) != 0) {
+            if (rc < 0) {
+                if (rank == 0)
+                    printf("Invalid option: %s\n", argv[i]);
+                MPI_Finalize();
+                return 1;
+            }
+        } else {
+            argv[nargs++] = argv[i];
+        }
+    }
+    argc = nargs;
+    
     if (argc < 2) {
         if (rank == 0)
-            printf("Usage: %s <global_vector_size> [num_runs]\n", argv[0]);
+            printf("Usage: %s <global_vector_size> [num_runs] [--kernel=auto|scalar|sse|avx2|avx512] [--scaling=strong|weak] [--dist=local|scatter|rescatter] [--threads=T] [--reduce=reduce|allreduce|iallreduce|recursive-doubling] [--sum=fast|repro] [--init=ones|uniform|normal|ill|sparse] [--seed=S] [--dtype=fp64|fp32|bf16|fp16] [--accum=fp64|fp32] [--warmup=N] [--format=text|json|csv] [--output=FILE] [--no-verify]\n", argv[0]);
+        MPI_Finalize();
+        return 1;
+    }
+    
+    if (threads > 1 && provided < MPI_THREAD_FUNNELED) {
+        if (rank == 0)
+            printf("The MPI library does not support MPI_THREAD_FUNNELED; use --threads=1\n");
+        MPI_Finalize();
+        return 1;
+    }
+    omp_set_num_threads(threads);
+    
+    char precision[16];
+    mixed_name(&mixed, precision, sizeof(precision));
+    if (mixed_init(&mixed, kernel) != 0) {
+        if (rank == 0)
+            printf("Precision %s is not available with kernel %s\n", precision, dot_kernel_name(kernel));
+        MPI_Finalize();
+        return 1;
+    }
+    int low = mixed_reduced(&mixed);
+    if (low && repro) {
+        if (rank == 0)
+            printf("--sum=repro requires --dtype=fp64\n");
+        MPI_Finalize();
+        return 1;
+    }
+    kernel = dot_kernel_resolve(kernel);
+    dot_kernel_fn dot_kernel = dot_kernel_get(kernel);
+    if (!dot_kernel) {
+        if (rank == 0)
+            printf("Kernel %s is not supported on this CPU\n", dot_kernel_name(kernel));
         MPI_Finalize();
         return 1;
     }
     
-    global_n = atoi(argv[1]);
+    global_n = atol(argv[1]);
+    if (dist != DIST_LOCAL && global_n > INT_MAX) {
+        if (rank == 0)
+            printf("--dist=%s supports at most %d elements; use --dist=local\n", dist_names[dist], INT_MAX);
+        MPI_Finalize();
+        return 1;
+    }
     if (argc >= 3) {
         num_runs = atoi(argv[2]);
     }
+    // The whole run goes through `bench`; the setup and each run's phases are timed per rank.
+    // With --sum=repro the fast path is timed in every run too, into `fast` and fast_phases.
+    phase_timer_t setup_phases, run_phases, fast_phases;
+    bench_t fast;
+    bench_defaults(&fast);
+    fast.warmup = bench.warmup;
+    repro_acc_t *accs = (repro_acc_t*) malloc(threads * sizeof(repro_acc_t));
+    if (phase_timer_init(&setup_phases, 0, 1) != 0 || phase_timer_init(&run_phases, bench.warmup, num_runs) != 0 ||
+        phase_timer_init(&fast_phases, bench.warmup, num_runs) != 0 || !accs ||
+        bench_start(&bench, num_runs) != 0 || bench_start(&fast, num_runs) != 0) {
+        perror("Memory allocation failed");
+        exit(EXIT_FAILURE);
+    }
     
-    // Prepare counts and displacements for scattering the vectors.
+    // Elements per process; counts and displacements are only used by the scatter modes.
+    // With --sum=repro every slice is a run of whole blocks.
+    long base = global_n / size;
+    long rem = global_n % size;
     int *sendcounts = (int*) malloc(size * sizeof(int));
     int *displs = (int*) malloc(size * sizeof(int));
-    int base = global_n / size;
-    int rem = global_n % size;
+    long local_n = 0, local_first = 0;  // This process's slice is [local_first, local_first + local_n).
+    long first = 0;
     for (int i = 0; i < size; i++) {
-        sendcounts[i] = base + (i < rem ? 1 : 0);
+        long start, end;
+        repro_range(global_n, i, size, &start, &end);
+        long count = repro ? end - start : base + (i < rem ? 1 : 0);
+        sendcounts[i] = (int) count;
+        if (i == rank) {
+            local_n = count;
+            local_first = first;
+        }
+        first += count;
     }
     displs[0] = 0;
     for (int i = 1; i < size; i++) {
         displs[i] = displs[i-1] + sendcounts[i-1];
     }
     
-    int local_n = sendcounts[rank];
     local_A = (double*) malloc(local_n * sizeof(double));
     local_B = (double*) malloc(local_n * sizeof(double));
+    if (!local_A || !local_B) {
+        perror("Memory allocation failed");
+        exit(EXIT_FAILURE);
+    }
+    if (dist != DIST_LOCAL) {
+        // Place the receive buffers' pages with the threads that read them before the scatter fills them.
+        fill_parallel(local_A, local_n, 0.0);
+        fill_parallel(local_B, local_n, 0.0);
+    }
     
-    // Process 0 initializes full vectors A and B.
-    if (rank == 0) {
+    if (dist != DIST_LOCAL && rank == 0) {
+        // Process 0 generates the full vectors A and B.
         A = (double*) malloc(global_n * sizeof(double));
         B = (double*) malloc(global_n * sizeof(double));
-        for (int i = 0; i < global_n; i++) {
-            A[i] = 1.0;
-            B[i] = 1.0;
+        if (!A || !B) {
+            perror("Memory allocation failed");
+            exit(EXIT_FAILURE);
+        }
+        generate_parallel(&input, INPUT_A, 0, A, global_n);
+        generate_parallel(&input, INPUT_B, 0, B, global_n);
+        if (low && dist == DIST_RESCATTER) {
+            // The runs scatter the packed vectors.
+            A_low = malloc(global_n * dtype_bytes(mixed.storage));
+            B_low = malloc(global_n * dtype_bytes(mixed.storage));
+            if (!A_low || !B_low) {
+                perror("Memory allocation failed");
+                exit(EXIT_FAILURE);
+            }
+            pack_parallel(&mixed, A, A_low, global_n);
+            pack_parallel(&mixed, B, B_low, global_n);
+        }
+    }
+    if (low) {
+        local_A_low = malloc(local_n * dtype_bytes(mixed.storage));
+        local_B_low = malloc(local_n * dtype_bytes(mixed.storage));
+        if (!local_A_low || !local_B_low) {
+            perror("Memory allocation failed");
+            exit(EXIT_FAILURE);
         }
     }
     
-    // Repeat runs to compute average time.
-    for (int run = 0; run < num_runs; run++) {
-        // Scatter the vectors to all processes.
+    // Distribute once: every process generates its own slice, or process 0 scatters the vectors.
+    int setup_phase = phase_define(&setup_phases, dist == DIST_LOCAL ? "generate" : "scatter");
+    MPI_Barrier(MPI_COMM_WORLD);
+    phase_begin(&setup_phases);
+    if (dist == DIST_LOCAL) {
+        generate_parallel(&input, INPUT_A, local_first, local_A, local_n);
+        generate_parallel(&input, INPUT_B, local_first, local_B, local_n);
+    } else {
         MPI_Scatterv(A, sendcounts, displs, MPI_DOUBLE,
-                     local_A, local_n, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+                     local_A, (int) local_n, MPI_DOUBLE, 0, MPI_COMM_WORLD);
         MPI_Scatterv(B, sendcounts, displs, MPI_DOUBLE,
-                     local_B, local_n, MPI_DOUBLE, 0, MPI_COMM_WORLD);
-        
-        local_dot = 0.0;
-        MPI_Barrier(MPI_COMM_WORLD);
-        start_time = MPI_Wtime();
-        
-        // Each process computes its local dot product.
-        for (int i = 0; i < local_n; i++) {
-            local_dot += local_A[i] * local_B[i];
-        }
-        
-        end_time = MPI_Wtime();
-        double elapsed = end_time - start_time;
-        total_time += elapsed;
-        
-        // Reduce local dot products to get the global dot product on process 0.
-        MPI_Reduce(&local_dot, &global_dot, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
-        
-        if (rank == 0) {
-            // For verification: Since all elements are 1.0, the dot product should equal global_n.
-            if (global_dot != global_n * 1.0) {
-                printf("Run %d: Error! Parallel dot product = %f, Expected = %d\n", run+1, global_dot, global_n);
+                     local_B, (int) local_n, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    }
+    phase_end(&setup_phases, setup_phase);
+    if (low) {
+        int pack_phase = phase_define(&setup_phases, "pack");
+        phase_begin(&setup_phases);
+        pack_parallel(&mixed, local_A, local_A_low, local_n);
+        pack_parallel(&mixed, local_B, local_B_low, local_n);
+        phase_end(&setup_phases, pack_phase);
+    }
+    phase_run_done(&setup_phases);
+    
+    // The data never changes, so the reference is built once from the resident slices.
+    // It is needed wherever the result lands: process 0, or every rank with the allreduce variants.
+    int has_result = (coll == COLL_REDUCE) ? (rank == 0) : 1;
+    verify_ref_t ref = {0};  // Global reference, valid where has_result.
+    if (verify) {
+        verify_ref_t local_ref;
+        dot_reference(local_A, local_B, local_n, &local_ref);
+        double local_parts[3] = { local_ref.value.sum, local_ref.value.comp, local_ref.magnitude };
+        double parts[3];
+        if (coll == COLL_REDUCE)
+            MPI_Reduce(local_parts, parts, 3, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+        else
+            MPI_Allreduce(local_parts, parts, 3, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+        ref.value.sum = parts[0];
+        ref.value.comp = parts[1];
+        ref.magnitude = parts[2];
+        ref.n = global_n;
+    }
+    
+    int scatter_phase = -1, compute_phase = -1, reduce_phase = -1;
+    for (int t = 0; t < 2; t++) {
+        phase_timer_t *timer = (t == 0) ? &run_phases : &fast_phases;
+        scatter_phase = (dist == DIST_RESCATTER) ? phase_define(timer, "scatter") : -1;
+        compute_phase = phase_define(timer, "compute");
+        reduce_phase = phase_define(timer, "reduce");
+    }
+    double first_repro = 0.0;  // The reproducible result of the first run; every later run must match it.
+    double error_relative = 0.0, error_scaled = 0.0;  // Of the last checked result.
+    
+    // Repeat runs to compute average time.
+    for (int run = 0; run < bench_total_runs(&bench); run++) {
+        // Pass 0 is the timed mode; with --sum=repro, pass 1 times the fast path on the same data.
+        for (int pass = 0; pass < (repro ? 2 : 1); pass++) {
+            int use_repro = repro && pass == 0;
+            phase_timer_t *timer = (pass == 0) ? &run_phases : &fast_phases;
+            MPI_Barrier(MPI_COMM_WORLD);
+            uint64_t start_ns = bench_now_ns();
+            
+            if (dist == DIST_RESCATTER) {
+                // Scatter the vectors to all processes again (the packed ones with a narrower --dtype).
+                phase_begin(timer);
+                if (low) {
+                    MPI_Datatype type = storage_type(mixed.storage);
+                    MPI_Scatterv(A_low, sendcounts, displs, type, local_A_low, (int) local_n, type, 0, MPI_COMM_WORLD);
+                    MPI_Scatterv(B_low, sendcounts, displs, type, local_B_low, (int) local_n, type, 0, MPI_COMM_WORLD);
+                } else {
+                    MPI_Scatterv(A, sendcounts, displs, MPI_DOUBLE,
+                                 local_A, (int) local_n, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+                    MPI_Scatterv(B, sendcounts, displs, MPI_DOUBLE,
+                                 local_B, (int) local_n, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+                }
+                phase_end(timer, scatter_phase);
+            }
+            
+            if (use_repro) {
+                // Each process adds its blocks exactly, then the accumulators' digits are summed.
+                repro_acc_t local, total;
+                phase_begin(timer);
+                local_repro(dot_kernel, local_A, local_B, local_n, accs, &local);
+                phase_end(timer, compute_phase);
+                
+                phase_begin(timer);
+                combine(coll, local.digit, total.digit, REPRO_DIGITS, MPI_INT64_T);
+                total.pending = size;
+                global_dot = has_result ? repro_result(&total) : 0.0;
+                phase_end(timer, reduce_phase);
+            } else {
+                // Each process computes its local dot product.
+                phase_begin(timer);
+                local_dot = parallel_dot(dot_kernel, &mixed, local_A, local_B, local_A_low, local_B_low, local_n);
+                phase_end(timer, compute_phase);
+                
+                // Combine the local dot products on process 0, or on every rank.
+                phase_begin(timer);
+                combine(coll, &local_dot, &global_dot, 1, MPI_DOUBLE);
+                phase_end(timer, reduce_phase);
+            }
+            phase_run_done(timer);
+            
+            // A run takes as long as its slowest rank.
+            uint64_t elapsed_ns = bench_now_ns() - start_ns, max_ns;
+            MPI_Reduce(&elapsed_ns, &max_ns, 1, MPI_UINT64_T, MPI_MAX, 0, MPI_COMM_WORLD);
+            if (rank == 0) {
+                bench_record(pass == 0 ? &bench : &fast, max_ns);
+            }
+            
+            double u_store = mixed_store_error(&mixed), u_sum = mixed_sum_error(&mixed);
+            if (verify && has_result && !verify_check_mixed(global_dot, &ref, u_store, u_sum)) {
+                printf("Run %d, process %d: Error! Parallel dot product = %.17g, Reference = %.17g (%.1f ulp, tolerance %.3g)\n",
+                       run+1, rank, global_dot, verify_ref_value(&ref), verify_ulp_error(global_dot, verify_ref_value(&ref)),
+                       verify_tolerance_mixed(&ref, u_store, u_sum));
+            }
+            if (verify && has_result) {
+                error_relative = fabs(global_dot - verify_ref_value(&ref)) / fabs(verify_ref_value(&ref));
+                error_scaled = verify_scaled_error(global_dot, &ref);
+            }
+            if (use_repro && has_result) {
+                if (run == 0) {
+                    first_repro = global_dot;
+                } else if (global_dot != first_repro) {
+                    printf("Run %d, process %d: Error! Reproducible sum %.17g differs from run 1's %.17g\n", run+1, rank,
+                           global_dot, first_repro);
+                }
             }
         }
     }
     
     if (rank == 0) {
-        double avg_time = total_time / num_runs;
         printf("MPI Dot Product Performance\n");
-        printf("Processes: %d, Global Vector Size: %d, Runs: %d\n", size, global_n, num_runs);
-        printf("Average Time (seconds): %f\n", avg_time);
+        const char *kernel_name = low ? mixed.isa : dot_kernel_name(kernel);
+        printf("Processes: %d, Threads per process: %d, Global Vector Size: %ld, Runs: %d, Kernel: %s, Distribution: %s\n", size, threads, global_n, num_runs,
+               kernel_name, dist_names[dist]);
+        printf("Reduction: %s\n", coll_names[coll]);
+        if (low) {
+            printf("Precision: %s storage, %s accumulation, %zu bytes per element\n", dtype_name(mixed.storage),
+                   dtype_name(mixed.accum), dtype_bytes(mixed.storage));
+            if (verify) {
+                printf("Error vs fp64 reference: %.3g relative, %.3g of sum|a*b|\n", error_relative, error_scaled);
+            }
+        }
+        printf("Input: %s (seed %llu)\n", input_name(&input), (unsigned long long) input.seed);
+        if (repro) {
+            printf("Sum: repro (blocks of %d), result %.17g\n", REPRO_BLOCK, first_repro);
+        }
+        char config[128];
+        snprintf(config, sizeof(config), "dist=%s reduce=%s sum=%s init=%s dtype=%s", dist_names[dist], coll_names[coll],
+                 repro ? "repro" : "fast", input_name(&input), precision);
+        bench_info_t info = { .program = "mpi_dot_product", .scaling = scaling, .kernel = kernel_name,
+                              .config = config,
+                              .threads = threads, .procs = size, .m = 1, .n = global_n, .k = 1,
+                              .flops = 2.0 * global_n, .bytes = 2.0 * global_n * dtype_bytes(mixed.storage) };
+        bench_report(&bench, &info);
+        if (repro) {
+            bench_compare(&bench, &fast, "Reproducible sum vs fast path");
+        }
+    }
+    phase_report(&setup_phases, "Setup", MPI_COMM_WORLD);
+    phase_report(&run_phases, "Run phases", MPI_COMM_WORLD);
+    if (repro) {
+        phase_report(&fast_phases, "Run phases, fast path", MPI_COMM_WORLD);
     }
+    bench_finish(&bench);
+    bench_finish(&fast);
+    phase_timer_free(&setup_phases);
+    phase_timer_free(&run_phases);
+    phase_timer_free(&fast_phases);
+    free(accs);
     
     free(local_A);
     free(local_B);
+    free(local_A_low);
+    free(local_B_low);
     free(sendcounts);
     free(displs);
     if (rank == 0) {
         free(A);
         free(B);
+        free(A_low);
+        free(B_low);
     }
     
     MPI_Finalize();
@@ -5,41 +5,488 @@
 //
 // Description:
 //   This MPI program performs matrix-vector multiplication.
-//   Process 0 initializes a global matrix A (stored in flattened row-major form)
-//   and a vector B. The matrix is distributed row-wise among all processes using MPI_Scatterv.
+//   The matrix A is distributed row-wise among all processes. With --dist=local (default) every
+//   process generates its own block of rows and its own copy of B, so no process ever holds the
+//   global matrix and setup is parallel. The data comes from the seeded generators in input.h
+//   (--init=ones|uniform|normal|ill|sparse, --seed=S; uniform by default): an element depends only
+//   on its global row and column, so every distribution and decomposition multiplies the same
+//   matrix and vectors. With --dist=scatter, process 0 generates the global
+//   matrix A (stored in flattened row-major form) and a vector B, scatters the rows with
+//   MPI_Scatterv and broadcasts B, as the original program did. --dist=rescatter scatters the rows
+//   again in every run, so the timed run pays the O(M*N) distribution in sequence before computing.
+//   --dist=pipeline distributes the rows in every run too, but in chunks of --chunk=R rows per rank:
+//   chunk c arrives by MPI_Iscatterv while up to PIPELINE_DEPTH - 1 later chunks are in flight, is
+//   computed as soon as it lands, and its rows of P go back by MPI_Igatherv while later chunks
+//   compute. Without an asynchronous progress thread MPI moves the data only inside MPI calls, so
+//   the overlap comes from the transfers progressing during each MPI_Wait.
 //   Each process computes its portion of the product, and the local results are gathered
-//   using MPI_Gatherv into the global result vector P.
+//   using MPI_Gatherv into the global result vector P. Counts are sent in whole rows through
+//   derived datatypes and sizes are computed in 64 bits, so global_M * N may exceed INT_MAX.
 //   For weak scaling, the global number of rows is base_M multiplied by the number of processes;
-//   for strong scaling, the global matrix rows equal base_M. The parallel portion is timed
-//   using MPI_Wtime() over several runs, and the average time is printed along with a correctness check.
+//   for strong scaling, the global matrix rows equal base_M. Each run (any per-run distribution,
+//   compute and the gather of P) is timed on every rank with the shared harness (see bench.h); the slowest rank's time counts.
+//   Warm-up runs are dropped, and min/median/p90/max/stddev, GFLOP/s and GB/s are printed along with
+//   a correctness check, optionally as JSON/CSV records. The setup phases (generate, or init, scatter
+//   and broadcast) and each run's phases (scatter, compute, gather; compute and wait when pipelined)
+//   are also timed per rank and reported as max/min/mean/imbalance across ranks (see phase_timer.h).
+//   With --batch=K, B is an N x K block of vectors (row-major) and every rank multiplies its rows
+//   by all K vectors in one cache-blocked pass (gemv_batched), so A is read once per K vectors.
+//   Each rank checks its own rows against a compensated reference with an n-scaled tolerance
+//   (see verify.h) outside the timed region, and the mismatch counts are summed on process 0.
+//   --no-verify skips it.
+//   --decomp=2d arranges the processes in a grid_rows x grid_cols grid (MPI_Cart_create; --grid=RxC,
+//   or MPI_Dims_create's choice) and deals both the rows and the columns of A out block-cyclically
+//   in --block=NB blocks (ScaLAPACK's layout). Each rank then holds only the pieces of B for its
+//   columns, which process row 0 broadcasts down each column communicator in setup, so a rank
+//   receives and stores N / grid_cols entries of B instead of N. Every run, each rank multiplies its
+//   block, the partial sums are reduced along the row communicator to process column 0 (M / grid_rows
+//   entries per rank), and process column 0 gathers them onto process 0, which puts the rows back in
+//   global order. The grid needs --dist=local; the references for the check are reduced the same way.
+//   Hybrid mode: --threads=T runs T OpenMP threads inside every rank (MPI_THREAD_FUNNELED; all MPI
+//   calls are made outside the parallel regions). Each thread takes a contiguous share of the rows
+//   being computed and first-touches the same share of the local block, so one rank per socket or
+//   node replaces T ranks and their copies of B. Launch ranks-per-node x T = cores per node.
+//   --shared-b keeps one copy of B per node instead of one per rank: the ranks of a node
+//   (MPI_Comm_split_type with MPI_COMM_TYPE_SHARED) map a window allocated by the node's first rank
+//   with MPI_Win_allocate_shared. Only those node leaders take part in the broadcast of B (over a
+//   communicator of leaders), and a fence on the window makes their writes visible to the node.
+//   The 1-D decomposition only.
+//   --matrix=FILE multiplies a matrix stored in the binary format of matfile.h: every rank maps only
+//   the pages holding its own rows (mmap at the row block's file offset), zero-copy, and the
+//   dimensions come from the file (the positional M and N are ignored). --vector=FILE reads B from
+//   an N x K file of the same format (K = its columns). --stream=R multiplies the mapped rows out of
+//   core in panels of R rows, with readahead on the next panel and each finished panel dropped from
+//   memory and the page cache, so a rank's rows may exceed its memory and every run reads storage.
+//   --read=mpiio loads the rows instead: all ranks open the file together and each reads its row
+//   block with one collective MPI_File_read_at_all through a subarray file view, so the MPI-IO layer
+//   can aggregate the requests into large contiguous reads and no data goes through process 0.
+//   The read is timed as a setup phase and its aggregate bandwidth (matrix bytes over the slowest
+//   rank's read time) is printed with the run timings.
+//   Matrix files need --dist=local and the 1-D decomposition.
+//   --layout=csr|sell multiplies a generated sparse matrix instead (see sparse.h: --sparse=banded:W|
+//   powerlaw:D, --sigma=S, --balance=nnz|rows). Every rank generates its rows in CSR, its threads
+//   split them by nonzeros, and B is not broadcast: each rank generates an even block of B and
+//   before every multiply fetches only the entries its columns touch from their owners, over a
+//   neighbourhood collective on a graph of the ranks that share columns (--halo=neighbor, default),
+//   or assembles all of B with MPI_Allgatherv (--halo=allgather) for comparison. The exchange is
+//   timed as its own run phase. Sparse layouts need --dist=local, the 1-D decomposition and
+//   --batch=1, without --shared-b or matrix files.
+//   --dtype=fp32|bf16|fp16 (and --accum=fp64|fp32) multiplies copies of the local rows and of B
+//   rounded to a narrower format, with the tiled kernels of mixed.h instead of the fp64 loop. Each
+//   rank packs its generated rows in a setup phase and keeps the fp64 data for the check, and the
+//   largest row error and the 2-norm error against the fp64 reference are printed. It needs the
+//   same setting as the sparse layouts, with a dense matrix.
 //
 // Usage:
-//   mpicc mpi_matrix_vector.c -o mpi_matrix_vector
-//   mpirun -np <num_processes> ./mpi_matrix_vector <base_M> <base_N> <strong|weak> [num_runs]
+//   mpicc -O2 -fopenmp mpi_matrix_vector.c gemv_kernels.c matrix.c dot_kernels.c bench.c verify.c phase_timer.c input.c matfile.c sparse.c halo.c mixed.c -o mpi_matrix_vector -lm
+//   mpirun -np <num_processes> ./mpi_matrix_vector <base_M> <base_N> <strong|weak> [num_runs] [--batch=K]
+//          [--dist=local|scatter|rescatter|pipeline] [--chunk=R] [--decomp=1d|2d] [--grid=RxC] [--block=NB]
+//          [--threads=T] [--shared-b] [--init=ones|uniform|normal|ill|sparse] [--seed=S]
+//          [--dtype=fp64|fp32|bf16|fp16] [--accum=fp64|fp32] [--matrix=FILE] [--read=mmap|mpiio] [--vector=FILE] [--stream=R]
+//          [--layout=flat|csr|sell] [--sparse=banded:W|powerlaw:D] [--sigma=S] [--balance=nnz|rows]
+//          [--halo=neighbor|allgather]
+//          [--warmup=N] [--format=text|json|csv] [--output=FILE] [--no-verify]
 #include <mpi.h>
+#include <limits.h>
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <omp.h>
+#include "gemv_kernels.h"
+#include "bench.h"
+#include "verify.h"
+#include "phase_timer.h"
+#include "input.h"
+#include "matfile.h"
+#include "sparse.h"
+#include "halo.h"
+#include "mixed.h"
+
+// Chunks of rows in flight at once in --dist=pipeline (the one being computed included).
+#define PIPELINE_DEPTH 4
+
+typedef enum { DIST_LOCAL, DIST_SCATTER, DIST_RESCATTER, DIST_PIPELINE } dist_mode_t;
+
+static const char *dist_names[] = { "local", "scatter", "rescatter", "pipeline" };
+
+// How --matrix gets the rows: mapped in place, or read into memory with collective MPI-IO.
+typedef enum { READ_MMAP, READ_MPIIO } read_mode_t;
+
+static const char *read_names[] = { "mmap", "mpiio" };
+
+// How A is stored: dense rows, or a generated sparse matrix.
+typedef enum { LAYOUT_FLAT, LAYOUT_CSR, LAYOUT_SELL } layout_t;
+
+static const char *layout_names[] = { "flat", "csr", "sell" };
+
+static const char *halo_names[] = { "neighbor", "allgather" };
+
+// Number of the n indices that process iproc of nprocs owns when they are dealt out in blocks of nb.
+static long block_cyclic_count(long n, int nb, int iproc, int nprocs) {
+    long blocks = n / nb;
+    long count = blocks / nprocs * nb;
+    long extra = blocks % nprocs;
+    if (iproc < extra)
+        count += nb;
+    else if (iproc == extra)
+        count += n % nb;
+    return count;
+}
+
+// Global index of local index `local` on process iproc of nprocs (blocks of nb).
+static long block_cyclic_global(long local, int nb, int iproc, int nprocs) {
+    return (local / nb * nprocs + iproc) * nb + local % nb;
+}
+
+// Set the local block to value, each thread writing the rows compute_rows gives it for the whole block.
+static void fill_rows(const Matrix *A, double value) {
+#pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        int nthreads = omp_get_num_threads();
+        int chunk = A->rows / nthreads;
+        int remainder = A->rows % nthreads;
+        int start = tid * chunk + (tid < remainder ? tid : remainder);
+        int end = start + chunk + (tid < remainder ? 1 : 0);
+        for (long i = (long) start * A->ld; i < (long) end * A->ld; i++) {
+            A->data[i] = value;
+        }
+    }
+}
+
+// Generate the block A, each thread the rows compute_rows gives it. Local row i is global row
+// row_global[i] and local column j global column col_global[j]; a NULL map means local == global.
+static void generate_rows(const Matrix *A, const input_t *input, const long *row_global, const long *col_global) {
+#pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        int nthreads = omp_get_num_threads();
+        int chunk = A->rows / nthreads;
+        int remainder = A->rows % nthreads;
+        int start = tid * chunk + (tid < remainder ? tid : remainder);
+        int end = start + chunk + (tid < remainder ? 1 : 0);
+        for (int i = start; i < end; i++) {
+            long row = row_global ? row_global[i] : i;
+            double *out = A->data + i * A->ld;
+            if (col_global) {
+                for (int j = 0; j < A->cols; j++) {
+                    out[j] = input_value(input, INPUT_A, row, col_global[j]);
+                }
+            } else {
+                input_fill(input, INPUT_A, row, 0, out, 1, A->cols);
+            }
+        }
+    }
+}
+
+// Generate the entries of B for `cols` columns of A (cols x K, row-major; vector k is stream
+// INPUT_B, row k), or copy them from the mapped N x K vector file when it is not NULL.
+// Local column j is global column col_global[j], or j when col_global is NULL.
+static void generate_b(double *B, int cols, int K, const input_t *input, const matfile_t *vector,
+                       const long *col_global) {
+#pragma omp parallel for schedule(static)
+    for (int j = 0; j < cols; j++) {
+        long global = col_global ? col_global[j] : j;
+        for (int k = 0; k < K; k++) {
+            B[(long) j * K + k] = vector ? matfile_row(vector, global)[k] : input_value(input, INPUT_B, k, global);
+        }
+    }
+}
+
+// Rows of part t of a sparse partition: its rows, or with SELL (scale SELL_C) the rows of its slices.
+static void part_rows(const int *bounds, int t, int scale, int rows, int *row_begin, int *row_end) {
+    *row_begin = (bounds[t] * scale < rows) ? bounds[t] * scale : rows;
+    *row_end = (bounds[t + 1] * scale < rows) ? bounds[t + 1] * scale : rows;
+}
+
+// y = A x over every part of the partition (S is NULL for CSR), each thread taking whole parts.
+static void spmv_parts(const csr_t *A, const sell_t *S, const int *bounds, int parts, const double *x, double *y) {
+#pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        int nthreads = omp_get_num_threads();
+        for (int t = tid; t < parts; t += nthreads) {
+            if (S) {
+                sell_spmv(S, x, y, bounds[t], bounds[t + 1]);
+            } else {
+                csr_spmv(A, x, y, bounds[t], bounds[t + 1]);
+            }
+        }
+    }
+}
+
+// Read global rows [first, first + rows) of a matrix file into A (rows x cols, unpadded) with one
+// collective read; every rank of MPI_COMM_WORLD must call it. a_row is a row of cols doubles.
+// Returns 0, or -1 after printing the MPI error.
+static int read_rows(const char *path, const matfile_header_t *h, int first, int rows, double *A,
+                     MPI_Datatype a_row) {
+    MPI_File fh;
+    int rc = MPI_File_open(MPI_COMM_WORLD, path, MPI_MODE_RDONLY, MPI_INFO_NULL, &fh);
+    if (rc == MPI_SUCCESS) {
+        // The view starts at row 0 and skips to this rank's rows and columns; a rank with no rows
+        // still takes part in the collective with a plain view.
+        MPI_Datatype filetype = MPI_DOUBLE;
+        if (rows > 0) {
+            int sizes[2] = { (int) h->rows, (int) h->ld };
+            int subsizes[2] = { rows, (int) h->cols };
+            int starts[2] = { first, 0 };
+            MPI_Type_create_subarray(2, sizes, subsizes, starts, MPI_ORDER_C, MPI_DOUBLE, &filetype);
+            MPI_Type_commit(&filetype);
+        }
+        rc = MPI_File_set_view(fh, (MPI_Offset) h->data_offset, MPI_DOUBLE, filetype, "native", MPI_INFO_NULL);
+        if (rc == MPI_SUCCESS) {
+            rc = MPI_File_read_at_all(fh, 0, A, rows, a_row, MPI_STATUS_IGNORE);
+        }
+        if (rows > 0) {
+            MPI_Type_free(&filetype);
+        }
+        MPI_File_close(&fh);
+    }
+    if (rc != MPI_SUCCESS) {
+        char message[MPI_MAX_ERROR_STRING];
+        int length;
+        MPI_Error_string(rc, message, &length);
+        fprintf(stderr, "%s: %s\n", path, message);
+        return -1;
+    }
+    return 0;
+}
+
+// Multiply rows [row_begin, row_end) of the local block by the K vectors in B, one contiguous
+// share of the rows per thread.
+static void compute_rows(const Matrix *A, const double *B, int K, double *P, int row_begin, int row_end,
+                         const gemv_plan_t *plan) {
+#pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        int nthreads = omp_get_num_threads();
+        int chunk = (row_end - row_begin) / nthreads;
+        int remainder = (row_end - row_begin) % nthreads;
+        int start = row_begin + tid * chunk + (tid < remainder ? tid : remainder);
+        int end = start + chunk + (tid < remainder ? 1 : 0);
+        if (K == 1) {
+            for (int i = start; i < end; i++) {
+                double sum = 0.0;
+                for (int j = 0; j < A->cols; j++) {
+                    sum += A->data[i * A->ld + j] * B[j];
+                }
+                P[i] = sum;
+            }
+        } else {
+            gemv_batched(A, B, K, P, start, end, plan);
+        }
+    }
+}
+
+// Round each thread's compute_rows share of the local block into A_low (format of m, same ld).
+static void pack_rows(const mixed_t *m, const Matrix *A, void *A_low) {
+#pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        int nthreads = omp_get_num_threads();
+        int chunk = A->rows / nthreads;
+        int remainder = A->rows % nthreads;
+        int start = tid * chunk + (tid < remainder ? tid : remainder);
+        int end = start + chunk + (tid < remainder ? 1 : 0);
+        for (int i = start; i < end; i++) {
+            mixed_pack(m->storage, A->data + (long) i * A->ld, mixed_at(m->storage, A_low, (long) i * A->ld), A->cols);
+        }
+    }
+}
+
+// compute_rows for the packed block and vector of a narrower --dtype (one vector).
+static void compute_rows_mixed(const mixed_t *m, const Matrix *A, const void *A_low, const void *B_low, double *P,
+                               int row_begin, int row_end, const gemv_plan_t *plan) {
+#pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        int nthreads = omp_get_num_threads();
+        int chunk = (row_end - row_begin) / nthreads;
+        int remainder = (row_end - row_begin) % nthreads;
+        int start = row_begin + tid * chunk + (tid < remainder ? tid : remainder);
+        int end = start + chunk + (tid < remainder ? 1 : 0);
+        mixed_gemv(m, A_low, A->ld, A->cols, B_low, P, start, end, plan);
+    }
+}
 
 int main(int argc, char* argv[]) {
     int rank, size;
     int base_M, N, num_runs = 5;
     char scaling_mode[10];
-    int global_M; // Total number of rows.
+    long global_M; // Total number of rows.
     double *global_A_flat = NULL; // Flattened global matrix (only on root)
     double *B = NULL;  // Global vector B (on root, then broadcast)
     double *P = NULL;  // Global result vector (on root)
-    double *local_A;   // Local portion of the matrix (flattened)
+    double *local_A = NULL;  // Local portion of the matrix (flattened)
     double *local_P;   // Local result for matrix-vector multiplication
-    double start_time, end_time, total_time = 0.0;
+    void *local_A_low = NULL, *B_low = NULL;  // Packed copies of local_A and B for a narrower --dtype.
     
-    MPI_Init(&argc, &argv);
+    // Only the main thread calls MPI; the OpenMP regions contain none.
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
     MPI_Comm_size(MPI_COMM_WORLD, &size);
     
+    int K = 1;  // Number of vectors multiplied per run.
+    int verify = 1;
+    dist_mode_t dist = DIST_LOCAL;
+    int chunk = 256;  // Rows per rank per pipeline chunk.
+    int grid2d = 0;   // --decomp=1d
+    int dims[2] = { 0, 0 };  // Process grid rows and columns (0: chosen by MPI_Dims_create).
+    int block = 64;   // Block size of the 2-D block-cyclic layout.
+    int threads = 1;  // OpenMP threads per rank.
+    int shared_b = 0; // One copy of B per node in a shared-memory window.
+    const char *matrix_path = NULL, *vector_path = NULL;  // --matrix, --vector
+    read_mode_t read_mode = READ_MMAP;  // --read
+    int stream_rows = 0;  // --stream: rows per panel, 0 when the mapping is used in place.
+    layout_t layout = LAYOUT_FLAT;
+    halo_mode_t halo_mode = HALO_NEIGHBOR;
+    sparse_opts_t sparse;
+    sparse_defaults(&sparse);
+    bench_t bench;
+    bench_defaults(&bench);
+    input_t input;
+    input_defaults(&input);
+    mixed_t mixed;
+    mixed_defaults(&mixed);
+    // Pull --option=value flags out of argv so the positional arguments keep their places.
+    int nargs = 1, rc;
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--batch=", 8) == 0) {
+            K = atoi(argv[i] + 8);
+            if (K < 1) {
+                if (rank == 0)
+                    printf("Batch size must be at least 1\n");
+                MPI_Finalize();
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--dist=", 7) == 0) {
+            if (strcmp(argv[i] + 7, "local") == 0) {
+                dist = DIST_LOCAL;
+            } else if (strcmp(argv[i] + 7, "scatter") == 0) {
+                dist = DIST_SCATTER;
+            } else if (strcmp(argv[i] + 7, "rescatter") == 0) {
+                dist = DIST_RESCATTER;
+            } else if (strcmp(argv[i] + 7, "pipeline") == 0) {
+                dist = DIST_PIPELINE;
+            } else {
+                if (rank == 0)
+                    printf("Unknown distribution: %s\n", argv[i] + 7);
+                MPI_Finalize();
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--chunk=", 8) == 0) {
+            chunk = atoi(argv[i] + 8);
+            if (chunk < 1) {
+                if (rank == 0)
+                    printf("Chunk size must be at least 1 row\n");
+                MPI_Finalize();
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--decomp=", 9) == 0) {
+            if (strcmp(argv[i] + 9, "1d") == 0) {
+                grid2d = 0;
+            } else if (strcmp(argv[i] + 9, "2d") == 0) {
+                grid2d = 1;
+            } else {
+                if (rank == 0)
+                    printf("Unknown decomposition: %s\n", argv[i] + 9);
+                MPI_Finalize();
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--grid=", 7) == 0) {
+            if (sscanf(argv[i] + 7, "%dx%d", &dims[0], &dims[1]) != 2 || dims[0] < 1 || dims[1] < 1 ||
+                dims[0] * dims[1] != size) {
+                if (rank == 0)
+                    printf("Grid must be RxC with R * C = %d processes\n", size);
+                MPI_Finalize();
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--block=", 8) == 0) {
+            block = atoi(argv[i] + 8);
+            if (block < 1) {
+                if (rank == 0)
+                    printf("Block size must be at least 1\n");
+                MPI_Finalize();
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--threads=", 10) == 0) {
+            threads = atoi(argv[i] + 10);
+            if (threads < 1) {
+                if (rank == 0)
+                    printf("Thread count must be at least 1\n");
+                MPI_Finalize();
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--shared-b") == 0) {
+            shared_b = 1;
+        } else if (strncmp(argv[i], "--matrix=", 9) == 0) {
+            matrix_path = argv[i] + 9;
+        } else if (strncmp(argv[i], "--read=", 7) == 0) {
+            if (strcmp(argv[i] + 7, "mmap") == 0) {
+                read_mode = READ_MMAP;
+            } else if (strcmp(argv[i] + 7, "mpiio") == 0) {
+                read_mode = READ_MPIIO;
+            } else {
+                if (rank == 0)
+                    printf("Unknown read mode: %s\n", argv[i] + 7);
+                MPI_Finalize();
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--vector=", 9) == 0) {
+            vector_path = argv[i] + 9;
+        } else if (strncmp(argv[i], "--stream=", 9) == 0) {
+            stream_rows = atoi(argv[i] + 9);
+            if (stream_rows < 1) {
+                if (rank == 0)
+                    printf("Panel size must be at least 1 row\n");
+                MPI_Finalize();
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--layout=", 9) == 0) {
+            if (strcmp(argv[i] + 9, "flat") == 0) {
+                layout = LAYOUT_FLAT;
+            } else if (strcmp(argv[i] + 9, "csr") == 0) {
+                layout = LAYOUT_CSR;
+            } else if (strcmp(argv[i] + 9, "sell") == 0) {
+                layout = LAYOUT_SELL;
+            } else {
+                if (rank == 0)
+                    printf("Unknown layout: %s\n", argv[i] + 9);
+                MPI_Finalize();
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--halo=", 7) == 0) {
+            if (strcmp(argv[i] + 7, "neighbor") == 0) {
+                halo_mode = HALO_NEIGHBOR;
+            } else if (strcmp(argv[i] + 7, "allgather") == 0) {
+                halo_mode = HALO_ALLGATHER;
+            } else {
+                if (rank == 0)
+                    printf("Unknown halo mode: %s\n", argv[i] + 7);
+                MPI_Finalize();
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--no-verify") == 0) {
+            verify = 0;
+        } else if ((rc = bench_parse_arg(&bench, argv[i])) != 0 || (rc = input_parse_arg(&input, argv[i])) != 0 ||
+                   (rc = sparse_parse_arg(&sparse, argv[i])) != 0 || (rc = mixed_parse_arg(&mixed, argv[i])) != 0) {
+            if (rc < 0) {
+                if (rank == 0)
+                    printf("Invalid option: %s\n", argv[i]);
+                MPI_Finalize();
+                return 1;
+            }
+        } else {
+            argv[nargs++] = argv[i];
+        }
+    }
+    argc = nargs;
+    
     if (argc < 4) {
         if (rank == 0)
-            printf("Usage: %s <base_M> <base_N> <strong|weak> [num_runs]\n", argv[0]);
+            printf("Usage: %s <base_M> <base_N> <strong|weak> [num_runs] [--batch=K] [--dist=local|scatter|rescatter|pipeline] [--chunk=R] [--decomp=1d|2d] [--grid=RxC] [--block=NB] [--threads=T] [--shared-b] [--init=ones|uniform|normal|ill|sparse] [--seed=S] [--dtype=fp64|fp32|bf16|fp16] [--accum=fp64|fp32] [--matrix=FILE] [--read=mmap|mpiio] [--vector=FILE] [--stream=R] [--layout=flat|csr|sell] [--sparse=banded:W|powerlaw:D] [--sigma=S] [--balance=nnz|rows] [--halo=neighbor|allgather] [--warmup=N] [--format=text|json|csv] [--output=FILE] [--no-verify]\n", argv[0]);
         MPI_Finalize();
         return 1;
     }
@@ -50,127 +497,818 @@ int main(int argc, char* argv[]) {
     if (argc >= 5) {
         num_runs = atoi(argv[4]);
     }
+    // The whole run goes through `bench`; the setup and each run's phases are timed per rank.
+    phase_timer_t setup_phases, run_phases;
+    if (phase_timer_init(&setup_phases, 0, 1) != 0 || phase_timer_init(&run_phases, bench.warmup, num_runs) != 0 ||
+        bench_start(&bench, num_runs) != 0) {
+        perror("Memory allocation failed");
+        exit(EXIT_FAILURE);
+    }
     
     // Determine global number of rows based on scaling mode.
     if (strcmp(scaling_mode, "weak") == 0)
-        global_M = base_M * size;
+        global_M = (long) base_M * size;
     else
         global_M = base_M;
     
-    // Prepare counts and displacements for scattering the matrix rows.
-    int *sendcounts = (int*) malloc(size * sizeof(int));
-    int *displs = (int*) malloc(size * sizeof(int));
+    // A file fixes the dimensions: M x N for the matrix, N x K for the vectors. Every rank reads the
+    // headers; the data is mapped or read later, each rank its own rows.
+    matfile_t matrix_file, vector_file;
+    if (matrix_path) {
+        if (matfile_open(&matrix_file, matrix_path) != 0) {
+            if (rank == 0)
+                perror(matrix_path);
+            MPI_Finalize();
+            return 1;
+        }
+        global_M = (long) matrix_file.header.rows;
+        if (matrix_file.header.cols > INT_MAX || matrix_file.header.ld > INT_MAX) {
+            if (rank == 0)
+                printf("%s: rows of %llu elements are too long\n", matrix_path, (unsigned long long) matrix_file.header.ld);
+            MPI_Finalize();
+            return 1;
+        }
+        N = (int) matrix_file.header.cols;
+    }
+    if (vector_path) {
+        if (matfile_open(&vector_file, vector_path) != 0 ||
+            matfile_map_rows(&vector_file, 0, (long) vector_file.header.rows) != 0) {
+            if (rank == 0)
+                perror(vector_path);
+            MPI_Finalize();
+            return 1;
+        }
+        if (vector_file.header.rows != (uint64_t) N || vector_file.header.cols < 1 || vector_file.header.cols > INT_MAX) {
+            if (rank == 0)
+                printf("%s: expected %d rows (one per matrix column), found %llu x %llu\n", vector_path, N,
+                       (unsigned long long) vector_file.header.rows, (unsigned long long) vector_file.header.cols);
+            MPI_Finalize();
+            return 1;
+        }
+        K = (int) vector_file.header.cols;
+    }
+    if (matrix_path && (grid2d || dist != DIST_LOCAL)) {
+        if (rank == 0)
+            printf("--matrix requires --dist=local and the 1-D decomposition\n");
+        MPI_Finalize();
+        return 1;
+    }
+    if (stream_rows && !matrix_path) {
+        if (rank == 0)
+            printf("--stream requires --matrix\n");
+        MPI_Finalize();
+        return 1;
+    }
+    if (read_mode != READ_MMAP && !matrix_path) {
+        if (rank == 0)
+            printf("--read requires --matrix\n");
+        MPI_Finalize();
+        return 1;
+    }
+    if (stream_rows && read_mode != READ_MMAP) {
+        if (rank == 0)
+            printf("--stream requires --read=mmap\n");
+        MPI_Finalize();
+        return 1;
+    }
+    int is_sparse = (layout != LAYOUT_FLAT);
+    if (is_sparse && (dist != DIST_LOCAL || grid2d || K != 1 || shared_b || matrix_path || vector_path)) {
+        if (rank == 0)
+            printf("Sparse layouts require --dist=local, the 1-D decomposition and --batch=1, without --shared-b or files\n");
+        MPI_Finalize();
+        return 1;
+    }
+    char precision[16];
+    mixed_name(&mixed, precision, sizeof(precision));
+    if (mixed_init(&mixed, DOT_KERNEL_AUTO) != 0) {
+        if (rank == 0)
+            printf("Precision %s is not available\n", precision);
+        MPI_Finalize();
+        return 1;
+    }
+    int low = mixed_reduced(&mixed);
+    if (low && (dist != DIST_LOCAL || grid2d || is_sparse || K != 1 || shared_b || matrix_path || vector_path)) {
+        if (rank == 0)
+            printf("Reduced precision requires --dist=local, the 1-D decomposition, --layout=flat and --batch=1, without --shared-b or files\n");
+        MPI_Finalize();
+        return 1;
+    }
+    if (global_M > INT_MAX) {
+        if (rank == 0)
+            printf("Global row count %ld exceeds %d\n", global_M, INT_MAX);
+        MPI_Finalize();
+        return 1;
+    }
+    if (threads > 1 && provided < MPI_THREAD_FUNNELED) {
+        if (rank == 0)
+            printf("The MPI library does not support MPI_THREAD_FUNNELED; use --threads=1\n");
+        MPI_Finalize();
+        return 1;
+    }
+    omp_set_num_threads(threads);
+    if (grid2d && shared_b) {
+        if (rank == 0)
+            printf("--shared-b supports the 1-D decomposition only\n");
+        MPI_Finalize();
+        return 1;
+    }
+    if (grid2d && dist != DIST_LOCAL) {
+        if (rank == 0)
+            printf("The 2-D decomposition supports --dist=local only\n");
+        MPI_Finalize();
+        return 1;
+    }
+    
+    // 2-D grid: process (my_prow, my_pcol); row_comm holds one process row, col_comm one process column.
+    // No reordering, so process 0 is grid process (0, 0) and the root of both of its communicators.
+    MPI_Comm grid_comm = MPI_COMM_NULL, row_comm = MPI_COMM_NULL, col_comm = MPI_COMM_NULL;
+    int my_prow = 0, my_pcol = 0;
+    if (grid2d) {
+        int periods[2] = { 0, 0 }, coords[2];
+        int keep_cols[2] = { 0, 1 }, keep_rows[2] = { 1, 0 };
+        MPI_Dims_create(size, 2, dims);
+        MPI_Cart_create(MPI_COMM_WORLD, 2, dims, periods, 0, &grid_comm);
+        MPI_Cart_coords(grid_comm, rank, 2, coords);
+        my_prow = coords[0];
+        my_pcol = coords[1];
+        MPI_Cart_sub(grid_comm, keep_cols, &row_comm);
+        MPI_Cart_sub(grid_comm, keep_rows, &col_comm);
+    }
+    
+    // Rows per process (per process row in 2-D); counts and displacements are in rows, sent as N- and
+    // K-double row types. In 2-D they describe the gather of process column 0's results in col_comm.
+    int row_parts = grid2d ? dims[0] : size;
+    int *rowcounts = (int*) malloc(size * sizeof(int));
+    int *rowdispls = (int*) malloc(size * sizeof(int));
     int base = global_M / size;
     int rem = global_M % size;
-    for (int i = 0; i < size; i++) {
-        int rows = base + (i < rem ? 1 : 0);
-        sendcounts[i] = rows * N;  // Number of matrix elements for process i.
+    for (int i = 0; i < row_parts; i++) {
+        rowcounts[i] = grid2d ? (int) block_cyclic_count(global_M, block, i, dims[0]) : base + (i < rem ? 1 : 0);
     }
-    displs[0] = 0;
-    for (int i = 1; i < size; i++) {
-        displs[i] = displs[i-1] + sendcounts[i-1];
+    rowdispls[0] = 0;
+    for (int i = 1; i < row_parts; i++) {
+        rowdispls[i] = rowdispls[i-1] + rowcounts[i-1];
     }
+    MPI_Datatype a_row, p_row;
+    MPI_Type_contiguous(N, MPI_DOUBLE, &a_row);
+    MPI_Type_commit(&a_row);
+    MPI_Type_contiguous(K, MPI_DOUBLE, &p_row);
+    MPI_Type_commit(&p_row);
     
-    // Prepare separate arrays for gathering the result vector P.
-    int *recvcounts = (int*) malloc(size * sizeof(int));
-    int *rdispls = (int*) malloc(size * sizeof(int));
-    for (int i = 0; i < size; i++) {
-        int rows = base + (i < rem ? 1 : 0);
-        recvcounts[i] = rows;  // Each process contributes its number of rows.
+    // Pipeline rounds: in round c every rank receives rows [c * chunk, (c + 1) * chunk) of its block
+    // (fewer, or none past its end).
+    int rounds = 0;
+    int *chunkcounts = NULL, *chunkdispls = NULL;  // rounds x size, in rows.
+    MPI_Request *scatter_reqs = NULL, *gather_reqs = NULL;
+    if (dist == DIST_PIPELINE) {
+        rounds = (rowcounts[0] + chunk - 1) / chunk;  // Process 0 has the most rows.
+        chunkcounts = (int*) malloc((size_t) (rounds > 0 ? rounds : 1) * size * sizeof(int));
+        chunkdispls = (int*) malloc((size_t) (rounds > 0 ? rounds : 1) * size * sizeof(int));
+        scatter_reqs = (MPI_Request*) malloc((rounds > 0 ? rounds : 1) * sizeof(MPI_Request));
+        gather_reqs = (MPI_Request*) malloc((rounds > 0 ? rounds : 1) * sizeof(MPI_Request));
+        if (!chunkcounts || !chunkdispls || !scatter_reqs || !gather_reqs) {
+            perror("Memory allocation failed");
+            exit(EXIT_FAILURE);
+        }
+        for (int c = 0; c < rounds; c++) {
+            for (int i = 0; i < size; i++) {
+                long first = (long) c * chunk;
+                long left = rowcounts[i] - first;
+                chunkcounts[(size_t) c * size + i] = left <= 0 ? 0 : left < chunk ? (int) left : chunk;
+                chunkdispls[(size_t) c * size + i] = rowdispls[i] + (left <= 0 ? rowcounts[i] : (int) first);
+            }
+        }
     }
-    rdispls[0] = 0;
-    for (int i = 1; i < size; i++) {
-        rdispls[i] = rdispls[i-1] + recvcounts[i-1];
+    
+    int local_rows = grid2d ? rowcounts[my_prow] : rowcounts[rank];
+    int local_cols = grid2d ? (int) block_cyclic_count(N, block, my_pcol, dims[1]) : N;
+    long local_elements = (long) local_rows * local_cols;  // Number of matrix elements for this process.
+    
+    // With --matrix the local rows are this rank's mapping of the file, or with --read=mpiio a block
+    // they are read into in setup.
+    int mapped = matrix_path && read_mode == READ_MMAP;
+    if (mapped) {
+        if (matfile_map_rows(&matrix_file, rowdispls[rank], (long) rowdispls[rank] + local_rows) != 0) {
+            perror(matrix_path);
+            exit(EXIT_FAILURE);
+        }
+        local_A = matrix_file.data;
+    } else if (!is_sparse) {
+        local_A = (double*) malloc(local_elements * sizeof(double));
+    }
+    local_P = (double*) malloc((size_t) local_rows * K * sizeof(double));
+    // Shared B: node_comm holds the ranks of one node, leader_comm the first rank of every node.
+    MPI_Comm node_comm = MPI_COMM_NULL, leader_comm = MPI_COMM_NULL;
+    MPI_Win b_win = MPI_WIN_NULL;
+    int node_rank = 0, nodes = 0;
+    if (shared_b) {
+        MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &node_comm);
+        MPI_Comm_rank(node_comm, &node_rank);
+        MPI_Comm_split(MPI_COMM_WORLD, node_rank == 0 ? 0 : MPI_UNDEFINED, rank, &leader_comm);
+        MPI_Aint b_bytes = (node_rank == 0) ? (MPI_Aint) local_cols * K * sizeof(double) : 0;
+        MPI_Win_allocate_shared(b_bytes, sizeof(double), MPI_INFO_NULL, node_comm, &B, &b_win);
+        if (node_rank != 0) {
+            MPI_Aint leader_bytes;
+            int disp_unit;
+            MPI_Win_shared_query(b_win, 0, &leader_bytes, &disp_unit, &B);
+        } else {
+            MPI_Comm_size(leader_comm, &nodes);
+        }
+    } else if (!is_sparse) {
+        B = (double*) malloc((size_t) local_cols * K * sizeof(double));
+    }
+    if (low) {
+        local_A_low = malloc((size_t) (local_elements > 0 ? local_elements : 1) * dtype_bytes(mixed.storage));
+        B_low = malloc((size_t) local_cols * dtype_bytes(mixed.storage));
+        if (!local_A_low || !B_low) {
+            perror("Memory allocation failed");
+            exit(EXIT_FAILURE);
+        }
+    }
+    // Sparse layouts: the local rows, their SELL copy, the thread partition (rows or slices) and
+    // the halo plan. B is allocated once the plan knows how many entries it holds.
+    csr_t csr = {0};
+    sell_t sell = {0};
+    halo_t halo = {0};
+    int *bounds = NULL;
+    // Global row and column of every local row and column of the block.
+    long *row_global = (long*) malloc((size_t) (local_rows > 0 ? local_rows : 1) * sizeof(long));
+    long *col_global = (long*) malloc((size_t) (local_cols > 0 ? local_cols : 1) * sizeof(long));
+    if ((!local_A && !mapped && !is_sparse) || !local_P || (!B && !is_sparse) || !row_global || !col_global) {
+        perror("Memory allocation failed");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < local_rows; i++) {
+        row_global[i] = grid2d ? block_cyclic_global(i, block, my_prow, dims[0]) : (long) rowdispls[rank] + i;
+    }
+    for (int j = 0; j < local_cols; j++) {
+        col_global[j] = grid2d ? block_cyclic_global(j, block, my_pcol, dims[1]) : j;
     }
     
-    int local_elements = sendcounts[rank];  // Number of matrix elements for this process.
-    int local_rows = local_elements / N;
+    // View of the local block for the batched kernel (leading dimension local_cols, no padding,
+    // or the file's leading dimension when mapped).
+    Matrix local_view = { local_rows, local_cols, local_cols, local_A };
+    if (mapped) {
+        matfile_view(&matrix_file, &local_view);
+    }
+    gemv_plan_t plan;
+    gemv_plan_init(&plan, local_cols);
     
-    local_A = (double*) malloc(local_elements * sizeof(double));
-    local_P = (double*) malloc(local_rows * sizeof(double));
+    if (dist != DIST_LOCAL || (matrix_path && !mapped)) {
+        // Place the receive block's pages with the threads that compute on them before it is filled.
+        fill_rows(&local_view, 0.0);
+    }
     
-    // Process 0 initializes the global matrix and vector.
-    if (rank == 0) {
-        global_A_flat = (double*) malloc(global_M * N * sizeof(double));
-        for (int i = 0; i < global_M * N; i++) {
-            global_A_flat[i] = 1.0;
+    MPI_Barrier(MPI_COMM_WORLD);
+    double read_seconds = 0.0;  // Slowest rank's --read=mpiio time, on process 0.
+    if (dist != DIST_LOCAL) {
+        int init_phase = phase_define(&setup_phases, "init");
+        int scatter_phase = (dist == DIST_SCATTER) ? phase_define(&setup_phases, "scatter") : -1;
+        int bcast_phase = phase_define(&setup_phases, "broadcast");
+        // Process 0 generates the global matrix and vector, then broadcasts B. With --dist=scatter
+        // the rows are scattered once here; the other modes distribute them in every run.
+        phase_begin(&setup_phases);
+        if (rank == 0) {
+            global_A_flat = (double*) malloc((size_t) global_M * N * sizeof(double));
+            if (!global_A_flat) {
+                perror("Memory allocation failed");
+                exit(EXIT_FAILURE);
+            }
+            Matrix global_view = { (int) global_M, N, N, global_A_flat };
+            generate_rows(&global_view, &input, NULL, NULL);
+            generate_b(B, N, K, &input, vector_path ? &vector_file : NULL, NULL);
         }
-        B = (double*) malloc(N * sizeof(double));
-        for (int j = 0; j < N; j++) {
-            B[j] = 1.0;
+        phase_end(&setup_phases, init_phase);
+        if (dist == DIST_SCATTER) {
+            phase_begin(&setup_phases);
+            MPI_Scatterv(global_A_flat, rowcounts, rowdispls, a_row,
+                         local_A, local_rows, a_row, 0, MPI_COMM_WORLD);
+            phase_end(&setup_phases, scatter_phase);
+        }
+        phase_begin(&setup_phases);
+        if (shared_b) {
+            // Process 0 is the first rank of its node and rank 0 of leader_comm.
+            if (node_rank == 0)
+                MPI_Bcast(B, K, a_row, 0, leader_comm);  // N * K doubles per node
+            MPI_Win_fence(0, b_win);
+        } else {
+            MPI_Bcast(B, K, a_row, 0, MPI_COMM_WORLD);  // N * K doubles
+        }
+        phase_end(&setup_phases, bcast_phase);
+    } else if (grid2d) {
+        int generate_phase = phase_define(&setup_phases, "generate");
+        int bcast_phase = phase_define(&setup_phases, "broadcast");
+        // Every process generates its own block; process row 0 generates the pieces of B for its
+        // columns and broadcasts them down its process column.
+        phase_begin(&setup_phases);
+        generate_rows(&local_view, &input, row_global, col_global);
+        if (my_prow == 0) {
+            generate_b(B, local_cols, K, &input, vector_path ? &vector_file : NULL, col_global);
+        }
+        phase_end(&setup_phases, generate_phase);
+        phase_begin(&setup_phases);
+        MPI_Bcast(B, local_cols * K, MPI_DOUBLE, 0, col_comm);
+        phase_end(&setup_phases, bcast_phase);
+    } else if (is_sparse) {
+        int generate_phase = phase_define(&setup_phases, "generate");
+        int halo_phase = phase_define(&setup_phases, "halo");
+        // Every process sizes its rows and splits them between its threads, each thread generating
+        // the part it multiplies. The halo plan then renumbers the columns to indices of B, so SELL
+        // is filled from the CSR rows after it, and each process generates the block of B it owns.
+        phase_begin(&setup_phases);
+        bounds = (int*) malloc((threads + 1) * sizeof(int));
+        if (!bounds || csr_alloc(&csr, &sparse, &input, global_M, N, rowdispls[rank], local_rows) != 0 ||
+            (layout == LAYOUT_SELL && sell_alloc(&sell, &csr, sparse.sigma) != 0)) {
+            perror("Memory allocation failed");
+            exit(EXIT_FAILURE);
+        }
+        int scale = (layout == LAYOUT_SELL) ? SELL_C : 1;
+        if (layout == LAYOUT_SELL)
+            sparse_partition(sell.slice_ptr, sell.slices, threads, sparse.balance_nnz, bounds);
+        else
+            sparse_partition(csr.row_ptr, local_rows, threads, sparse.balance_nnz, bounds);
+#pragma omp parallel
+        {
+            int tid = omp_get_thread_num();
+            int nthreads = omp_get_num_threads();
+            for (int t = tid; t < threads; t += nthreads) {
+                int row_begin, row_end;
+                part_rows(bounds, t, scale, local_rows, &row_begin, &row_end);
+                csr_fill(&csr, &sparse, &input, row_begin, row_end);
+            }
+        }
+        phase_end(&setup_phases, generate_phase);
+        phase_begin(&setup_phases);
+        if (halo_create(&halo, halo_mode, &csr, N, MPI_COMM_WORLD) != 0) {
+            perror("Memory allocation failed");
+            exit(EXIT_FAILURE);
+        }
+        phase_end(&setup_phases, halo_phase);
+        phase_begin(&setup_phases);
+        B = (double*) calloc((size_t) (halo.x_size > 0 ? halo.x_size : 1), sizeof(double));
+        if (!B) {
+            perror("Memory allocation failed");
+            exit(EXIT_FAILURE);
+        }
+        if (layout == LAYOUT_SELL) {
+#pragma omp parallel
+            {
+                int tid = omp_get_thread_num();
+                int nthreads = omp_get_num_threads();
+                for (int t = tid; t < threads; t += nthreads) {
+                    sell_fill(&sell, &csr, bounds[t], bounds[t + 1]);
+                }
+            }
+        }
+#pragma omp parallel for schedule(static)
+        for (int j = 0; j < halo.own_count; j++) {
+            B[halo.own_at + j] = input_value(&input, INPUT_B, 0, halo.own_first + j);
+        }
+        phase_end(&setup_phases, generate_phase);
+    } else {
+        int read_phase = (matrix_path && !mapped) ? phase_define(&setup_phases, "read") : -1;
+        int generate_phase = phase_define(&setup_phases, "generate");
+        if (read_phase >= 0) {
+            // Every rank reads global rows [rowdispls[rank], + local_rows) of the file in one collective
+            // call; the file view shows each rank only its own rows (without the file's row padding).
+            phase_begin(&setup_phases);
+            uint64_t read_start = bench_now_ns();
+            if (read_rows(matrix_path, &matrix_file.header, rowdispls[rank], local_rows, local_A, a_row) != 0) {
+                MPI_Abort(MPI_COMM_WORLD, 1);
+            }
+            uint64_t read_ns = bench_now_ns() - read_start, max_read_ns;
+            phase_end(&setup_phases, read_phase);
+            MPI_Reduce(&read_ns, &max_read_ns, 1, MPI_UINT64_T, MPI_MAX, 0, MPI_COMM_WORLD);
+            read_seconds = max_read_ns / 1e9;
+        }
+        // Every process generates its own rows (global rows rowdispls[rank] onward; mapped or read
+        // already with --matrix) and B, or with --shared-b the node's first rank generates its node's B.
+        phase_begin(&setup_phases);
+        if (!matrix_path) {
+            generate_rows(&local_view, &input, row_global, NULL);
+        }
+        if (!shared_b || node_rank == 0) {
+            generate_b(B, N, K, &input, vector_path ? &vector_file : NULL, NULL);
+        }
+        if (shared_b) {
+            MPI_Win_fence(0, b_win);
+        }
+        phase_end(&setup_phases, generate_phase);
+        if (low) {
+            // The kernel reads copies rounded to --dtype; the fp64 data stays for the check.
+            int pack_phase = phase_define(&setup_phases, "pack");
+            phase_begin(&setup_phases);
+            pack_rows(&mixed, &local_view, local_A_low);
+            mixed_pack(mixed.storage, B, B_low, N);
+            phase_end(&setup_phases, pack_phase);
         }
-        P = (double*) malloc(global_M * sizeof(double));
     }
+    phase_run_done(&setup_phases);
     
-    // Scatter the global matrix rows.
-    MPI_Scatterv(global_A_flat, sendcounts, displs, MPI_DOUBLE,
-                 local_A, local_elements, MPI_DOUBLE, 0, MPI_COMM_WORLD);
-    
-    // Broadcast vector B to all processes.
+    // In 2-D a rank sees only part of each row, so the references are built once from the resident
+    // blocks and summed along the process row like the results: (sum, comp, magnitude) per result.
+    double *ref_parts = NULL;
+    if (grid2d && verify) {
+        ref_parts = (double*) malloc((size_t) (local_rows > 0 ? local_rows : 1) * K * 3 * sizeof(double));
+        if (!ref_parts) {
+            perror("Memory allocation failed");
+            exit(EXIT_FAILURE);
+        }
+#pragma omp parallel for
+        for (int i = 0; i < local_rows; i++) {
+            for (int k = 0; k < K; k++) {
+                verify_ref_t ref;
+                verify_dot_ref(local_A + (long) i * local_cols, B + k, K, local_cols, &ref);
+                double *part = ref_parts + ((long) i * K + k) * 3;
+                part[0] = ref.value.sum;
+                part[1] = ref.value.comp;
+                part[2] = ref.magnitude;
+            }
+        }
+        if (my_pcol == 0)
+            MPI_Reduce(MPI_IN_PLACE, ref_parts, local_rows * K * 3, MPI_DOUBLE, MPI_SUM, 0, row_comm);
+        else
+            MPI_Reduce(ref_parts, NULL, local_rows * K * 3, MPI_DOUBLE, MPI_SUM, 0, row_comm);
+    }
+    double *stage = NULL;  // Process column 0's results in process-row order, on process 0.
     if (rank == 0) {
-        MPI_Bcast(B, N, MPI_DOUBLE, 0, MPI_COMM_WORLD);
-    } else {
-        B = (double*) malloc(N * sizeof(double));
-        MPI_Bcast(B, N, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+        P = (double*) malloc((size_t) global_M * K * sizeof(double));
+        if (grid2d)
+            stage = (double*) malloc((size_t) global_M * K * sizeof(double));
+        if (!P || (grid2d && !stage)) {
+            perror("Memory allocation failed");
+            exit(EXIT_FAILURE);
+        }
     }
     
+    int scatter_phase = (dist == DIST_RESCATTER) ? phase_define(&run_phases, "scatter") : -1;
+    int exchange_phase = is_sparse ? phase_define(&run_phases, "exchange") : -1;
+    int compute_phase = phase_define(&run_phases, "compute");
+    int reduce_phase = grid2d ? phase_define(&run_phases, "reduce") : -1;
+    int gather_phase = (dist != DIST_PIPELINE) ? phase_define(&run_phases, "gather") : -1;
+    int wait_phase = (dist == DIST_PIPELINE) ? phase_define(&run_phases, "wait") : -1;
+    
+    double error_worst = 0.0, error_norm = 0.0;  // Of the last checked run, on process 0.
+    long error_nonfinite = 0;  // Its inf or NaN results, which the two above leave out.
     // Repeat runs and measure performance.
-    for (int run = 0; run < num_runs; run++) {
+    for (int run = 0; run < bench_total_runs(&bench); run++) {
         // Zero local result.
-        for (int i = 0; i < local_rows; i++) {
+        for (long i = 0; i < (long) local_rows * K; i++) {
             local_P[i] = 0.0;
         }
         
         MPI_Barrier(MPI_COMM_WORLD);
-        start_time = MPI_Wtime();
+        uint64_t start_ns = bench_now_ns();
         
-        // Each process computes its local matrix-vector multiplication.
-        for (int i = 0; i < local_rows; i++) {
-            double sum = 0.0;
-            for (int j = 0; j < N; j++) {
-                sum += local_A[i * N + j] * B[j];
+        if (dist == DIST_PIPELINE) {
+            // Every rank posts the same sequence of non-blocking collectives: the first
+            // PIPELINE_DEPTH scatters, then per round the next scatter and the gather of this round.
+            for (int c = 0; c < rounds && c < PIPELINE_DEPTH; c++) {
+                MPI_Iscatterv(global_A_flat, chunkcounts + (size_t) c * size, chunkdispls + (size_t) c * size, a_row,
+                              local_A + (long) (chunkdispls[(size_t) c * size + rank] - rowdispls[rank]) * N, chunkcounts[(size_t) c * size + rank], a_row,
+                              0, MPI_COMM_WORLD, &scatter_reqs[c]);
+            }
+            for (int c = 0; c < rounds; c++) {
+                phase_begin(&run_phases);
+                MPI_Wait(&scatter_reqs[c], MPI_STATUS_IGNORE);
+                phase_end(&run_phases, wait_phase);
+                int next = c + PIPELINE_DEPTH;
+                if (next < rounds) {
+                    MPI_Iscatterv(global_A_flat, chunkcounts + (size_t) next * size, chunkdispls + (size_t) next * size, a_row,
+                                  local_A + (long) (chunkdispls[(size_t) next * size + rank] - rowdispls[rank]) * N, chunkcounts[(size_t) next * size + rank], a_row,
+                                  0, MPI_COMM_WORLD, &scatter_reqs[next]);
+                }
+                
+                int row_begin = chunkdispls[(size_t) c * size + rank] - rowdispls[rank];
+                int row_end = row_begin + chunkcounts[(size_t) c * size + rank];
+                phase_begin(&run_phases);
+                compute_rows(&local_view, B, K, local_P, row_begin, row_end, &plan);
+                phase_end(&run_phases, compute_phase);
+                
+                MPI_Igatherv(local_P + (long) row_begin * K, row_end - row_begin, p_row,
+                             P, chunkcounts + (size_t) c * size, chunkdispls + (size_t) c * size, p_row,
+                             0, MPI_COMM_WORLD, &gather_reqs[c]);
+            }
+            phase_begin(&run_phases);
+            MPI_Waitall(rounds, gather_reqs, MPI_STATUSES_IGNORE);
+            phase_end(&run_phases, wait_phase);
+        } else {
+            if (dist == DIST_RESCATTER) {
+                // Scatter the rows again before computing.
+                phase_begin(&run_phases);
+                MPI_Scatterv(global_A_flat, rowcounts, rowdispls, a_row,
+                             local_A, local_rows, a_row, 0, MPI_COMM_WORLD);
+                phase_end(&run_phases, scatter_phase);
+            }
+            
+            if (is_sparse) {
+                // Fetch the entries of B owned elsewhere (or all of B with --halo=allgather).
+                phase_begin(&run_phases);
+                halo_exchange(&halo, B);
+                phase_end(&run_phases, exchange_phase);
+            }
+            
+            // Each process computes its local matrix-vector multiplication.
+            phase_begin(&run_phases);
+            if (is_sparse) {
+                spmv_parts(&csr, layout == LAYOUT_SELL ? &sell : NULL, bounds, threads, B, local_P);
+            } else if (stream_rows) {
+                // Out of core: read ahead on the next panel while this one is multiplied, then drop it.
+                long first = rowdispls[rank];
+                matfile_prefetch(&matrix_file, first, first + (stream_rows < local_rows ? stream_rows : local_rows));
+                for (int row = 0; row < local_rows; row += stream_rows) {
+                    int end = (local_rows - row < stream_rows) ? local_rows : row + stream_rows;
+                    matfile_prefetch(&matrix_file, first + end,
+                                     first + ((local_rows - end < stream_rows) ? local_rows : end + stream_rows));
+                    compute_rows(&local_view, B, K, local_P, row, end, &plan);
+                    matfile_release(&matrix_file, first + row, first + end);
+                }
+            } else if (low) {
+                compute_rows_mixed(&mixed, &local_view, local_A_low, B_low, local_P, 0, local_rows, &plan);
+            } else {
+                compute_rows(&local_view, B, K, local_P, 0, local_rows, &plan);
+            }
+            phase_end(&run_phases, compute_phase);
+            
+            if (grid2d) {
+                // Sum the partial results along each process row onto process column 0.
+                phase_begin(&run_phases);
+                if (my_pcol == 0)
+                    MPI_Reduce(MPI_IN_PLACE, local_P, local_rows * K, MPI_DOUBLE, MPI_SUM, 0, row_comm);
+                else
+                    MPI_Reduce(local_P, NULL, local_rows * K, MPI_DOUBLE, MPI_SUM, 0, row_comm);
+                phase_end(&run_phases, reduce_phase);
+                
+                // Process column 0 gathers the row blocks; process 0 puts them back in global order.
+                phase_begin(&run_phases);
+                if (my_pcol == 0) {
+                    MPI_Gatherv(local_P, local_rows, p_row, stage, rowcounts, rowdispls, p_row, 0, col_comm);
+                }
+                if (rank == 0) {
+                    for (int r = 0; r < dims[0]; r++) {
+                        for (long i = 0; i < rowcounts[r]; i++) {
+                            long g = block_cyclic_global(i, block, r, dims[0]);
+                            memcpy(P + g * K, stage + (rowdispls[r] + i) * K, K * sizeof(double));
+                        }
+                    }
+                }
+                phase_end(&run_phases, gather_phase);
+            } else {
+                // Gather the local result vectors into the global result vector P.
+                phase_begin(&run_phases);
+                MPI_Gatherv(local_P, local_rows, p_row, P, rowcounts, rowdispls, p_row, 0, MPI_COMM_WORLD);
+                phase_end(&run_phases, gather_phase);
             }
-            local_P[i] = sum;
         }
+        phase_run_done(&run_phases);
         
-        end_time = MPI_Wtime();
-        double elapsed = end_time - start_time;
-        total_time += elapsed;
-        
-        // Gather the local result vectors into the global result vector P.
-        MPI_Gatherv(local_P, local_rows, MPI_DOUBLE, P, recvcounts, rdispls, MPI_DOUBLE, 0, MPI_COMM_WORLD);
-        
+        // A run takes as long as its slowest rank.
+        uint64_t elapsed_ns = bench_now_ns() - start_ns, max_ns;
+        MPI_Reduce(&elapsed_ns, &max_ns, 1, MPI_UINT64_T, MPI_MAX, 0, MPI_COMM_WORLD);
         if (rank == 0) {
-            // Verification: Each row's dot product should equal N.
-            int error = 0;
-            for (int i = 0; i < global_M; i++) {
-                if (P[i] != (double) N) {
-                    error = 1;
-                    break;
+            bench_record(&bench, max_ns);
+        }
+        
+        if (verify) {
+            // Each rank checks its own rows; B holds vector k at stride K.
+            long local_mismatches = 0, mismatches = 0;
+            if (grid2d) {
+                // The summed row references; only process column 0 holds whole results.
+                int check_rows = (my_pcol == 0) ? local_rows : 0;
+#pragma omp parallel for reduction(+:local_mismatches)
+                for (int i = 0; i < check_rows; i++) {
+                    for (int k = 0; k < K; k++) {
+                        const double *part = ref_parts + ((long) i * K + k) * 3;
+                        verify_ref_t ref = { { part[0], part[1] }, part[2], N };
+                        if (!verify_check(local_P[(long) i * K + k], &ref)) {
+                            local_mismatches++;
+                        }
+                    }
+                }
+            } else if (is_sparse) {
+                // The CSR rows, with columns already renumbered to indices of B.
+#pragma omp parallel for reduction(+:local_mismatches)
+                for (int i = 0; i < local_rows; i++) {
+                    verify_ref_t ref;
+                    verify_gather_ref(csr.val + csr.row_ptr[i], csr.col + csr.row_ptr[i], B,
+                                      csr.row_ptr[i + 1] - csr.row_ptr[i], &ref);
+                    if (!verify_check(local_P[i], &ref)) {
+                        local_mismatches++;
+                    }
+                }
+            } else {
+                // Against the fp64 data, with the tolerance of the storage format; the largest row
+                // error and the squared error and reference norms of the finite results are kept for
+                // the report, and inf or NaN results (fp16 overflow) are counted apart, since a max
+                // reduction, OpenMP's or MPI_MAX, may drop a NaN.
+                double u_store = mixed_store_error(&mixed), u_sum = mixed_sum_error(&mixed);
+                double largest = 0.0, sums[3] = { 0.0, 0.0, 0.0 };
+                double error_sq = 0.0, ref_sq = 0.0, bad = 0.0;
+#pragma omp parallel for reduction(+:local_mismatches, error_sq, ref_sq, bad) reduction(max:largest)
+                for (int i = 0; i < local_rows; i++) {
+                    for (int k = 0; k < K; k++) {
+                        verify_ref_t ref;
+                        verify_dot_ref(matrix_row(&local_view, i), B + k, K, N, &ref);
+                        double got = local_P[(long) i * K + k], error = got - verify_ref_value(&ref);
+                        if (!verify_check_mixed(got, &ref, u_store, u_sum)) {
+                            local_mismatches++;
+                        }
+                        if (!isfinite(got)) {
+                            bad++;
+                            continue;
+                        }
+                        double scaled = verify_scaled_error(got, &ref);
+                        largest = (scaled > largest) ? scaled : largest;
+                        error_sq += error * error;
+                        ref_sq += verify_ref_value(&ref) * verify_ref_value(&ref);
+                    }
+                }
+                double local_sums[3] = { error_sq, ref_sq, bad };
+                MPI_Reduce(&largest, &error_worst, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+                MPI_Reduce(local_sums, sums, 3, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+                error_nonfinite = (long) sums[2];
+                error_norm = (sums[1] > 0) ? sqrt(sums[0] / sums[1]) : sqrt(sums[0]);
+                if (error_nonfinite) {
+                    error_worst = error_norm = NAN;
                 }
             }
-            if (error) {
-                printf("Run %d: Error in matrix-vector multiplication!\n", run+1);
+            MPI_Reduce(&local_mismatches, &mismatches, 1, MPI_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+            if (rank == 0 && mismatches) {
+                printf("Run %d: Error in matrix-vector multiplication! %ld of %ld results out of tolerance\n", run+1,
+                       mismatches, global_M * K);
             }
         }
     }
     
+    // Sparse layouts: nonzeros, stored elements, row or slice pointer bytes and B entries received
+    // per exchange, summed over the processes (received entries also as the maximum).
+    double sparse_local[4] = { 0 }, sparse_sums[4] = { 0 };
+    int halo_max = 0;
+    if (is_sparse) {
+        sparse_local[0] = csr.nnz;
+        sparse_local[1] = (layout == LAYOUT_SELL) ? sell.slice_ptr[sell.slices] : csr.nnz;
+        sparse_local[2] = (layout == LAYOUT_SELL) ? (double) sell.slices * (sizeof(long) + sizeof(int) + SELL_C * sizeof(int))
+                                                  : (double) (local_rows + 1) * sizeof(long);
+        sparse_local[3] = halo.halo_count;
+        MPI_Reduce(sparse_local, sparse_sums, 4, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+        MPI_Reduce(&halo.halo_count, &halo_max, 1, MPI_INT, MPI_MAX, 0, MPI_COMM_WORLD);
+    }
+    
     if (rank == 0) {
-        double avg_time = total_time / num_runs;
         printf("MPI Matrix-Vector Multiplication Performance\n");
-        printf("Processes: %d, Global Matrix Size: %d x %d, Scaling: %s, Runs: %d\n", size, global_M, N, scaling_mode, num_runs);
-        printf("Average Time (seconds): %f\n", avg_time);
+        printf("Processes: %d, Threads per process: %d, Global Matrix Size: %ld x %d, Scaling: %s, Runs: %d\n", size, threads,
+               global_M, N, scaling_mode, num_runs);
+        printf("Distribution: %s, Process 0 matrix data: %.1f MB\n", dist_names[dist], is_sparse
+               ? sparse_local[1] * (sizeof(double) + sizeof(int)) / 1e6
+               : (dist != DIST_LOCAL ? global_M * N + local_elements : local_elements) * (double) sizeof(double) / 1e6);
+        char pattern[32];
+        sparse_name(&sparse, pattern, sizeof(pattern));
+        if (is_sparse) {
+            printf("Sparse: %s, %.0f nonzeros (%.2f per row), threads split by %s\n", pattern, sparse_sums[0],
+                   global_M > 0 ? sparse_sums[0] / global_M : 0.0, sparse.balance_nnz ? "nonzeros" : "rows");
+            if (layout == LAYOUT_SELL)
+                printf("Kernel: SELL-%d-%d (%s), padding %.1f%% of stored elements\n", SELL_C, sparse.sigma, sell.isa,
+                       sparse_sums[1] > 0 ? 100.0 * (sparse_sums[1] - sparse_sums[0]) / sparse_sums[1] : 0.0);
+            else
+                printf("Kernel: csr\n");
+            printf("B: %s exchange, process 0 holds %d of %d entries, received per run: max %d, mean %.1f per process\n",
+                   halo_names[halo_mode], halo.x_size, N, halo_max, sparse_sums[3] / size);
+        } else if (shared_b) {
+            printf("B: shared, %d copies (one per node) of %.3f MB\n", nodes, (double) N * K * sizeof(double) / 1e6);
+        } else {
+            printf("B: private, %d copies (one per process) of %.3f MB\n", size,
+                   (double) local_cols * K * sizeof(double) / 1e6);
+        }
+        if (grid2d) {
+            printf("Decomposition: 2-D, Grid: %d x %d, Block: %d, Process 0 B entries: %d of %d\n", dims[0], dims[1],
+                   block, local_cols, N);
+        }
+        if (low) {
+            printf("Precision: %s storage, %s accumulation, %zu bytes per element, Kernel: %s\n",
+                   dtype_name(mixed.storage), dtype_name(mixed.accum), dtype_bytes(mixed.storage), mixed.isa);
+            if (verify) {
+                printf("Error vs fp64 reference: %.3g of sum|a*b| (worst row), %.3g relative 2-norm", error_worst,
+                       error_norm);
+                if (error_nonfinite) {
+                    printf(", %ld of %ld results not finite", error_nonfinite, global_M * K);
+                }
+                printf("\n");
+            }
+        }
+        printf("Input: %s (seed %llu)\n", input_name(&input), (unsigned long long) input.seed);
+        if (matrix_path && stream_rows)
+            printf("Matrix: %s (each rank maps its rows, streamed in %d-row panels)\n", matrix_path, stream_rows);
+        else if (mapped)
+            printf("Matrix: %s (each rank maps its rows)\n", matrix_path);
+        else if (matrix_path)
+            printf("Matrix: %s (each rank reads its rows with MPI_File_read_at_all)\n", matrix_path);
+        if (matrix_path && !mapped) {
+            double read_bytes = (double) global_M * N * sizeof(double);
+            printf("Read: %.1f MB in %.6f s, aggregate %.3f GB/s\n", read_bytes / 1e6, read_seconds,
+                   read_seconds > 0.0 ? read_bytes / read_seconds / 1e9 : 0.0);
+        }
+        if (vector_path)
+            printf("Vectors: %s\n", vector_path);
+        if (dist == DIST_PIPELINE) {
+            printf("Chunk: %d rows, Rounds: %d, Depth: %d\n", chunk, rounds, PIPELINE_DEPTH);
+        }
+        // Every rank streams its rows of A once for all K vectors. A sparse A is its stored values and
+        // column indices plus the pointers, and B is counted once per rank entry held.
+        double flops = 2.0 * global_M * N * K;
+        double bytes = ((double) global_M * N + (double) N * K) * dtype_bytes(mixed.storage) +
+                       (double) global_M * K * sizeof(double);
+        if (is_sparse) {
+            flops = 2.0 * sparse_sums[0];
+            bytes = sparse_sums[1] * (sizeof(double) + sizeof(int)) + sparse_sums[2] +
+                    ((double) N + sparse_sums[3] + global_M) * sizeof(double);
+        }
+        printf("Batch: %d, Bytes/flop: %.3f\n", K, bytes / flops);
+        char kernel_name[32];
+        if (layout == LAYOUT_SELL)
+            snprintf(kernel_name, sizeof(kernel_name), "sell-%s", sell.isa);
+        else if (layout == LAYOUT_CSR)
+            snprintf(kernel_name, sizeof(kernel_name), "csr");
+        else if (low)
+            snprintf(kernel_name, sizeof(kernel_name), "blocked-%s", mixed.isa);
+        else
+            snprintf(kernel_name, sizeof(kernel_name), "%s%s", (K == 1) ? "naive" : "batched-", (K == 1) ? "" : plan.isa);
+        char config[160];
+        if (grid2d)
+            snprintf(config, sizeof(config), "decomp=2d grid=%dx%d block=%d", dims[0], dims[1], block);
+        else if (dist == DIST_PIPELINE)
+            snprintf(config, sizeof(config), "dist=pipeline chunk=%d", chunk);
+        else
+            snprintf(config, sizeof(config), "dist=%s", dist_names[dist]);
+        if (shared_b)
+            strncat(config, " b=shared", sizeof(config) - strlen(config) - 1);
+        snprintf(config + strlen(config), sizeof(config) - strlen(config), " init=%s dtype=%s", input_name(&input),
+                 precision);
+        if (matrix_path && stream_rows)
+            snprintf(config + strlen(config), sizeof(config) - strlen(config), " matrix=stream:%d", stream_rows);
+        else if (matrix_path)
+            snprintf(config + strlen(config), sizeof(config) - strlen(config), " matrix=%s", read_names[read_mode]);
+        if (vector_path)
+            strncat(config, " vector=file", sizeof(config) - strlen(config) - 1);
+        if (is_sparse)
+            snprintf(config + strlen(config), sizeof(config) - strlen(config), " layout=%s sparse=%s balance=%s halo=%s",
+                     layout_names[layout], pattern, sparse.balance_nnz ? "nnz" : "rows", halo_names[halo_mode]);
+        if (layout == LAYOUT_SELL)
+            snprintf(config + strlen(config), sizeof(config) - strlen(config), " sigma=%d", sparse.sigma);
+        bench_info_t info = { .program = "mpi_matrix_vector", .scaling = scaling_mode, .kernel = kernel_name,
+                              .config = config, .threads = threads, .procs = size, .m = global_M, .n = N, .k = K, .flops = flops, .bytes = bytes };
+        bench_report(&bench, &info);
     }
+    phase_report(&setup_phases, "Setup", MPI_COMM_WORLD);
+    phase_report(&run_phases, "Run phases", MPI_COMM_WORLD);
+    bench_finish(&bench);
+    phase_timer_free(&setup_phases);
+    phase_timer_free(&run_phases);
     
-    free(local_A);
+    if (matrix_path) {
+        matfile_close(&matrix_file);
+    }
+    if (!mapped) {
+        free(local_A);
+    }
+    if (vector_path) {
+        matfile_close(&vector_file);
+    }
+    if (is_sparse) {
+        csr_free(&csr);
+        sell_free(&sell);
+        halo_free(&halo);
+        free(bounds);
+    }
     free(local_P);
-    free(sendcounts);
-    free(displs);
-    free(recvcounts);
-    free(rdispls);
-    free(B);
+    free(local_A_low);
+    free(B_low);
+    free(row_global);
+    free(col_global);
+    free(rowcounts);
+    free(rowdispls);
+    free(chunkcounts);
+    free(chunkdispls);
+    free(scatter_reqs);
+    free(gather_reqs);
+    free(ref_parts);
+    if (grid2d) {
+        MPI_Comm_free(&row_comm);
+        MPI_Comm_free(&col_comm);
+        MPI_Comm_free(&grid_comm);
+    }
+    MPI_Type_free(&a_row);
+    MPI_Type_free(&p_row);
+    if (shared_b) {
+        MPI_Win_free(&b_win);
+        if (leader_comm != MPI_COMM_NULL)
+            MPI_Comm_free(&leader_comm);
+        MPI_Comm_free(&node_comm);
+    } else {
+        free(B);
+    }
     if (rank == 0) {
         free(P);
+        free(stage);
         free(global_A_flat);
     }
     
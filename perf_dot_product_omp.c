@@ -8,22 +8,213 @@
 //   It accepts command-line arguments for the number of threads, a base vector size,
 //   a scaling mode (strong or weak), and the number of runs.
 //   For weak scaling, the effective vector size = base_vector_size * num_threads.
-//   It uses omp_get_wtime() to time the parallel region, repeats the measurement for multiple runs,
-//   and then prints the average execution time.
+//   Each run's parallel region is timed with the shared harness (see bench.h): warm-up runs are
+//   dropped and min/median/p90/max/stddev, GFLOP/s and GB/s are reported, optionally as JSON/CSV records.
+//   Each thread runs the shared dot product kernel (see dot_kernels.h) over its own contiguous chunk;
+//   --kernel selects the variant so the SIMD speedup can be measured per thread count.
+//   --first-touch=parallel has each thread initialize the chunk it later reads, so on NUMA machines
+//   the pages are placed on that thread's node. Threads are bound with OMP_PLACES/OMP_PROC_BIND
+//   (e.g. OMP_PLACES=cores OMP_PROC_BIND=close) and the placement actually seen is printed.
+//   --alloc=reuse (default) allocates and initializes A and B once from a huge-page arena
+//   (see arena.h) and times every run on the same warm data; --alloc=cold mallocs,
+//   initializes and frees them in every run as the original program did.
+//   A and B come from the seeded generators in input.h (--init=ones|uniform|normal|ill|sparse,
+//   --seed=S; uniform by default), generated in parallel over the kernel's chunks.
+//   Results are checked against a compensated reference with an n-scaled tolerance (see verify.h),
+//   computed in parallel whenever the data is initialized; --no-verify skips it.
+//   --sum=repro makes the result bit-for-bit independent of the thread count (see repro.h): each
+//   thread takes whole fixed-size blocks, adds their kernel partials into its own exact accumulator,
+//   and the accumulators are merged exactly. Each run then also times the fast
+//   reduction(+:dot_product) path right after, and the overhead of the reproducible sum is printed.
+//   --dtype=fp32|bf16|fp16 stores A and B in a narrower format and runs the mixed-precision kernels
+//   (see mixed.h), summing in fp64 or, with --accum=fp32, in fp32. The fp64 data is generated as
+//   before and kept for the reference; each thread rounds its chunk into the packed copies the
+//   kernels read, and the error of the result against the fp64 reference is printed.
 // Usage:
-//   gcc -fopenmp perf_dot_product_omp.c -o perf_dot_product_omp
+//   gcc -O2 -fopenmp perf_dot_product_omp.c dot_kernels.c affinity.c arena.c bench.c verify.c repro.c input.c mixed.c -o perf_dot_product_omp -lm
 //   ./perf_dot_product_omp <num_threads> <base_vector_size> <strong|weak> [num_runs]
+//                          [--kernel=auto|scalar|sse|avx2|avx512] [--first-touch=serial|parallel]
+//                          [--alloc=reuse|cold] [--warmup=N] [--format=text|json|csv] [--output=FILE]
+//                          [--sum=fast|repro] [--init=ones|uniform|normal|ill|sparse] [--seed=S]
+//                          [--dtype=fp64|fp32|bf16|fp16] [--accum=fp64|fp32] [--no-verify]
 //
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <math.h>
 #include <omp.h>
+#include "dot_kernels.h"
+#include "affinity.h"
+#include "arena.h"
+#include "bench.h"
+#include "verify.h"
+#include "repro.h"
+#include "input.h"
+#include "mixed.h"
 
 #define DEFAULT_NUM_RUNS 5
 
+// Generate A and B, each thread the chunk the kernel gives it, and round that chunk into A_low and
+// B_low when the data is stored narrower (mixed->storage). With parallel_touch that write is also the
+// first touch, so each page is placed with its reader; otherwise one thread zeroes the vectors
+// first, which places every page on its node, and the generation is still parallel.
+static void init_vectors(const input_t *input, const mixed_t *mixed, double *A, double *B, void *A_low, void *B_low,
+                         int vector_size, int parallel_touch) {
+    int low = mixed_reduced(mixed);
+    if (!parallel_touch) {
+        memset(A, 0, (size_t) vector_size * sizeof(double));
+        memset(B, 0, (size_t) vector_size * sizeof(double));
+        if (low) {
+            memset(A_low, 0, (size_t) vector_size * dtype_bytes(mixed->storage));
+            memset(B_low, 0, (size_t) vector_size * dtype_bytes(mixed->storage));
+        }
+    }
+#pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        int nthreads = omp_get_num_threads();
+        int chunk = vector_size / nthreads;
+        int remainder = vector_size % nthreads;
+        int start = tid * chunk + (tid < remainder ? tid : remainder);
+        int len = chunk + (tid < remainder ? 1 : 0);
+        input_fill(input, INPUT_A, 0, start, A + start, 1, len);
+        input_fill(input, INPUT_B, 0, start, B + start, 1, len);
+        if (low) {
+            mixed_pack(mixed->storage, A + start, mixed_at(mixed->storage, A_low, start), len);
+            mixed_pack(mixed->storage, B + start, mixed_at(mixed->storage, B_low, start), len);
+        }
+    }
+}
+
+// Compensated reference for A.B, built in parallel over the kernel's chunks and merged in thread order.
+static void dot_reference(const double *A, const double *B, int vector_size, verify_ref_t *ref) {
+    int max_threads = omp_get_max_threads();
+    verify_ref_t *parts = (verify_ref_t*) calloc(max_threads, sizeof(verify_ref_t));
+    if (!parts) {
+        perror("Memory allocation failed");
+        exit(EXIT_FAILURE);
+    }
+#pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        int nthreads = omp_get_num_threads();
+        int chunk = vector_size / nthreads;
+        int remainder = vector_size % nthreads;
+        int start = tid * chunk + (tid < remainder ? tid : remainder);
+        int len = chunk + (tid < remainder ? 1 : 0);
+        verify_dot_ref(A + start, B + start, 1, len, &parts[tid]);
+    }
+    verify_ref_t total = {0};
+    for (int t = 0; t < max_threads; t++) {
+        verify_ref_merge(&total, &parts[t]);
+    }
+    *ref = total;
+    free(parts);
+}
+
+// Reproducible A.B: each thread adds the partials of its whole blocks into its own accumulator in
+// accs, and merging them is exact, so neither the thread count nor the merge order matters.
+static double dot_repro(dot_kernel_fn dot_kernel, const double *A, const double *B, int vector_size,
+                        repro_acc_t *accs) {
+    int nthreads = 1;
+#pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        long start, end;
+        if (tid == 0) {
+            nthreads = omp_get_num_threads();
+        }
+        repro_range(vector_size, tid, omp_get_num_threads(), &start, &end);
+        repro_init(&accs[tid]);
+        repro_dot(&accs[tid], dot_kernel, A + start, B + start, end - start);
+    }
+    repro_acc_t total;
+    repro_init(&total);
+    for (int t = 0; t < nthreads; t++) {
+        repro_merge(&total, &accs[t]);
+    }
+    return repro_result(&total);
+}
+
 int main(int argc, char *argv[]) {
+    dot_kernel_t kernel = DOT_KERNEL_AUTO;
+    int parallel_touch = 0;
+    int reuse = 1;  // --alloc=reuse
+    int verify = 1;
+    int repro = 0;  // --sum=fast
+    bench_t bench;
+    bench_defaults(&bench);
+    input_t input;
+    input_defaults(&input);
+    mixed_t mixed;
+    mixed_defaults(&mixed);
+    // Pull --option=value flags out of argv so the positional arguments keep their places.
+    int nargs = 1, rc;
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--kernel=", 9) == 0) {
+            if (dot_kernel_parse(argv[i] + 9, &kernel) != 0) {
+                printf("Unknown kernel: %s\n", argv[i] + 9);
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--first-touch=", 14) == 0) {
+            if (strcmp(argv[i] + 14, "serial") == 0) {
+                parallel_touch = 0;
+            } else if (strcmp(argv[i] + 14, "parallel") == 0) {
+                parallel_touch = 1;
+            } else {
+                printf("Unknown first-touch mode: %s\n", argv[i] + 14);
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--alloc=", 8) == 0) {
+            if (strcmp(argv[i] + 8, "reuse") == 0) {
+                reuse = 1;
+            } else if (strcmp(argv[i] + 8, "cold") == 0) {
+                reuse = 0;
+            } else {
+                printf("Unknown allocation mode: %s\n", argv[i] + 8);
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--sum=", 6) == 0) {
+            if (strcmp(argv[i] + 6, "fast") == 0) {
+                repro = 0;
+            } else if (strcmp(argv[i] + 6, "repro") == 0) {
+                repro = 1;
+            } else {
+                printf("Unknown summation mode: %s\n", argv[i] + 6);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--no-verify") == 0) {
+            verify = 0;
+        } else if ((rc = bench_parse_arg(&bench, argv[i])) != 0 || (rc = input_parse_arg(&input, argv[i])) != 0 ||
+                   (rc = mixed_parse_arg(&mixed, argv[i])) != 0) {
+            if (rc < 0) {
+                printf("Invalid option: %s\n", argv[i]);
+                return 1;
+            }
+        } else {
+            argv[nargs++] = argv[i];
+        }
+    }
+    argc = nargs;
     if (argc < 4) {
-        printf("Usage: %s <num_threads> <base_vector_size> <strong|weak> [num_runs]\n", argv[0]);
+        printf("Usage: %s <num_threads> <base_vector_size> <strong|weak> [num_runs] [--kernel=auto|scalar|sse|avx2|avx512] [--first-touch=serial|parallel] [--alloc=reuse|cold] [--sum=fast|repro] [--init=ones|uniform|normal|ill|sparse] [--seed=S] [--dtype=fp64|fp32|bf16|fp16] [--accum=fp64|fp32] [--warmup=N] [--format=text|json|csv] [--output=FILE] [--no-verify]\n", argv[0]);
+        return 1;
+    }
+    char precision[16];
+    mixed_name(&mixed, precision, sizeof(precision));
+    if (mixed_init(&mixed, kernel) != 0) {
+        printf("Precision %s is not available with kernel %s\n", precision, dot_kernel_name(kernel));
+        return 1;
+    }
+    int low = mixed_reduced(&mixed);
+    if (low && repro) {
+        printf("--sum=repro requires --dtype=fp64\n");
+        return 1;
+    }
+    kernel = dot_kernel_resolve(kernel);
+    dot_kernel_fn dot_kernel = dot_kernel_get(kernel);
+    if (!dot_kernel) {
+        printf("Kernel %s is not supported on this CPU\n", dot_kernel_name(kernel));
         return 1;
     }
     int num_threads = atoi(argv[1]);
@@ -32,46 +223,154 @@ int main(int argc, char *argv[]) {
     int num_runs = (argc >= 5) ? atoi(argv[4]) : DEFAULT_NUM_RUNS;
     int vector_size = (strcmp(scaling, "weak") == 0) ? base_size * num_threads : base_size;
 
-    double total_time = 0.0;
-    double dot_product, seq_dot;
+    double dot_product;
+    double first_repro = 0.0;  // The reproducible result of the first run; every later run must match it.
+    verify_ref_t ref;
+    bench_t fast;  // The fast path, timed in each run alongside the reproducible sum.
+    bench_defaults(&fast);
+    fast.warmup = bench.warmup;
+    repro_acc_t *accs = (repro_acc_t*) malloc(num_threads * sizeof(repro_acc_t));
+    if (!accs || bench_start(&bench, num_runs) != 0 || bench_start(&fast, num_runs) != 0) {
+        perror("Memory allocation failed");
+        exit(EXIT_FAILURE);
+    }
 
-    for (int run = 0; run < num_runs; run++) {
-        double *A = (double*) malloc(vector_size * sizeof(double));
-        double *B = (double*) malloc(vector_size * sizeof(double));
-        if (!A || !B) {
+    omp_set_num_threads(num_threads);
+    double *A = NULL, *B = NULL;
+    void *A_low = NULL, *B_low = NULL;  // Packed copies the kernel reads with --dtype narrower than fp64.
+    size_t low_bytes = low ? (size_t) vector_size * dtype_bytes(mixed.storage) : 0;
+    double error_relative = 0.0, error_scaled = 0.0;  // Of the last checked result.
+    arena_t arena = {0};
+    if (reuse) {
+        // Allocate and warm A and B once; every run reuses them.
+        size_t bytes = (size_t) vector_size * sizeof(double);
+        if (arena_init(&arena, 2 * bytes + 2 * low_bytes + 256) != 0 ||
+            !(A = (double*) arena_alloc(&arena, bytes, 64)) ||
+            !(B = (double*) arena_alloc(&arena, bytes, 64)) ||
+            (low && (!(A_low = arena_alloc(&arena, low_bytes, 64)) || !(B_low = arena_alloc(&arena, low_bytes, 64))))) {
             perror("Memory allocation failed");
             exit(EXIT_FAILURE);
         }
-        // Initialize arrays with 1.0
-        for (int i = 0; i < vector_size; i++) {
-            A[i] = 1.0;
-            B[i] = 1.0;
+        init_vectors(&input, &mixed, A, B, A_low, B_low, vector_size, parallel_touch);
+        if (verify) {
+            dot_reference(A, B, vector_size, &ref);
         }
-        dot_product = 0.0;
-        omp_set_num_threads(num_threads);
-        double t_start = omp_get_wtime();
-#pragma omp parallel for reduction(+:dot_product)
-        for (int i = 0; i < vector_size; i++) {
-            dot_product += A[i] * B[i];
+    }
+
+    for (int run = 0; run < bench_total_runs(&bench); run++) {
+        if (!reuse) {
+            A = (double*) malloc(vector_size * sizeof(double));
+            B = (double*) malloc(vector_size * sizeof(double));
+            if (low) {
+                A_low = malloc(low_bytes);
+                B_low = malloc(low_bytes);
+            }
+            if (!A || !B || (low && (!A_low || !B_low))) {
+                perror("Memory allocation failed");
+                exit(EXIT_FAILURE);
+            }
+            init_vectors(&input, &mixed, A, B, A_low, B_low, vector_size, parallel_touch);
+            if (verify) {
+                dot_reference(A, B, vector_size, &ref);
+            }
         }
-        double t_end = omp_get_wtime();
-        double elapsed = t_end - t_start;
-        total_time += elapsed;
+        // Pass 0 is the timed mode; with --sum=repro, pass 1 times the fast path on the same data.
+        for (int pass = 0; pass < (repro ? 2 : 1); pass++) {
+            uint64_t t_start = bench_now_ns();
+            if (repro && pass == 0) {
+                dot_product = dot_repro(dot_kernel, A, B, vector_size, accs);
+            } else {
+                dot_product = 0.0;
+#pragma omp parallel reduction(+:dot_product)
+                {
+                    // Split the vector into one contiguous chunk per thread for the kernel.
+                    int tid = omp_get_thread_num();
+                    int nthreads = omp_get_num_threads();
+                    int chunk = vector_size / nthreads;
+                    int remainder = vector_size % nthreads;
+                    int start = tid * chunk + (tid < remainder ? tid : remainder);
+                    int len = chunk + (tid < remainder ? 1 : 0);
+                    if (low) {
+                        dot_product += mixed.dot(mixed_at(mixed.storage, A_low, start), mixed_at(mixed.storage, B_low, start), len);
+                    } else {
+                        dot_product += dot_kernel(A + start, B + start, len);
+                    }
+                }
+            }
+            bench_record(pass == 0 ? &bench : &fast, bench_now_ns() - t_start);
 
-        // Sequential verification
-        seq_dot = 0.0;
-        for (int i = 0; i < vector_size; i++) {
-            seq_dot += A[i] * B[i];
+            double u_store = mixed_store_error(&mixed), u_sum = mixed_sum_error(&mixed);
+            if (verify && !verify_check_mixed(dot_product, &ref, u_store, u_sum)) {
+                printf("Run %d: Error! Parallel = %.17g, Reference = %.17g (%.1f ulp, tolerance %.3g)\n", run+1, dot_product,
+                       verify_ref_value(&ref), verify_ulp_error(dot_product, verify_ref_value(&ref)),
+                       verify_tolerance_mixed(&ref, u_store, u_sum));
+            }
+            if (verify) {
+                error_relative = fabs(dot_product - verify_ref_value(&ref)) / fabs(verify_ref_value(&ref));
+                error_scaled = verify_scaled_error(dot_product, &ref);
+            }
+            if (repro && pass == 0) {
+                if (run == 0) {
+                    first_repro = dot_product;
+                } else if (dot_product != first_repro) {
+                    printf("Run %d: Error! Reproducible sum %.17g differs from run 1's %.17g\n", run+1, dot_product, first_repro);
+                }
+            }
         }
-        if (dot_product != seq_dot) {
-            printf("Run %d: Error! Parallel = %f, Sequential = %f\n", run+1, dot_product, seq_dot);
+        if (!reuse) {
+            free(A);
+            free(B);
+            free(A_low);
+            free(B_low);
         }
-        free(A);
-        free(B);
     }
-    double avg_time = total_time / num_runs;
+    // Record where each thread runs; with OMP_PROC_BIND set this matches the timed regions.
+    int *thread_cpu = (int*) calloc(num_threads, sizeof(int));
+    if (!thread_cpu) {
+        perror("Memory allocation failed");
+        exit(EXIT_FAILURE);
+    }
+#pragma omp parallel
+    thread_cpu[omp_get_thread_num()] = affinity_current_cpu();
+
     printf("OpenMP Dot Product Performance\n");
-    printf("Threads: %d, Vector Size: %d, Scaling: %s, Runs: %d\n", num_threads, vector_size, scaling, num_runs);
-    printf("Average Time (seconds): %f\n", avg_time);
+    const char *kernel_name = low ? mixed.isa : dot_kernel_name(kernel);
+    printf("Threads: %d, Vector Size: %d, Scaling: %s, Runs: %d, Kernel: %s\n", num_threads, vector_size, scaling, num_runs, kernel_name);
+    if (low) {
+        printf("Precision: %s storage, %s accumulation, %zu bytes per element\n", dtype_name(mixed.storage),
+               dtype_name(mixed.accum), dtype_bytes(mixed.storage));
+        if (verify) {
+            printf("Error vs fp64 reference: %.3g relative, %.3g of sum|a*b|\n", error_relative, error_scaled);
+        }
+    }
+    printf("Input: %s (seed %llu)\n", input_name(&input), (unsigned long long) input.seed);
+    if (repro) {
+        printf("Sum: repro (blocks of %d), result %.17g\n", REPRO_BLOCK, first_repro);
+    }
+    char binding[96], how[128];
+    affinity_omp_binding(binding, sizeof(binding));
+    snprintf(how, sizeof(how), "%s, first-touch=%s", binding, parallel_touch ? "parallel" : "serial");
+    affinity_report(how, num_threads, thread_cpu);
+    free(thread_cpu);
+    if (reuse) {
+        printf("Alloc: reuse (%s pages)\n", arena_pages_name(&arena));
+        arena_destroy(&arena);
+    } else {
+        printf("Alloc: cold\n");
+    }
+    char config[128];
+    snprintf(config, sizeof(config), "first-touch=%s sum=%s init=%s dtype=%s", parallel_touch ? "parallel" : "serial",
+             repro ? "repro" : "fast", input_name(&input), precision);
+    bench_info_t info = { .program = "perf_dot_product_omp", .scaling = scaling, .kernel = kernel_name,
+                          .config = config,
+                          .threads = num_threads, .procs = 1, .m = 1, .n = vector_size, .k = 1,
+                          .flops = 2.0 * vector_size, .bytes = 2.0 * vector_size * dtype_bytes(mixed.storage) };
+    bench_report(&bench, &info);
+    if (repro) {
+        bench_compare(&bench, &fast, "Reproducible sum vs fast path");
+    }
+    bench_finish(&bench);
+    bench_finish(&fast);
+    free(accs);
     return 0;
 }
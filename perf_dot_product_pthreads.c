@@ -8,52 +8,295 @@
 //   It accepts command-line arguments for number of threads, a base vector size, scaling mode (strong or weak),
 //   and number of runs. For strong scaling, the vector size remains constant;
 //   for weak scaling, the effective vector size = base_vector_size * num_threads.
-//   The code times only the parallel portion (from thread creation to join) using gettimeofday(),
-//   repeats the measurement for multiple runs, and reports the average runtime.
+//   The code times only the parallel portion (from thread creation to join) with the shared harness
+//   (see bench.h): warm-up runs are dropped and min/median/p90/max/stddev, GFLOP/s and GB/s are
+//   reported, optionally as JSON/CSV records.
+//   Each thread runs the shared dot product kernel (see dot_kernels.h), selected with --kernel.
+//   --dispatch=pool (default) creates the threads once before the first run and wakes them for each
+//   run (see thread_pool.h), so the timed region holds only the kernel and the reduction.
+//   --dispatch=spawn keeps the original pthread_create/pthread_join per run for comparison.
+//   --reduce picks how the partial sums are combined (see reduce.h): the original mutex,
+//   a CAS loop on a shared double, padded per-thread slots, or a tree over the slots (default).
+//   --pin pins each worker with pthread_setaffinity_np (see affinity.h), and --first-touch=parallel
+//   has every worker initialize the chunk it later reads, so on NUMA machines the pages land on
+//   the reader's node instead of all on the main thread's node. The CPU and node each thread
+//   actually ran on are printed after the runs.
+//   --alloc=reuse (default) allocates and initializes A and B once from a huge-page arena
+//   (see arena.h) and times every run on the same warm data; --alloc=cold mallocs,
+//   initializes and frees them in every run as the original program did.
+//   A and B come from the seeded generators in input.h (--init=ones|uniform|normal|ill|sparse,
+//   --seed=S; uniform by default), generated by the pool over the kernel's chunks.
+//   Results are checked against a compensated reference with an n-scaled tolerance (see verify.h),
+//   computed by the pool whenever the data is initialized; --no-verify skips it.
+//   --sum=repro makes the result bit-for-bit independent of the thread count, dispatch and --reduce
+//   (see repro.h): each thread takes whole fixed-size blocks and adds their kernel partials into its
+//   own exact accumulator, which the main thread merges. Each run then also times the fast path
+//   (--reduce) right after, and the overhead of the reproducible sum is printed.
+//   --dtype=fp32|bf16|fp16 stores A and B in a narrower format and runs the mixed-precision kernels
+//   (see mixed.h), summing in fp64 or, with --accum=fp32, in fp32. The fp64 data is generated as
+//   before and kept for the reference; each worker rounds its chunk into the packed copies, and the
+//   error of the result against the fp64 reference is printed.
+//   --schedule picks how the elements are handed to the threads (see schedule.h): static (default)
+//   is one contiguous chunk per thread as before; dynamic:C, guided:C and steal:C hand out chunks of
+//   C elements (C blocks of REPRO_BLOCK with --sum=repro, whose result stays the same for any
+//   schedule), so faster cores take more of the vector. Every thread's busy time per run is printed.
 //
 // Usage:
-//   gcc perf_dot_product_pthreads.c -o perf_dot_product_pthreads -lpthread
+//   gcc -O2 perf_dot_product_pthreads.c dot_kernels.c thread_pool.c reduce.c affinity.c arena.c bench.c verify.c repro.c input.c mixed.c schedule.c -o perf_dot_product_pthreads -lpthread -lm
 //   ./perf_dot_product_pthreads <num_threads> <base_vector_size> <strong|weak> [num_runs]
+//                               [--kernel=auto|scalar|sse|avx2|avx512] [--dispatch=pool|spawn]
+//                               [--reduce=mutex|atomic|slots|tree] [--pin=none|compact|spread]
+//                               [--first-touch=serial|parallel] [--alloc=reuse|cold]
+//                               [--sum=fast|repro] [--init=ones|uniform|normal|ill|sparse] [--seed=S]
+//                               [--dtype=fp64|fp32|bf16|fp16] [--accum=fp64|fp32]
+//                               [--schedule=static|dynamic|guided|steal[:C]] [--warmup=N] [--format=text|json|csv] [--output=FILE] [--no-verify]
 //
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <math.h>
 #include <pthread.h>
-#include <sys/time.h>
+#include "dot_kernels.h"
+#include "thread_pool.h"
+#include "reduce.h"
+#include "affinity.h"
+#include "arena.h"
+#include "bench.h"
+#include "verify.h"
+#include "repro.h"
+#include "input.h"
+#include "mixed.h"
+#include "schedule.h"
 
 #define DEFAULT_NUM_RUNS 5
 
 double *A, *B;      // Vectors (allocated dynamically)
 double dot_product; // Global dot product result
-pthread_mutex_t mutex;
+reducer_t reducer;  // Combines the per-thread partial sums
+dot_kernel_fn dot_kernel; // Kernel selected with --kernel
+pin_policy_t pin_policy;  // Thread pinning selected with --pin
+int *thread_cpu;          // CPU each thread last ran its chunk on
+verify_ref_t *ref_parts;  // Per-thread chunks of the verification reference
+int use_repro;            // The current run uses the reproducible sum (--sum=repro)
+repro_acc_t *repro_accs;  // Per-thread exact accumulators for the reproducible sum
+input_t input;            // Data generator selected with --init and --seed
+mixed_t mixed;            // Storage and accumulation formats selected with --dtype and --accum
+void *A_low, *B_low;      // A and B packed to the --dtype format when it is narrower than fp64
+sched_t sched;            // Hands out the elements (--schedule), or blocks with --sum=repro
+sched_t fast_sched;       // The same for the fast path timed after each reproducible sum
+sched_t *run_sched;       // The one the current run uses
 
 typedef struct {
-    int start;
-    int end;
+    int tid;
+    int nthreads;
+    int n;  // Vector size
 } ThreadData;
 
+// Helper: the contiguous chunk [start, end) of n elements owned by thread tid
+void thread_range(int n, int tid, int nthreads, int *start, int *end) {
+    int chunk = n / nthreads;
+    int remainder = n % nthreads;
+    *start = tid * chunk + (tid < remainder ? tid : remainder);
+    *end = *start + chunk + (tid < remainder ? 1 : 0);
+}
+
+// Partial dot product of elements [start, end): the fp64 kernel, or the mixed-precision one on the packed copies
+double chunk_dot(int start, int end) {
+    if (mixed_reduced(&mixed)) {
+        return mixed.dot(mixed_at(mixed.storage, A_low, start), mixed_at(mixed.storage, B_low, start), end - start);
+    }
+    return dot_kernel(A + start, B + start, end - start);
+}
+
+// Thread tid's share of a run over n elements: the chunks run_sched gives it, summed into its
+// partial, or with --sum=repro added block by block into its exact accumulator.
+void sum_chunks(int tid, int n) {
+    thread_cpu[tid] = affinity_current_cpu();
+    long begin, end;
+    if (use_repro) {
+        repro_init(&repro_accs[tid]);
+        while (sched_next(run_sched, tid, &begin, &end)) {
+            long start = begin * REPRO_BLOCK;
+            long stop = (end * REPRO_BLOCK < n) ? end * REPRO_BLOCK : n;
+            repro_dot(&repro_accs[tid], dot_kernel, A + start, B + start, stop - start);
+        }
+        return;
+    }
+    double partial = 0.0;
+    while (sched_next(run_sched, tid, &begin, &end)) {
+        partial += chunk_dot((int) begin, (int) end);
+    }
+    reducer_contribute(&reducer, tid, partial);
+}
+
 // Thread function: computes partial dot product
 void* dot_product_thread(void* arg) {
     ThreadData *data = (ThreadData*) arg;
-    double partial = 0.0;
-    for (int i = data->start; i < data->end; i++) {
-        partial += A[i] * B[i];
+    if (pin_policy != PIN_NONE) {
+        affinity_pin_self(affinity_cpu_for(data->tid, data->nthreads, pin_policy));
     }
-    pthread_mutex_lock(&mutex);
-    dot_product += partial;
-    pthread_mutex_unlock(&mutex);
+    sum_chunks(data->tid, data->n);
     free(data);
     return NULL;
 }
 
-// Helper: compute elapsed time in seconds between two timevals
-double get_elapsed(struct timeval start, struct timeval end) {
-    return (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1000000.0;
+// Pool task: thread tid computes its chunks of the vectors; arg points at the vector size.
+void dot_product_task(int tid, int nthreads, void *arg) {
+    (void) nthreads;
+    sum_chunks(tid, *(int*) arg);
+}
+
+// Pool task: pin the calling worker according to --pin.
+void pin_task(int tid, int nthreads, void *arg) {
+    (void) arg;
+    affinity_pin_self(affinity_cpu_for(tid, nthreads, pin_policy));
+}
+
+// Pool task: generate the chunk of A and B that this thread will later read, and pack it for --dtype.
+void init_task(int tid, int nthreads, void *arg) {
+    int start, end;
+    thread_range(*(int*) arg, tid, nthreads, &start, &end);
+    input_fill(&input, INPUT_A, 0, start, A + start, 1, end - start);
+    input_fill(&input, INPUT_B, 0, start, B + start, 1, end - start);
+    if (mixed_reduced(&mixed)) {
+        mixed_pack(mixed.storage, A + start, mixed_at(mixed.storage, A_low, start), end - start);
+        mixed_pack(mixed.storage, B + start, mixed_at(mixed.storage, B_low, start), end - start);
+    }
+}
+
+// Pool task: compensated reference for this thread's chunk.
+void reference_task(int tid, int nthreads, void *arg) {
+    int start, end;
+    thread_range(*(int*) arg, tid, nthreads, &start, &end);
+    verify_dot_ref(A + start, B + start, 1, end - start, &ref_parts[tid]);
+}
+
+// Reference for A.B: chunks computed by the pool, merged in thread order.
+void dot_reference(thread_pool_t *pool, int vector_size, verify_ref_t *ref) {
+    pool_run(pool, reference_task, &vector_size);
+    verify_ref_t total = {0};
+    for (int t = 0; t < pool_size(pool); t++) {
+        verify_ref_merge(&total, &ref_parts[t]);
+    }
+    *ref = total;
+}
+
+// Generate A and B through the pool. With parallel_touch that is each worker's first touch of its
+// chunk; otherwise the main thread zeroes both vectors first, so every page is placed on its node.
+void init_vectors(thread_pool_t *pool, int vector_size, int parallel_touch) {
+    if (!parallel_touch) {
+        memset(A, 0, (size_t) vector_size * sizeof(double));
+        memset(B, 0, (size_t) vector_size * sizeof(double));
+        if (mixed_reduced(&mixed)) {
+            memset(A_low, 0, (size_t) vector_size * dtype_bytes(mixed.storage));
+            memset(B_low, 0, (size_t) vector_size * dtype_bytes(mixed.storage));
+        }
+    }
+    pool_run(pool, init_task, &vector_size);
 }
 
 int main(int argc, char *argv[]) {
+    dot_kernel_t kernel = DOT_KERNEL_AUTO;
+    int use_pool = 1;
+    reduce_mode_t reduce_mode = REDUCE_TREE;
+    int parallel_touch = 0;
+    int reuse = 1;  // --alloc=reuse
+    int verify = 1;
+    int repro = 0;  // --sum=fast
+    bench_t bench;
+    bench_defaults(&bench);
+    input_defaults(&input);
+    mixed_defaults(&mixed);
+    sched_opts_t schedule;
+    sched_defaults(&schedule);
+    pin_policy = PIN_NONE;
+    affinity_init();
+    // Pull --option=value flags out of argv so the positional arguments keep their places.
+    int nargs = 1, rc;
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--kernel=", 9) == 0) {
+            if (dot_kernel_parse(argv[i] + 9, &kernel) != 0) {
+                printf("Unknown kernel: %s\n", argv[i] + 9);
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--dispatch=", 11) == 0) {
+            if (strcmp(argv[i] + 11, "pool") == 0) {
+                use_pool = 1;
+            } else if (strcmp(argv[i] + 11, "spawn") == 0) {
+                use_pool = 0;
+            } else {
+                printf("Unknown dispatch mode: %s\n", argv[i] + 11);
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--reduce=", 9) == 0) {
+            if (reduce_mode_parse(argv[i] + 9, &reduce_mode) != 0) {
+                printf("Unknown reduction: %s\n", argv[i] + 9);
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--pin=", 6) == 0) {
+            if (pin_policy_parse(argv[i] + 6, &pin_policy) != 0) {
+                printf("Unknown pinning policy: %s\n", argv[i] + 6);
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--first-touch=", 14) == 0) {
+            if (strcmp(argv[i] + 14, "serial") == 0) {
+                parallel_touch = 0;
+            } else if (strcmp(argv[i] + 14, "parallel") == 0) {
+                parallel_touch = 1;
+            } else {
+                printf("Unknown first-touch mode: %s\n", argv[i] + 14);
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--alloc=", 8) == 0) {
+            if (strcmp(argv[i] + 8, "reuse") == 0) {
+                reuse = 1;
+            } else if (strcmp(argv[i] + 8, "cold") == 0) {
+                reuse = 0;
+            } else {
+                printf("Unknown allocation mode: %s\n", argv[i] + 8);
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--sum=", 6) == 0) {
+            if (strcmp(argv[i] + 6, "fast") == 0) {
+                repro = 0;
+            } else if (strcmp(argv[i] + 6, "repro") == 0) {
+                repro = 1;
+            } else {
+                printf("Unknown summation mode: %s\n", argv[i] + 6);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--no-verify") == 0) {
+            verify = 0;
+        } else if ((rc = bench_parse_arg(&bench, argv[i])) != 0 || (rc = input_parse_arg(&input, argv[i])) != 0 ||
+                   (rc = mixed_parse_arg(&mixed, argv[i])) != 0 || (rc = sched_parse_arg(&schedule, argv[i])) != 0) {
+            if (rc < 0) {
+                printf("Invalid option: %s\n", argv[i]);
+                return 1;
+            }
+        } else {
+            argv[nargs++] = argv[i];
+        }
+    }
+    argc = nargs;
     if (argc < 4) {
-        printf("Usage: %s <num_threads> <base_vector_size> <strong|weak> [num_runs]\n", argv[0]);
+        printf("Usage: %s <num_threads> <base_vector_size> <strong|weak> [num_runs] [--kernel=auto|scalar|sse|avx2|avx512] [--dispatch=pool|spawn] [--reduce=mutex|atomic|slots|tree] [--pin=none|compact|spread] [--first-touch=serial|parallel] [--alloc=reuse|cold] [--sum=fast|repro] [--init=ones|uniform|normal|ill|sparse] [--seed=S] [--dtype=fp64|fp32|bf16|fp16] [--accum=fp64|fp32] [--schedule=static|dynamic|guided|steal[:C]] [--warmup=N] [--format=text|json|csv] [--output=FILE] [--no-verify]\n", argv[0]);
+        return 1;
+    }
+    char precision[16];
+    mixed_name(&mixed, precision, sizeof(precision));
+    if (mixed_init(&mixed, kernel) != 0) {
+        printf("Precision %s is not available with kernel %s\n", precision, dot_kernel_name(kernel));
+        return 1;
+    }
+    int low = mixed_reduced(&mixed);
+    if (low && repro) {
+        printf("--sum=repro requires --dtype=fp64\n");
+        return 1;
+    }
+    kernel = dot_kernel_resolve(kernel);
+    dot_kernel = dot_kernel_get(kernel);
+    if (!dot_kernel) {
+        printf("Kernel %s is not supported on this CPU\n", dot_kernel_name(kernel));
         return 1;
     }
     int num_threads = atoi(argv[1]);
@@ -62,61 +305,180 @@ int main(int argc, char *argv[]) {
     int num_runs = (argc >= 5) ? atoi(argv[4]) : DEFAULT_NUM_RUNS;
     int vector_size = (strcmp(scaling, "weak") == 0) ? base_size * num_threads : base_size;
 
-    double total_time = 0.0;
-    double seq_dot;
+    verify_ref_t ref;
+    size_t low_bytes = low ? (size_t) vector_size * dtype_bytes(mixed.storage) : 0;
+    double error_relative = 0.0, error_scaled = 0.0;  // Of the last checked result.
+    double first_repro = 0.0;  // The reproducible result of the first run; every later run must match it.
+    bench_t fast;  // The fast path, timed in each run alongside the reproducible sum.
+    bench_defaults(&fast);
+    fast.warmup = bench.warmup;
+
+    thread_cpu = (int*) calloc(num_threads, sizeof(int));
+    ref_parts = (verify_ref_t*) calloc(num_threads, sizeof(verify_ref_t));
+    repro_accs = (repro_acc_t*) calloc(num_threads, sizeof(repro_acc_t));
+    if (!thread_cpu || !ref_parts || !repro_accs || reducer_init(&reducer, reduce_mode, num_threads) != 0 ||
+        bench_start(&bench, num_runs) != 0 || bench_start(&fast, num_runs) != 0 ||
+        sched_init(&sched, &schedule, num_threads) != 0 || sched_init(&fast_sched, &schedule, num_threads) != 0) {
+        perror("Memory allocation failed");
+        exit(EXIT_FAILURE);
+    }
+
+    // The pool is started (and pinned) once, outside every timed region. With --dispatch=spawn a
+    // pool is still used for data generation and verification; its pinning matches the spawned threads'.
+    thread_pool_t *pool = pool_create(num_threads);
+    if (!pool) {
+        perror("Thread pool creation failed");
+        exit(EXIT_FAILURE);
+    }
+    if (pin_policy != PIN_NONE) {
+        pool_run(pool, pin_task, NULL);
+    }
 
-    for (int run = 0; run < num_runs; run++) {
-        // Allocate and initialize vectors with 1.0
-        A = (double*) malloc(vector_size * sizeof(double));
-        B = (double*) malloc(vector_size * sizeof(double));
-        if (!A || !B) {
+    arena_t arena = {0};
+    if (reuse) {
+        // Allocate and warm A and B once (after pinning, so first touch lands on the right node).
+        size_t bytes = (size_t) vector_size * sizeof(double);
+        if (arena_init(&arena, 2 * bytes + 2 * low_bytes + 256) != 0 ||
+            !(A = (double*) arena_alloc(&arena, bytes, 64)) ||
+            !(B = (double*) arena_alloc(&arena, bytes, 64)) ||
+            (low && (!(A_low = arena_alloc(&arena, low_bytes, 64)) || !(B_low = arena_alloc(&arena, low_bytes, 64))))) {
             perror("Memory allocation failed");
             exit(EXIT_FAILURE);
         }
-        for (int i = 0; i < vector_size; i++) {
-            A[i] = 1.0;
-            B[i] = 1.0;
-        }
-        dot_product = 0.0;
-        pthread_mutex_init(&mutex, NULL);
-        pthread_t threads[num_threads];
-        int chunk = vector_size / num_threads;
-        int remainder = vector_size % num_threads;
-        int start = 0;
-
-        struct timeval t_start, t_end;
-        gettimeofday(&t_start, NULL);
-        // Create threads
-        for (int t = 0; t < num_threads; t++) {
-            ThreadData *data = (ThreadData*) malloc(sizeof(ThreadData));
-            data->start = start;
-            data->end = start + chunk + (t < remainder ? 1 : 0);
-            pthread_create(&threads[t], NULL, dot_product_thread, data);
-            start = data->end;
+        init_vectors(pool, vector_size, parallel_touch);
+        if (verify) {
+            dot_reference(pool, vector_size, &ref);
         }
-        // Join threads
-        for (int t = 0; t < num_threads; t++) {
-            pthread_join(threads[t], NULL);
+    }
+
+    for (int run = 0; run < bench_total_runs(&bench); run++) {
+        if (!reuse) {
+            // Allocate and generate the vectors
+            A = (double*) malloc(vector_size * sizeof(double));
+            B = (double*) malloc(vector_size * sizeof(double));
+            if (low) {
+                A_low = malloc(low_bytes);
+                B_low = malloc(low_bytes);
+            }
+            if (!A || !B || (low && (!A_low || !B_low))) {
+                perror("Memory allocation failed");
+                exit(EXIT_FAILURE);
+            }
+            init_vectors(pool, vector_size, parallel_touch);
+            if (verify) {
+                dot_reference(pool, vector_size, &ref);
+            }
         }
-        gettimeofday(&t_end, NULL);
-        double elapsed = get_elapsed(t_start, t_end);
-        total_time += elapsed;
-
-        // Sequential computation for correctness
-        seq_dot = 0.0;
-        for (int i = 0; i < vector_size; i++) {
-            seq_dot += A[i] * B[i];
+        // Pass 0 is the timed mode; with --sum=repro, pass 1 times the fast path on the same data.
+        for (int pass = 0; pass < (repro ? 2 : 1); pass++) {
+            use_repro = repro && pass == 0;
+            reducer_reset(&reducer);
+            pthread_t threads[num_threads];
+            run_sched = (pass == 0) ? &sched : &fast_sched;
+            if (run == bench.warmup) {
+                sched_clear(run_sched);  // Busy times of the kept runs only.
+            }
+
+            uint64_t t_start = bench_now_ns();
+            sched_start(run_sched, use_repro ? (vector_size + REPRO_BLOCK - 1) / REPRO_BLOCK : vector_size, num_threads);
+            if (use_pool) {
+                pool_run(pool, dot_product_task, &vector_size);
+            } else {
+                // Create threads
+                for (int t = 0; t < num_threads; t++) {
+                    ThreadData *data = (ThreadData*) malloc(sizeof(ThreadData));
+                    data->tid = t;
+                    data->nthreads = num_threads;
+                    data->n = vector_size;
+                    pthread_create(&threads[t], NULL, dot_product_thread, data);
+                }
+                // Join threads
+                for (int t = 0; t < num_threads; t++) {
+                    pthread_join(threads[t], NULL);
+                }
+            }
+            if (use_repro) {
+                repro_acc_t total;
+                repro_init(&total);
+                for (int t = 0; t < num_threads; t++) {
+                    repro_merge(&total, &repro_accs[t]);
+                }
+                dot_product = repro_result(&total);
+            } else {
+                dot_product = reducer_result(&reducer);
+            }
+            bench_record(pass == 0 ? &bench : &fast, bench_now_ns() - t_start);
+
+            double u_store = mixed_store_error(&mixed), u_sum = mixed_sum_error(&mixed);
+            if (verify && !verify_check_mixed(dot_product, &ref, u_store, u_sum)) {
+                printf("Run %d: Error! Parallel = %.17g, Reference = %.17g (%.1f ulp, tolerance %.3g)\n", run+1, dot_product,
+                       verify_ref_value(&ref), verify_ulp_error(dot_product, verify_ref_value(&ref)),
+                       verify_tolerance_mixed(&ref, u_store, u_sum));
+            }
+            if (verify) {
+                error_relative = fabs(dot_product - verify_ref_value(&ref)) / fabs(verify_ref_value(&ref));
+                error_scaled = verify_scaled_error(dot_product, &ref);
+            }
+            if (use_repro) {
+                if (run == 0) {
+                    first_repro = dot_product;
+                } else if (dot_product != first_repro) {
+                    printf("Run %d: Error! Reproducible sum %.17g differs from run 1's %.17g\n", run+1, dot_product, first_repro);
+                }
+            }
         }
-        if (dot_product != seq_dot) {
-            printf("Run %d: Error! Parallel = %f, Sequential = %f\n", run+1, dot_product, seq_dot);
+        if (!reuse) {
+            free(A);
+            free(B);
+            free(A_low);
+            free(B_low);
         }
-        free(A);
-        free(B);
-        pthread_mutex_destroy(&mutex);
     }
-    double avg_time = total_time / num_runs;
+    pool_destroy(pool);
+    reducer_destroy(&reducer);
     printf("Pthreads Dot Product Performance\n");
-    printf("Threads: %d, Vector Size: %d, Scaling: %s, Runs: %d\n", num_threads, vector_size, scaling, num_runs);
-    printf("Average Time (seconds): %f\n", avg_time);
+    const char *kernel_name = low ? mixed.isa : dot_kernel_name(kernel);
+    printf("Threads: %d, Vector Size: %d, Scaling: %s, Runs: %d, Kernel: %s, Dispatch: %s, Reduce: %s\n", num_threads, vector_size, scaling, num_runs,
+           kernel_name, use_pool ? "pool" : "spawn", reduce_mode_name(reduce_mode));
+    if (low) {
+        printf("Precision: %s storage, %s accumulation, %zu bytes per element\n", dtype_name(mixed.storage),
+               dtype_name(mixed.accum), dtype_bytes(mixed.storage));
+        if (verify) {
+            printf("Error vs fp64 reference: %.3g relative, %.3g of sum|a*b|\n", error_relative, error_scaled);
+        }
+    }
+    printf("Input: %s (seed %llu)\n", input_name(&input), (unsigned long long) input.seed);
+    if (repro) {
+        printf("Sum: repro (blocks of %d), result %.17g\n", REPRO_BLOCK, first_repro);
+    }
+    char how[64];
+    snprintf(how, sizeof(how), "pin=%s, first-touch=%s", pin_policy_name(pin_policy), parallel_touch ? "parallel" : "serial");
+    affinity_report(how, num_threads, thread_cpu);
+    sched_report(&sched, repro ? "blocks" : "elements", num_runs);
+    sched_destroy(&sched);
+    sched_destroy(&fast_sched);
+    if (reuse) {
+        printf("Alloc: reuse (%s pages)\n", arena_pages_name(&arena));
+        arena_destroy(&arena);
+    } else {
+        printf("Alloc: cold\n");
+    }
+    char config[160], sched_label[32];
+    sched_name(&schedule, sched_label, sizeof(sched_label));
+    snprintf(config, sizeof(config), "dispatch=%s reduce=%s pin=%s first-touch=%s sum=%s init=%s dtype=%s schedule=%s",
+             use_pool ? "pool" : "spawn", reduce_mode_name(reduce_mode), pin_policy_name(pin_policy),
+             parallel_touch ? "parallel" : "serial", repro ? "repro" : "fast", input_name(&input), precision, sched_label);
+    bench_info_t info = { .program = "perf_dot_product_pthreads", .scaling = scaling, .kernel = kernel_name,
+                          .config = config, .threads = num_threads, .procs = 1, .m = 1, .n = vector_size, .k = 1,
+                          .flops = 2.0 * vector_size, .bytes = 2.0 * vector_size * dtype_bytes(mixed.storage) };
+    bench_report(&bench, &info);
+    if (repro) {
+        bench_compare(&bench, &fast, "Reproducible sum vs fast path");
+    }
+    bench_finish(&bench);
+    bench_finish(&fast);
+    free(thread_cpu);
+    free(ref_parts);
+    free(repro_accs);
     return 0;
 }
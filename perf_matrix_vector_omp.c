@@ -9,22 +9,583 @@
 //   a scaling mode (strong or weak), and the number of runs.
 //   For strong scaling, the matrix size remains constant;
 //   for weak scaling, the number of rows is scaled: M_effective = base_M * num_threads.
-//   The program times the parallel region using omp_get_wtime(), runs several iterations, and then outputs
-//   the average execution time.
+//   The program times the parallel region with the shared harness (see bench.h), runs several iterations
+//   after the warm-up runs, and outputs min/median/p90/max/stddev, GFLOP/s and GB/s, optionally as
+//   JSON/CSV records.
+//   --layout selects how A is stored: "rowptr" is the original array of separately malloc'd rows,
+//   "flat" (default) is the contiguous, aligned Matrix from matrix.h, and "csr" and "sell" hold a
+//   generated sparse matrix (see sparse.h; --sparse=banded:W|powerlaw:D picks the pattern and
+//   --sigma=S the SELL sorting window). The sparse kernels give each thread a contiguous share of the
+//   rows (slices for SELL) with about the same number of nonzeros, or of rows with --balance=rows;
+//   the same split generates the matrix, so each thread first-touches what it multiplies. Sparse
+//   layouts multiply one vector (--batch=1), and the flop and byte counts are the nonzeros'.
+//   --kernel selects the loop: "naive" is one row at a time, "blocked" is the register-blocked
+//   multi-row kernel from gemv_kernels.h (flat layout only), tiled from the cache sizes.
+//   --batch=K multiplies A by K vectors at once. The naive kernel makes K passes over A;
+//   the blocked kernel makes one cache-blocked pass, and the traffic model counts that.
+//   --first-touch=parallel has each thread initialize the rows of A it later reads, so on NUMA
+//   machines those pages are placed on its node. Threads are bound with OMP_PLACES/OMP_PROC_BIND
+//   and the placement actually seen is printed.
+//   --alloc=reuse (default) allocates and initializes all data once from a huge-page arena
+//   (see arena.h) and reuses it for every run; --alloc=cold mallocs, initializes and frees
+//   the data in every run as the original program did.
+//   A and B come from the seeded generators in input.h (--init=ones|uniform|normal|ill|sparse,
+//   --seed=S; uniform by default), generated in parallel by the threads that read them.
+//   --matrix=FILE multiplies a matrix stored in the binary format of matfile.h instead, mapped
+//   zero-copy with mmap (flat layout; the dimensions come from the file and the positional M and N
+//   are ignored), and --vector=FILE loads B from an N x K file of the same format (K = its columns).
+//   --save-matrix=FILE and --save-vector=FILE write the generated A and B in that format.
+//   --stream=R multiplies the mapped matrix out of core in panels of R rows: readahead is started
+//   on the next panel while one is computed, and each finished panel is dropped from memory and
+//   from the page cache, so matrices larger than RAM run at storage bandwidth and every run reads
+//   the file again. The check reads the file once more outside the timed region (--no-verify
+//   avoids that for huge files).
+//   Every result is checked in parallel against a compensated reference with an n-scaled tolerance
+//   (see verify.h), outside the timed region; --no-verify skips it.
+//   --dtype=fp32|bf16|fp16 stores A and B in a narrower format for the blocked kernel (see mixed.h),
+//   summing in fp64 or, with --accum=fp32, in fp32; it needs a generated flat matrix and --batch=1.
+//   A and B are generated in fp64 as before and kept for the reference, each thread rounds its rows
+//   into the packed copy, and the largest row error and the 2-norm error of P against the fp64
+//   reference are printed.
+//   --schedule picks how rows (slices for SELL) are handed to the threads (see schedule.h): static
+//   (default) keeps the contiguous share per thread, and for the sparse layouts the nonzero-balanced
+//   parts; dynamic:C and guided:C claim chunks from a shared counter, and steal:C starts from the
+//   static shares and lets idle threads steal chunks from busy ones. Every thread's busy time per
+//   run is printed, so the imbalance the schedule leaves shows.
 // Usage:
-//   gcc -fopenmp perf_matrix_vector_omp.c -o perf_matrix_vector_omp
+//   gcc -O2 -fopenmp perf_matrix_vector_omp.c matrix.c gemv_kernels.c dot_kernels.c affinity.c arena.c bench.c verify.c input.c matfile.c sparse.c mixed.c schedule.c -o perf_matrix_vector_omp -lm
 //   ./perf_matrix_vector_omp <num_threads> <base_M> <base_N> <strong|weak> [num_runs]
+//                            [--layout=rowptr|flat|csr|sell] [--sparse=banded:W|powerlaw:D] [--sigma=S]
+//                            [--balance=nnz|rows] [--kernel=naive|blocked] [--batch=K]
+//                            [--first-touch=serial|parallel] [--alloc=reuse|cold]
+//                            [--init=ones|uniform|normal|ill|sparse] [--seed=S] [--dtype=fp64|fp32|bf16|fp16]
+//                            [--accum=fp64|fp32] [--schedule=static|dynamic|guided|steal[:C]]
+//                            [--matrix=FILE] [--vector=FILE]
+//                            [--stream=R] [--save-matrix=FILE] [--save-vector=FILE]
+//                            [--warmup=N] [--format=text|json|csv] [--output=FILE] [--no-verify]
 //
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
+#include <math.h>
 #include <omp.h>
+#include "matrix.h"
+#include "gemv_kernels.h"
+#include "affinity.h"
+#include "arena.h"
+#include "bench.h"
+#include "verify.h"
+#include "input.h"
+#include "matfile.h"
+#include "sparse.h"
+#include "mixed.h"
+#include "schedule.h"
 
 #define DEFAULT_NUM_RUNS 5
 
+typedef enum { LAYOUT_ROWPTR, LAYOUT_FLAT, LAYOUT_CSR, LAYOUT_SELL } layout_t;
+
+static const char *layout_names[] = { "rowptr", "flat", "csr", "sell" };
+typedef enum { KERNEL_NAIVE, KERNEL_BLOCKED } kernel_t;
+
+// Everything one run needs. With --alloc=reuse it is carved from an arena once;
+// with --alloc=cold it is malloc'd and freed around every run.
+typedef struct {
+    int M, N, K;
+    layout_t layout;
+    kernel_t kernel;
+    double **A_rows;  // LAYOUT_ROWPTR: one allocation per row.
+    Matrix A_flat;    // LAYOUT_FLAT: contiguous, padded rows.
+    double *B;        // The K vectors: N x K for the blocked kernel, K x N for the naive loop.
+    double *P;        // M x K results.
+    long b_row;       // Stride between B[j][k] and B[j+1][k].
+    long b_vec;       // Stride between B[j][k] and B[j][k+1].
+    const matfile_t *matrix;  // --matrix: A is this file's mapping, or NULL.
+    const matfile_t *vector;  // --vector: B is read from this file, or NULL.
+    const sparse_opts_t *sparse;  // LAYOUT_CSR, LAYOUT_SELL: how A is generated, else NULL.
+    csr_t csr;        // LAYOUT_CSR, and the source of LAYOUT_SELL.
+    sell_t sell;      // LAYOUT_SELL.
+    int parts;        // Sparse layouts: one part per thread,
+    int *bounds;      // covering rows (CSR) or slices (SELL) [bounds[t], bounds[t + 1]).
+    const mixed_t *mixed;  // Storage format; when narrower than fp64 the kernel reads
+    void *A_low, *B_low;   // these packed copies of A_flat (same ld) and B.
+    sched_t *sched;   // Hands out the rows (slices for SELL, parts for static sparse) of every multiply.
+} Problem;
+
+// Row i of A in whichever layout is active (used outside the timed region).
+static double* get_row(const Problem *p, int i) {
+    return (p->layout == LAYOUT_ROWPTR) ? p->A_rows[i] : matrix_row(&p->A_flat, i);
+}
+
+static void* alloc_bytes(arena_t *arena, size_t bytes) {
+    return arena ? arena_alloc(arena, bytes, MATRIX_ALIGNMENT) : malloc(bytes);
+}
+
+// Arena bytes needed for the whole problem, with slack for aligning every allocation.
+static size_t problem_bytes(const Problem *p) {
+    // Sparse storage is sized by the generator and malloc'd (see problem_alloc).
+    size_t a_bytes = (p->matrix || p->sparse) ? 0
+        : (p->layout == LAYOUT_ROWPTR) ? (size_t) p->M * (sizeof(double*) + (size_t) p->N * sizeof(double) + MATRIX_ALIGNMENT)
+        : matrix_bytes(p->M, p->N);
+    size_t vec_bytes = ((size_t) p->N * p->K + (size_t) p->M * p->K) * sizeof(double);
+    size_t low_bytes = mixed_reduced(p->mixed)
+        ? (matrix_bytes(p->M, p->N) / sizeof(double) + (size_t) p->N) * dtype_bytes(p->mixed->storage) : 0;
+    return a_bytes + vec_bytes + low_bytes + 8 * MATRIX_ALIGNMENT;
+}
+
+// Allocate A, B and P from the arena, or with malloc when arena is NULL (a sparse A always uses
+// malloc: its size depends on the generated rows). Returns 0 on success, -1 if any allocation fails.
+static int problem_alloc(Problem *p, arena_t *arena, const input_t *input) {
+    int failed = 0;
+    if (p->sparse) {
+        failed = csr_alloc(&p->csr, p->sparse, input, p->M, p->N, 0, p->M) != 0 ||
+                 (p->layout == LAYOUT_SELL && sell_alloc(&p->sell, &p->csr, p->sparse->sigma) != 0);
+        p->bounds = (int*) malloc((p->parts + 1) * sizeof(int));
+        failed = failed || !p->bounds;
+        if (!failed && p->layout == LAYOUT_SELL) {
+            sparse_partition(p->sell.slice_ptr, p->sell.slices, p->parts, p->sparse->balance_nnz, p->bounds);
+        } else if (!failed) {
+            sparse_partition(p->csr.row_ptr, p->M, p->parts, p->sparse->balance_nnz, p->bounds);
+        }
+    } else if (p->matrix) {
+        matfile_view(p->matrix, &p->A_flat);
+    } else if (p->layout == LAYOUT_ROWPTR) {
+        p->A_rows = (double**) alloc_bytes(arena, p->M * sizeof(double*));
+        failed = (p->A_rows == NULL);
+        for (int i = 0; !failed && i < p->M; i++) {
+            p->A_rows[i] = (double*) alloc_bytes(arena, p->N * sizeof(double));
+            failed = (p->A_rows[i] == NULL);
+        }
+    } else if (arena) {
+        double *storage = (double*) arena_alloc(arena, matrix_bytes(p->M, p->N), MATRIX_ALIGNMENT);
+        failed = (storage == NULL);
+        if (!failed) {
+            matrix_wrap(&p->A_flat, p->M, p->N, storage);
+        }
+    } else {
+        failed = matrix_alloc(&p->A_flat, p->M, p->N);
+    }
+    p->B = (double*) alloc_bytes(arena, (size_t) p->N * p->K * sizeof(double));
+    p->P = (double*) alloc_bytes(arena, (size_t) p->M * p->K * sizeof(double));
+    if (!failed && mixed_reduced(p->mixed)) {
+        p->A_low = alloc_bytes(arena, (size_t) p->M * p->A_flat.ld * dtype_bytes(p->mixed->storage));
+        p->B_low = alloc_bytes(arena, (size_t) p->N * dtype_bytes(p->mixed->storage));
+        failed = !p->A_low || !p->B_low;
+    }
+    return (failed || !p->B || !p->P) ? -1 : 0;
+}
+
+// Free a problem allocated with malloc (arena problems go away with the arena).
+static void problem_free(Problem *p) {
+    if (p->sparse) {
+        csr_free(&p->csr);
+        sell_free(&p->sell);
+        free(p->bounds);
+    } else if (p->matrix) {
+        // The mapping outlives the runs.
+    } else if (p->layout == LAYOUT_ROWPTR) {
+        for (int i = 0; i < p->M; i++) {
+            free(p->A_rows[i]);
+        }
+        free(p->A_rows);
+    } else {
+        matrix_free(&p->A_flat);
+    }
+    free(p->B);
+    free(p->P);
+    free(p->A_low);
+    free(p->B_low);
+}
+
+// Check every P[i][k] against a compensated reference, in parallel over rows, with the tolerance of
+// the storage format. Returns the mismatches; *worst is the largest error relative to its row's
+// sum|a*b| and *norm the 2-norm of the error relative to that of the reference, both over the
+// finite results and NaN when *nonfinite (the count of inf or NaN results, e.g. fp16 overflow) is not 0.
+static long problem_verify(const Problem *p, double *worst, double *norm, long *nonfinite) {
+    long mismatches = 0, bad = 0;
+    double u_store = mixed_store_error(p->mixed), u_sum = mixed_sum_error(p->mixed);
+    double largest = 0.0, error_sq = 0.0, ref_sq = 0.0;
+    if (p->sparse) {
+        // One vector; the CSR copy holds every row in order.
+#pragma omp parallel for schedule(static) reduction(+:mismatches)
+        for (int i = 0; i < p->M; i++) {
+            const long *row_ptr = p->csr.row_ptr;
+            verify_ref_t ref;
+            verify_gather_ref(p->csr.val + row_ptr[i], p->csr.col + row_ptr[i], p->B, row_ptr[i + 1] - row_ptr[i], &ref);
+            if (!verify_check(p->P[i], &ref)) {
+                mismatches++;
+            }
+        }
+        *worst = *norm = 0.0;
+        *nonfinite = 0;
+        return mismatches;
+    }
+#pragma omp parallel for schedule(static) reduction(+:mismatches, bad, error_sq, ref_sq) reduction(max:largest)
+    for (int i = 0; i < p->M; i++) {
+        const double *row = get_row(p, i);
+        for (int k = 0; k < p->K; k++) {
+            verify_ref_t ref;
+            verify_dot_ref(row, p->B + k * p->b_vec, p->b_row, p->N, &ref);
+            double got = p->P[(long) i * p->K + k], error = got - verify_ref_value(&ref);
+            if (!verify_check_mixed(got, &ref, u_store, u_sum)) {
+                mismatches++;
+            }
+            if (!isfinite(got)) {
+                bad++;  // Counted apart: a max reduction may drop a NaN.
+                continue;
+            }
+            double scaled = verify_scaled_error(got, &ref);
+            largest = (scaled > largest) ? scaled : largest;
+            error_sq += error * error;
+            ref_sq += verify_ref_value(&ref) * verify_ref_value(&ref);
+        }
+    }
+    *nonfinite = bad;
+    *worst = bad ? NAN : largest;
+    *norm = bad ? NAN : (ref_sq > 0) ? sqrt(error_sq / ref_sq) : sqrt(error_sq);
+    return mismatches;
+}
+
+// Generate row i of A (stream INPUT_A, row i) unless it is mapped from a file, pack it for a
+// narrower --dtype, and zero row i of P.
+static void init_row(Problem *p, const input_t *input, int i) {
+    if (!p->matrix) {
+        input_fill(input, INPUT_A, i, 0, get_row(p, i), 1, p->N);
+    }
+    if (mixed_reduced(p->mixed)) {
+        mixed_pack(p->mixed->storage, get_row(p, i), mixed_at(p->mixed->storage, p->A_low, i * p->A_flat.ld), p->N);
+    }
+    for (int k = 0; k < p->K; k++) {
+        p->P[(long) i * p->K + k] = 0.0;
+    }
+}
+
+// Rows of part t of a sparse problem: its rows for CSR, the rows of its slices for SELL.
+static void part_rows(const Problem *p, int t, int *row_begin, int *row_end) {
+    int scale = (p->layout == LAYOUT_SELL) ? SELL_C : 1;
+    *row_begin = (p->bounds[t] * scale < p->M) ? p->bounds[t] * scale : p->M;
+    *row_end = (p->bounds[t + 1] * scale < p->M) ? p->bounds[t + 1] * scale : p->M;
+}
+
+// Generate a sparse A and zero P, each part by the thread that multiplies it (rows move only
+// within a SELL window, so a slice's rows of CSR are near it). SELL is copied from the CSR rows
+// once they are all generated.
+static void problem_init_sparse(Problem *p, const input_t *input, int parallel_touch) {
+    if (!parallel_touch) {
+        memset(p->csr.col, 0, (size_t) p->csr.nnz * sizeof(int));
+        memset(p->csr.val, 0, (size_t) p->csr.nnz * sizeof(double));
+        if (p->layout == LAYOUT_SELL) {
+            memset(p->sell.col, 0, (size_t) p->sell.slice_ptr[p->sell.slices] * sizeof(int));
+            memset(p->sell.val, 0, (size_t) p->sell.slice_ptr[p->sell.slices] * sizeof(double));
+        }
+        memset(p->P, 0, (size_t) p->M * sizeof(double));
+    }
+#pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        int nthreads = omp_get_num_threads();
+        for (int t = tid; t < p->parts; t += nthreads) {
+            int row_begin, row_end;
+            part_rows(p, t, &row_begin, &row_end);
+            csr_fill(&p->csr, p->sparse, input, row_begin, row_end);
+            memset(p->P + row_begin, 0, (size_t) (row_end - row_begin) * sizeof(double));
+        }
+        if (p->layout == LAYOUT_SELL) {
+#pragma omp barrier
+            for (int t = tid; t < p->parts; t += nthreads) {
+                sell_fill(&p->sell, &p->csr, p->bounds[t], p->bounds[t + 1]);
+            }
+        }
+    }
+}
+
+// Generate A and B (or read B from its file) and zero P. Each thread writes the rows of A and P it reads in the kernel;
+// with parallel_touch that write is their first touch, so their pages are placed with their
+// reader. Otherwise one thread zeroes all rows first, which places every page on its node.
+// Vector k of B is stream INPUT_B, row k.
+static void problem_init(Problem *p, const input_t *input, int parallel_touch) {
+    const int M = p->M, N = p->N, K = p->K;
+    if (!parallel_touch && !p->sparse) {
+        for (int i = 0; i < M; i++) {
+            if (!p->matrix) {
+                memset(get_row(p, i), 0, (size_t) N * sizeof(double));
+            }
+            if (mixed_reduced(p->mixed)) {
+                memset(mixed_at(p->mixed->storage, p->A_low, i * p->A_flat.ld), 0, (size_t) N * dtype_bytes(p->mixed->storage));
+            }
+            memset(p->P + (long) i * K, 0, (size_t) K * sizeof(double));
+        }
+    }
+    if (p->sparse) {
+        problem_init_sparse(p, input, parallel_touch);
+    } else if (p->kernel == KERNEL_BLOCKED) {
+        // Same row split as the blocked kernel's static schedule.
+#pragma omp parallel
+        {
+            int tid = omp_get_thread_num();
+            int nthreads = omp_get_num_threads();
+            int rows_per_thread = M / nthreads;
+            int remainder = M % nthreads;
+            int start = tid * rows_per_thread + (tid < remainder ? tid : remainder);
+            int end = start + rows_per_thread + (tid < remainder ? 1 : 0);
+            for (int i = start; i < end; i++) {
+                init_row(p, input, i);
+            }
+        }
+    } else {
+        // Same split as the naive loops' static schedule.
+#pragma omp parallel for schedule(static)
+        for (int i = 0; i < M; i++) {
+            init_row(p, input, i);
+        }
+    }
+#pragma omp parallel for schedule(static)
+    for (int j = 0; j < N; j++) {
+        for (int k = 0; k < K; k++) {
+            p->B[k * p->b_vec + (long) j * p->b_row] =
+                p->vector ? matfile_row(p->vector, j)[k] : input_value(input, INPUT_B, k, j);
+        }
+    }
+    if (mixed_reduced(p->mixed)) {
+        mixed_pack(p->mixed->storage, p->B, p->B_low, N);
+    }
+}
+
+// Multiply rows [row_begin, row_end) of A by the K vectors into P.
+static void problem_multiply(const Problem *p, int row_begin, int row_end, const gemv_plan_t *plan) {
+    const int N = p->N, K = p->K;
+    sched_t *sched = p->sched;
+    if (p->sparse) {
+        // The whole matrix (sparse problems are not streamed): with the static schedule each thread
+        // multiplies its balanced part, otherwise chunks of rows or slices.
+        // Under the static schedule a smaller team takes contiguous runs of the parts.
+        int by_parts = sched_is_static(&sched->opts);
+#pragma omp parallel
+        {
+            int tid = omp_get_thread_num();
+            long begin, end;
+#pragma omp single
+            sched_start(sched, by_parts ? p->parts : (p->layout == LAYOUT_SELL) ? p->sell.slices : p->M,
+                        omp_get_num_threads());
+            while (sched_next(sched, tid, &begin, &end)) {
+                int first = by_parts ? p->bounds[begin] : (int) begin;
+                int last = by_parts ? p->bounds[end] : (int) end;
+                if (p->layout == LAYOUT_SELL) {
+                    sell_spmv(&p->sell, p->B, p->P, first, last);
+                } else {
+                    csr_spmv(&p->csr, p->B, p->P, first, last);
+                }
+            }
+        }
+    } else if (p->kernel == KERNEL_BLOCKED) {
+#pragma omp parallel
+        {
+            // Each thread runs the blocked kernel over the row ranges the schedule gives it.
+            int tid = omp_get_thread_num();
+            long begin, end;
+#pragma omp single
+            sched_start(sched, row_end - row_begin, omp_get_num_threads());
+            while (sched_next(sched, tid, &begin, &end)) {
+                int start = row_begin + (int) begin;
+                int stop = row_begin + (int) end;
+                if (mixed_reduced(p->mixed)) {
+                    mixed_gemv(p->mixed, p->A_low, p->A_flat.ld, N, p->B_low, p->P, start, stop, plan);
+                } else if (K == 1) {
+                    gemv_blocked(&p->A_flat, p->B, p->P, start, stop, plan);
+                } else {
+                    gemv_batched(&p->A_flat, p->B, K, p->P, start, stop, plan);
+                }
+            }
+        }
+    } else {
+        // One full pass over the rows per vector.
+        for (int k = 0; k < K; k++) {
+            const double *Bk = p->B + k * p->b_vec;
+#pragma omp parallel
+            {
+                int tid = omp_get_thread_num();
+                long begin, end;
+#pragma omp single
+                sched_start(sched, row_end - row_begin, omp_get_num_threads());
+                while (sched_next(sched, tid, &begin, &end)) {
+                    if (p->layout == LAYOUT_ROWPTR) {
+                        for (int i = row_begin + (int) begin; i < row_begin + (int) end; i++) {
+                            double sum = 0.0;
+                            for (int j = 0; j < N; j++) {
+                                sum += p->A_rows[i][j] * Bk[j];
+                            }
+                            p->P[(long) i * K + k] = sum;
+                        }
+                    } else {
+                        for (int i = row_begin + (int) begin; i < row_begin + (int) end; i++) {
+                            const double *row = matrix_row(&p->A_flat, i);
+                            double sum = 0.0;
+                            for (int j = 0; j < N; j++) {
+                                sum += row[j] * Bk[j];
+                            }
+                            p->P[(long) i * K + k] = sum;
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Write the problem's A and B (as an N x K block) to the files named, if any. Exits on failure.
+static void problem_save(const Problem *p, const char *matrix_path, const char *vector_path) {
+    if (matrix_path && matfile_write(matrix_path, &p->A_flat) != 0) {
+        perror(matrix_path);
+        exit(EXIT_FAILURE);
+    }
+    if (vector_path) {
+        Matrix block;
+        if (matrix_alloc(&block, p->N, p->K) != 0) {
+            perror("Memory allocation failed");
+            exit(EXIT_FAILURE);
+        }
+        block.ld = p->K;  // Unpadded: entry j of vector k at row j, column k.
+        for (int j = 0; j < p->N; j++) {
+            for (int k = 0; k < p->K; k++) {
+                block.data[(long) j * p->K + k] = p->B[k * p->b_vec + (long) j * p->b_row];
+            }
+        }
+        if (matfile_write(vector_path, &block) != 0) {
+            perror(vector_path);
+            exit(EXIT_FAILURE);
+        }
+        matrix_free(&block);
+    }
+}
+
 int main(int argc, char *argv[]) {
+    layout_t layout = LAYOUT_FLAT;
+    kernel_t kernel = KERNEL_NAIVE;
+    int K = 1;  // Number of vectors multiplied per run.
+    int parallel_touch = 0;
+    int reuse = 1;  // --alloc=reuse
+    int verify = 1;
+    const char *matrix_path = NULL, *vector_path = NULL;            // --matrix, --vector
+    const char *save_matrix_path = NULL, *save_vector_path = NULL;  // --save-matrix, --save-vector
+    int stream_rows = 0;  // --stream: rows per panel, 0 when the mapping is used in place.
+    bench_t bench;
+    bench_defaults(&bench);
+    input_t input;
+    input_defaults(&input);
+    sparse_opts_t sparse;
+    sparse_defaults(&sparse);
+    mixed_t mixed;
+    mixed_defaults(&mixed);
+    sched_opts_t schedule;
+    sched_defaults(&schedule);
+    // Pull --option=value flags out of argv so the positional arguments keep their places.
+    int nargs = 1, rc;
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--layout=", 9) == 0) {
+            if (strcmp(argv[i] + 9, "rowptr") == 0) {
+                layout = LAYOUT_ROWPTR;
+            } else if (strcmp(argv[i] + 9, "flat") == 0) {
+                layout = LAYOUT_FLAT;
+            } else if (strcmp(argv[i] + 9, "csr") == 0) {
+                layout = LAYOUT_CSR;
+            } else if (strcmp(argv[i] + 9, "sell") == 0) {
+                layout = LAYOUT_SELL;
+            } else {
+                printf("Unknown layout: %s\n", argv[i] + 9);
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--kernel=", 9) == 0) {
+            if (strcmp(argv[i] + 9, "naive") == 0) {
+                kernel = KERNEL_NAIVE;
+            } else if (strcmp(argv[i] + 9, "blocked") == 0) {
+                kernel = KERNEL_BLOCKED;
+            } else {
+                printf("Unknown kernel: %s\n", argv[i] + 9);
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--batch=", 8) == 0) {
+            K = atoi(argv[i] + 8);
+            if (K < 1) {
+                printf("Batch size must be at least 1\n");
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--first-touch=", 14) == 0) {
+            if (strcmp(argv[i] + 14, "serial") == 0) {
+                parallel_touch = 0;
+            } else if (strcmp(argv[i] + 14, "parallel") == 0) {
+                parallel_touch = 1;
+            } else {
+                printf("Unknown first-touch mode: %s\n", argv[i] + 14);
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--alloc=", 8) == 0) {
+            if (strcmp(argv[i] + 8, "reuse") == 0) {
+                reuse = 1;
+            } else if (strcmp(argv[i] + 8, "cold") == 0) {
+                reuse = 0;
+            } else {
+                printf("Unknown allocation mode: %s\n", argv[i] + 8);
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--matrix=", 9) == 0) {
+            matrix_path = argv[i] + 9;
+        } else if (strncmp(argv[i], "--vector=", 9) == 0) {
+            vector_path = argv[i] + 9;
+        } else if (strncmp(argv[i], "--save-matrix=", 14) == 0) {
+            save_matrix_path = argv[i] + 14;
+        } else if (strncmp(argv[i], "--save-vector=", 14) == 0) {
+            save_vector_path = argv[i] + 14;
+        } else if (strncmp(argv[i], "--stream=", 9) == 0) {
+            stream_rows = atoi(argv[i] + 9);
+            if (stream_rows < 1) {
+                printf("Panel size must be at least 1 row\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--no-verify") == 0) {
+            verify = 0;
+        } else if ((rc = bench_parse_arg(&bench, argv[i])) != 0 || (rc = input_parse_arg(&input, argv[i])) != 0 ||
+                   (rc = sparse_parse_arg(&sparse, argv[i])) != 0 || (rc = mixed_parse_arg(&mixed, argv[i])) != 0 ||
+                   (rc = sched_parse_arg(&schedule, argv[i])) != 0) {
+            if (rc < 0) {
+                printf("Invalid option: %s\n", argv[i]);
+                return 1;
+            }
+        } else {
+            argv[nargs++] = argv[i];
+        }
+    }
+    argc = nargs;
     if (argc < 5) {
-        printf("Usage: %s <num_threads> <base_M> <base_N> <strong|weak> [num_runs]\n", argv[0]);
+        printf("Usage: %s <num_threads> <base_M> <base_N> <strong|weak> [num_runs] [--layout=rowptr|flat|csr|sell] [--sparse=banded:W|powerlaw:D] [--sigma=S] [--balance=nnz|rows] [--kernel=naive|blocked] [--batch=K] [--first-touch=serial|parallel] [--alloc=reuse|cold] [--init=ones|uniform|normal|ill|sparse] [--seed=S] [--dtype=fp64|fp32|bf16|fp16] [--accum=fp64|fp32] [--schedule=static|dynamic|guided|steal[:C]] [--matrix=FILE] [--vector=FILE] [--stream=R] [--save-matrix=FILE] [--save-vector=FILE] [--warmup=N] [--format=text|json|csv] [--output=FILE] [--no-verify]\n", argv[0]);
+        return 1;
+    }
+    if (kernel == KERNEL_BLOCKED && layout != LAYOUT_FLAT) {
+        printf("The blocked kernel requires --layout=flat\n");
+        return 1;
+    }
+    if ((matrix_path || save_matrix_path) && layout != LAYOUT_FLAT) {
+        printf("Matrix files require --layout=flat\n");
+        return 1;
+    }
+    if (stream_rows && !matrix_path) {
+        printf("--stream requires --matrix\n");
+        return 1;
+    }
+    int is_sparse = (layout == LAYOUT_CSR || layout == LAYOUT_SELL);
+    if (is_sparse && (K != 1 || vector_path)) {
+        printf("Sparse layouts multiply one generated vector (--batch=1, no --vector)\n");
+        return 1;
+    }
+    char precision[16];
+    mixed_name(&mixed, precision, sizeof(precision));
+    if (mixed_init(&mixed, DOT_KERNEL_AUTO) != 0) {
+        printf("Precision %s is not available\n", precision);
+        return 1;
+    }
+    int low = mixed_reduced(&mixed);
+    if (low && (kernel != KERNEL_BLOCKED || K != 1 || matrix_path || vector_path || save_matrix_path || save_vector_path)) {
+        printf("Reduced precision requires --layout=flat --kernel=blocked --batch=1 and generated data (no files)\n");
         return 1;
     }
     int num_threads = atoi(argv[1]);
@@ -36,76 +597,241 @@ int main(int argc, char *argv[]) {
     int M = (strcmp(scaling, "weak") == 0) ? base_M * num_threads : base_M;
     int N = base_N;  // For simplicity, let N remain constant.
 
-    double total_time = 0.0;
-    int error;
-
-    for (int run = 0; run < num_runs; run++) {
-        // Allocate matrix A (M x N)
-        double **A = (double**) malloc(M * sizeof(double*));
-        for (int i = 0; i < M; i++) {
-            A[i] = (double*) malloc(N * sizeof(double));
+    // A file fixes the dimensions: M x N for the matrix, N x K for the vectors.
+    matfile_t matrix_file, vector_file;
+    if (matrix_path) {
+        if (matfile_open(&matrix_file, matrix_path) != 0) {
+            perror(matrix_path);
+            return 1;
+        }
+        if (matrix_file.header.rows > INT_MAX || matrix_file.header.cols > INT_MAX) {
+            printf("%s: %llu x %llu is too large\n", matrix_path, (unsigned long long) matrix_file.header.rows,
+                   (unsigned long long) matrix_file.header.cols);
+            return 1;
+        }
+        M = (int) matrix_file.header.rows;
+        N = (int) matrix_file.header.cols;
+        if (matfile_map_rows(&matrix_file, 0, M) != 0) {
+            perror(matrix_path);
+            return 1;
+        }
+    }
+    if (vector_path) {
+        if (matfile_open(&vector_file, vector_path) != 0 || matfile_map_rows(&vector_file, 0, (long) vector_file.header.rows) != 0) {
+            perror(vector_path);
+            return 1;
         }
-        // Allocate vector B and result vector P.
-        double *B = (double*) malloc(N * sizeof(double));
-        double *P = (double*) malloc(M * sizeof(double));
-        if (!A || !B || !P) {
+        if (vector_file.header.rows != (uint64_t) N || vector_file.header.cols < 1 || vector_file.header.cols > INT_MAX) {
+            printf("%s: expected %d rows (one per matrix column), found %llu x %llu\n", vector_path, N,
+                   (unsigned long long) vector_file.header.rows, (unsigned long long) vector_file.header.cols);
+            return 1;
+        }
+        K = (int) vector_file.header.cols;
+    }
+
+    // Tile sizes for the blocked kernel come from the cache sizes of this machine.
+    gemv_plan_t plan;
+    gemv_plan_init(&plan, N);
+
+    sched_t sched;
+    if (bench_start(&bench, num_runs) != 0 || sched_init(&sched, &schedule, num_threads) != 0) {
+        perror("Memory allocation failed");
+        exit(EXIT_FAILURE);
+    }
+
+    Problem prob = { .M = M, .N = N, .K = K, .layout = layout, .kernel = kernel,
+                     .matrix = matrix_path ? &matrix_file : NULL, .vector = vector_path ? &vector_file : NULL,
+                     .sparse = is_sparse ? &sparse : NULL, .parts = num_threads, .mixed = &mixed,
+                     .sched = &sched };
+    // The blocked kernel wants B as an N x K row-major block; the naive loop keeps each vector contiguous.
+    prob.b_row = (kernel == KERNEL_BLOCKED) ? K : 1;
+    prob.b_vec = (kernel == KERNEL_BLOCKED) ? 1 : N;
+
+    omp_set_num_threads(num_threads);
+    arena_t arena = {0};
+    if (reuse) {
+        // Allocate and warm everything once; every run reuses it.
+        if (arena_init(&arena, problem_bytes(&prob)) != 0 || problem_alloc(&prob, &arena, &input) != 0) {
             perror("Memory allocation failed");
             exit(EXIT_FAILURE);
         }
-        // Initialize A and B with 1.0.
-        for (int i = 0; i < M; i++) {
-            for (int j = 0; j < N; j++) {
-                A[i][j] = 1.0;
+        problem_init(&prob, &input, parallel_touch);
+    }
+
+    // Sparse layouts: nonzeros, elements stored, the largest part, and the row or slice pointer
+    // bytes, kept from the first run (--alloc=cold frees the problem after every run).
+    long nnz = 0, stored = 0, busiest = 0;
+    double pointer_bytes = 0.0;
+    double error_worst = 0.0, error_norm = 0.0;  // Of the last checked run, against the fp64 reference.
+    long error_nonfinite = 0;
+    const char *sell_isa = "";
+    for (int run = 0; run < bench_total_runs(&bench); run++) {
+        if (!reuse) {
+            if (problem_alloc(&prob, NULL, &input) != 0) {
+                perror("Memory allocation failed");
+                exit(EXIT_FAILURE);
             }
+            problem_init(&prob, &input, parallel_touch);
         }
-        for (int j = 0; j < N; j++) {
-            B[j] = 1.0;
-        }
-        omp_set_num_threads(num_threads);
-        double t_start = omp_get_wtime();
-#pragma omp parallel for
-        for (int i = 0; i < M; i++) {
-            double sum = 0.0;
-            for (int j = 0; j < N; j++) {
-                sum += A[i][j] * B[j];
+        if (is_sparse && run == 0) {
+            const long *prefix = (layout == LAYOUT_SELL) ? prob.sell.slice_ptr : prob.csr.row_ptr;
+            nnz = prob.csr.nnz;
+            stored = (layout == LAYOUT_SELL) ? prob.sell.slice_ptr[prob.sell.slices] : nnz;
+            pointer_bytes = (layout == LAYOUT_SELL)
+                ? (double) prob.sell.slices * (sizeof(long) + sizeof(int) + SELL_C * sizeof(int))
+                : (double) (M + 1) * sizeof(long);
+            sell_isa = (layout == LAYOUT_SELL) ? prob.sell.isa : "";
+            for (int t = 0; t < prob.parts; t++) {
+                long weight = prefix[prob.bounds[t + 1]] - prefix[prob.bounds[t]];
+                busiest = (weight > busiest) ? weight : busiest;
             }
-            P[i] = sum;
         }
-        double t_end = omp_get_wtime();
-        double elapsed = t_end - t_start;
-        total_time += elapsed;
-
-        // Sequential verification
-        double *P_seq = (double*) malloc(M * sizeof(double));
-        for (int i = 0; i < M; i++) {
-            double sum = 0.0;
-            for (int j = 0; j < N; j++) {
-                sum += A[i][j] * B[j];
-            }
-            P_seq[i] = sum;
+        if (save_matrix_path || save_vector_path) {
+            problem_save(&prob, save_matrix_path, save_vector_path);
+            save_matrix_path = save_vector_path = NULL;
         }
-        error = 0;
-        for (int i = 0; i < M; i++) {
-            if (P[i] != P_seq[i]) {
-                error = 1;
-                break;
+        if (run == bench.warmup) {
+            sched_clear(&sched);  // Busy times of the kept runs only.
+        }
+        uint64_t t_start = bench_now_ns();
+        if (stream_rows) {
+            // Out of core: read ahead on the next panel while this one is multiplied, then drop it.
+            matfile_prefetch(&matrix_file, 0, stream_rows < M ? stream_rows : M);
+            for (int row = 0; row < M; row += stream_rows) {
+                int end = (M - row < stream_rows) ? M : row + stream_rows;
+                matfile_prefetch(&matrix_file, end, (M - end < stream_rows) ? M : end + stream_rows);
+                problem_multiply(&prob, row, end, &plan);
+                matfile_release(&matrix_file, row, end);
             }
+        } else {
+            problem_multiply(&prob, 0, M, &plan);
         }
-        if (error) {
-            printf("Run %d: Error in matrix-vector multiplication!\n", run+1);
+        bench_record(&bench, bench_now_ns() - t_start);
+
+        long mismatches = verify ? problem_verify(&prob, &error_worst, &error_norm, &error_nonfinite) : 0;
+        if (mismatches) {
+            printf("Run %d: Error in matrix-vector multiplication! %ld of %ld results out of tolerance\n", run+1,
+                   mismatches, (long) M * K);
         }
         // Free memory for this run.
-        for (int i = 0; i < M; i++) {
-            free(A[i]);
+        if (!reuse) {
+            problem_free(&prob);
         }
-        free(A);
-        free(B);
-        free(P);
-        free(P_seq);
     }
-    double avg_time = total_time / num_runs;
+    // Record where each thread runs; with OMP_PROC_BIND set this matches the timed regions.
+    int *thread_cpu = (int*) calloc(num_threads, sizeof(int));
+    if (!thread_cpu) {
+        perror("Memory allocation failed");
+        exit(EXIT_FAILURE);
+    }
+#pragma omp parallel
+    thread_cpu[omp_get_thread_num()] = affinity_current_cpu();
+
     printf("OpenMP Matrix-Vector Multiplication Performance\n");
-    printf("Threads: %d, Matrix Size: %d x %d, Scaling: %s, Runs: %d\n", num_threads, M, N, scaling, num_runs);
-    printf("Average Time (seconds): %f\n", avg_time);
+    printf("Threads: %d, Matrix Size: %d x %d, Scaling: %s, Runs: %d, Layout: %s\n", num_threads, M, N, scaling, num_runs,
+           layout_names[layout]);
+    char pattern[32];
+    sparse_name(&sparse, pattern, sizeof(pattern));
+    if (is_sparse && sched_is_static(&schedule)) {
+        printf("Sparse: %s, %ld nonzeros (%.2f per row), split by %s: busiest thread %.3f x mean\n", pattern, nnz,
+               M > 0 ? (double) nnz / M : 0.0, sparse.balance_nnz ? "nonzeros" : "rows",
+               stored > 0 ? busiest / ((double) stored / num_threads) : 0.0);
+    } else if (is_sparse) {
+        printf("Sparse: %s, %ld nonzeros (%.2f per row), generated in parts split by %s\n", pattern, nnz,
+               M > 0 ? (double) nnz / M : 0.0, sparse.balance_nnz ? "nonzeros" : "rows");
+    }
+    if (layout == LAYOUT_SELL) {
+        printf("Kernel: SELL-%d-%d (%s), padding %.1f%% of stored elements\n", SELL_C, sparse.sigma, sell_isa,
+               stored > 0 ? 100.0 * (stored - nnz) / stored : 0.0);
+    } else if (layout == LAYOUT_CSR) {
+        printf("Kernel: csr\n");
+    } else if (kernel == KERNEL_BLOCKED) {
+        printf("Kernel: blocked (%s, %d rows x %d cols tile, %d-row panel, L1 %ld KB, L2 %ld KB)\n",
+               low ? mixed.isa : plan.isa, GEMV_BLOCK_ROWS, plan.col_tile, plan.row_panel, plan.l1_bytes / 1024, plan.l2_bytes / 1024);
+    } else {
+        printf("Kernel: naive\n");
+    }
+    if (low) {
+        printf("Precision: %s storage, %s accumulation, %zu bytes per element\n", dtype_name(mixed.storage),
+               dtype_name(mixed.accum), dtype_bytes(mixed.storage));
+        if (verify) {
+            printf("Error vs fp64 reference: %.3g of sum|a*b| (worst row), %.3g relative 2-norm", error_worst,
+                   error_norm);
+            if (error_nonfinite) {
+                printf(", %ld of %ld results not finite", error_nonfinite, (long) M * K);
+            }
+            printf("\n");
+        }
+    }
+    printf("Input: %s (seed %llu)\n", input_name(&input), (unsigned long long) input.seed);
+    if (matrix_path) {
+        if (stream_rows)
+            printf("Matrix: %s (streamed in %d-row panels)\n", matrix_path, stream_rows);
+        else
+            printf("Matrix: %s (mapped)\n", matrix_path);
+        matfile_close(&matrix_file);
+    }
+    if (vector_path) {
+        printf("Vectors: %s\n", vector_path);
+        matfile_close(&vector_file);
+    }
+    char binding[96], how[128];
+    affinity_omp_binding(binding, sizeof(binding));
+    snprintf(how, sizeof(how), "%s, first-touch=%s", binding, parallel_touch ? "parallel" : "serial");
+    affinity_report(how, num_threads, thread_cpu);
+    free(thread_cpu);
+    sched_report(&sched, is_sparse && sched_is_static(&schedule) ? NULL
+                         : (layout == LAYOUT_SELL) ? "slices" : "rows", num_runs);
+    sched_destroy(&sched);
+    if (reuse) {
+        printf("Alloc: reuse (%s pages)\n", arena_pages_name(&arena));
+        arena_destroy(&arena);
+    } else {
+        printf("Alloc: cold\n");
+    }
+    // The blocked kernel streams A once for all K vectors; the naive loop streams it K times.
+    // A sparse A is its stored values and column indices plus the row or slice pointers, and B
+    // is counted once as if it stayed cached.
+    double flops = 2.0 * M * N * K;
+    double a_passes = (kernel == KERNEL_BLOCKED) ? 1.0 : K;
+    double bytes = (a_passes * M * N + (double) N * K) * dtype_bytes(mixed.storage) + (double) M * K * sizeof(double);
+    if (is_sparse) {
+        flops = 2.0 * nnz;
+        bytes = stored * (double) (sizeof(double) + sizeof(int)) + pointer_bytes + ((double) N + M) * sizeof(double);
+    }
+    printf("Batch: %d, Bytes/flop: %.3f\n", K, bytes / flops);
+    char kernel_name[32], config[160];
+    snprintf(kernel_name, sizeof(kernel_name), "%s", (kernel == KERNEL_BLOCKED) ? "blocked-" : "naive");
+    if (kernel == KERNEL_BLOCKED) {
+        strncat(kernel_name, low ? mixed.isa : plan.isa, sizeof(kernel_name) - strlen(kernel_name) - 1);
+    } else if (layout == LAYOUT_SELL) {
+        snprintf(kernel_name, sizeof(kernel_name), "sell-%s", sell_isa);
+    } else if (layout == LAYOUT_CSR) {
+        snprintf(kernel_name, sizeof(kernel_name), "csr");
+    }
+    snprintf(config, sizeof(config), "layout=%s first-touch=%s init=%s dtype=%s", layout_names[layout],
+             parallel_touch ? "parallel" : "serial", input_name(&input), precision);
+    if (is_sparse) {
+        snprintf(config + strlen(config), sizeof(config) - strlen(config), " sparse=%s balance=%s", pattern,
+                 sparse.balance_nnz ? "nnz" : "rows");
+    }
+    if (layout == LAYOUT_SELL) {
+        snprintf(config + strlen(config), sizeof(config) - strlen(config), " sigma=%d", sparse.sigma);
+    }
+    if (matrix_path && stream_rows) {
+        snprintf(config + strlen(config), sizeof(config) - strlen(config), " matrix=stream:%d", stream_rows);
+    } else if (matrix_path) {
+        strncat(config, " matrix=mapped", sizeof(config) - strlen(config) - 1);
+    }
+    if (vector_path) {
+        strncat(config, " vector=file", sizeof(config) - strlen(config) - 1);
+    }
+    char sched_label[32];
+    sched_name(&schedule, sched_label, sizeof(sched_label));
+    snprintf(config + strlen(config), sizeof(config) - strlen(config), " schedule=%s", sched_label);
+    bench_info_t info = { .program = "perf_matrix_vector_omp", .scaling = scaling, .kernel = kernel_name, .config = config,
+                          .threads = num_threads, .procs = 1, .m = M, .n = N, .k = K, .flops = flops, .bytes = bytes };
+    bench_report(&bench, &info);
+    bench_finish(&bench);
     return 0;
 }
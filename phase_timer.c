@@ -0,0 +1,91 @@
+// File: phase_timer.c
+// Name: Bradley Stephen
+// Date: October 16, 2026
+// Assignment: MP1 - MPI Phase Timing
+//
+// Description:
+//   Implementation of phase_timer.h. Times come from bench_now_ns() so they match the harness.
+//   A phase that was never entered on a rank counts as zero there.
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "phase_timer.h"
+#include "bench.h"
+
+int phase_timer_init(phase_timer_t *t, int warmup, int runs) {
+    memset(t, 0, sizeof(*t));
+    t->warmup = warmup;
+    t->runs = runs;
+    t->samples = (double*) calloc((size_t) (runs > 0 ? runs : 1) * PHASE_MAX, sizeof(double));
+    return t->samples ? 0 : -1;
+}
+
+int phase_define(phase_timer_t *t, const char *name) {
+    if (t->count == PHASE_MAX) {
+        return -1;
+    }
+    t->names[t->count] = name;
+    return t->count++;
+}
+
+void phase_begin(phase_timer_t *t) {
+    t->start_ns = bench_now_ns();
+}
+
+void phase_end(phase_timer_t *t, int id) {
+    t->current[id] += (bench_now_ns() - t->start_ns) * 1e-9;
+}
+
+void phase_run_done(phase_timer_t *t) {
+    int kept = t->seen - t->warmup;
+    if (kept >= 0 && kept < t->runs) {
+        memcpy(t->samples + (size_t) kept * PHASE_MAX, t->current, sizeof(t->current));
+    }
+    memset(t->current, 0, sizeof(t->current));
+    t->seen++;
+}
+
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double*) a, y = *(const double*) b;
+    return (x > y) - (x < y);
+}
+
+void phase_report(const phase_timer_t *t, const char *title, MPI_Comm comm) {
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    int kept = t->seen - t->warmup;
+    if (kept > t->runs) kept = t->runs;
+
+    // This rank's median for each phase.
+    double median[PHASE_MAX] = {0};
+    double column[kept > 0 ? kept : 1];
+    for (int p = 0; p < t->count && kept > 0; p++) {
+        for (int r = 0; r < kept; r++) {
+            column[r] = t->samples[(size_t) r * PHASE_MAX + p];
+        }
+        qsort(column, kept, sizeof(double), compare_doubles);
+        median[p] = (kept % 2) ? column[kept / 2] : 0.5 * (column[kept / 2 - 1] + column[kept / 2]);
+    }
+
+    double max[PHASE_MAX], min[PHASE_MAX], sum[PHASE_MAX];
+    MPI_Reduce(median, max, t->count, MPI_DOUBLE, MPI_MAX, 0, comm);
+    MPI_Reduce(median, min, t->count, MPI_DOUBLE, MPI_MIN, 0, comm);
+    MPI_Reduce(median, sum, t->count, MPI_DOUBLE, MPI_SUM, 0, comm);
+    if (rank != 0) {
+        return;
+    }
+    printf("%s (per-rank median seconds over %d ranks):\n", title, size);
+    printf("  %-12s %14s %14s %14s %10s\n", "phase", "max", "min", "mean", "imbalance");
+    for (int p = 0; p < t->count; p++) {
+        double mean = sum[p] / size;
+        double imbalance = (mean > 0.0) ? max[p] / mean - 1.0 : 0.0;
+        printf("  %-12s %14.9f %14.9f %14.9f %9.1f%%\n", t->names[p], max[p], min[p], mean, 100.0 * imbalance);
+    }
+}
+
+void phase_timer_free(phase_timer_t *t) {
+    free(t->samples);
+    t->samples = NULL;
+}
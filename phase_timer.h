@@ -0,0 +1,50 @@
+// File: phase_timer.h
+// Name: Bradley Stephen
+// Date: October 16, 2026
+// Assignment: MP1 - MPI Phase Timing
+//
+// Description:
+//   Per-phase timing for the MPI programs. Every rank times its own phases (scatter, broadcast,
+//   compute, gather, reduce, ...) in every run, keeping the samples after the warm-up runs.
+//   phase_report() is collective: it takes each rank's median per phase and prints, on rank 0,
+//   the max, min and mean across ranks and the imbalance (max / mean - 1). Compute imbalance shows
+//   uneven work; time in a collective shows both the transfer and the wait for the slowest rank.
+//
+#ifndef PHASE_TIMER_H
+#define PHASE_TIMER_H
+
+#include <stdint.h>
+#include <mpi.h>
+
+#define PHASE_MAX 8
+
+typedef struct {
+    int count;                       // Phases defined.
+    const char *names[PHASE_MAX];
+    int warmup;                      // Runs discarded before the kept ones.
+    int runs;                        // Kept runs.
+    int seen;                        // Runs finished so far, warm-up included.
+    double current[PHASE_MAX];       // Seconds spent in each phase in the run in progress.
+    double *samples;                 // runs x PHASE_MAX kept seconds on this rank.
+    uint64_t start_ns;               // Start of the phase being timed.
+} phase_timer_t;
+
+// Prepare for `warmup` discarded and `runs` kept runs. Returns 0 on success, -1 if allocation fails.
+int phase_timer_init(phase_timer_t *t, int warmup, int runs);
+
+// Add a phase; returns its id, or -1 if PHASE_MAX phases already exist.
+int phase_define(phase_timer_t *t, const char *name);
+
+// Start timing a phase; phase_end() adds the time since then to phase id.
+void phase_begin(phase_timer_t *t);
+void phase_end(phase_timer_t *t, int id);
+
+// Close the run: keep its phase times unless it is a warm-up run.
+void phase_run_done(phase_timer_t *t);
+
+// Collective over comm; rank 0 prints a table headed by title.
+void phase_report(const phase_timer_t *t, const char *title, MPI_Comm comm);
+
+void phase_timer_free(phase_timer_t *t);
+
+#endif
@@ -0,0 +1,138 @@
+// File: reduce.c
+// Name: Bradley Stephen
+// Date: October 16, 2026
+// Assignment: MP1 - Thread Reductions
+//
+// Description:
+//   Implementation of the reductions in reduce.h. The tree mode pairs threads at distance
+//   1, 2, 4, ...: the lower thread of each pair waits for its partner's slot to be published
+//   for the current epoch and adds it into its own slot, so after log2(n) levels thread 0 holds
+//   the total. The epoch counter means the ready flags never need to be cleared between runs.
+// Usage:
+//   Compile together with a driver and link with -lpthread.
+//
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include "reduce.h"
+
+#define REDUCE_SPIN_LIMIT 1000
+
+int reduce_mode_parse(const char *name, reduce_mode_t *mode) {
+    if (strcmp(name, "mutex") == 0) *mode = REDUCE_MUTEX;
+    else if (strcmp(name, "atomic") == 0) *mode = REDUCE_ATOMIC;
+    else if (strcmp(name, "slots") == 0) *mode = REDUCE_SLOTS;
+    else if (strcmp(name, "tree") == 0) *mode = REDUCE_TREE;
+    else return -1;
+    return 0;
+}
+
+const char* reduce_mode_name(reduce_mode_t mode) {
+    switch (mode) {
+    case REDUCE_MUTEX:  return "mutex";
+    case REDUCE_ATOMIC: return "atomic";
+    case REDUCE_SLOTS:  return "slots";
+    case REDUCE_TREE:   return "tree";
+    }
+    return "unknown";
+}
+
+int reducer_init(reducer_t *r, reduce_mode_t mode, int nthreads) {
+    r->mode = mode;
+    r->nthreads = nthreads;
+    r->epoch = 0;
+    r->total = 0.0;
+    atomic_init(&r->atomic_total, 0.0);
+    pthread_mutex_init(&r->mutex, NULL);
+    r->slots = NULL;
+    if (posix_memalign((void**) &r->slots, REDUCE_CACHE_LINE, nthreads * sizeof(reduce_slot_t)) != 0) {
+        r->slots = NULL;
+        pthread_mutex_destroy(&r->mutex);
+        return -1;
+    }
+    for (int t = 0; t < nthreads; t++) {
+        r->slots[t].value = 0.0;
+        atomic_init(&r->slots[t].ready, 0);
+    }
+    return 0;
+}
+
+void reducer_destroy(reducer_t *r) {
+    free(r->slots);
+    r->slots = NULL;
+    pthread_mutex_destroy(&r->mutex);
+}
+
+void reducer_reset(reducer_t *r) {
+    r->epoch++;
+    r->total = 0.0;
+    atomic_store_explicit(&r->atomic_total, 0.0, memory_order_relaxed);
+}
+
+static void tree_contribute(reducer_t *r, int tid, double partial) {
+    reduce_slot_t *mine = &r->slots[tid];
+    mine->value = partial;
+    for (int stride = 1; stride < r->nthreads; stride *= 2) {
+        if (tid % (2 * stride) != 0) {
+            // Upper thread of this pair: hand the value over and stop.
+            break;
+        }
+        int partner = tid + stride;
+        if (partner >= r->nthreads) {
+            continue;
+        }
+        reduce_slot_t *other = &r->slots[partner];
+        int spins = 0;
+        while (atomic_load_explicit(&other->ready, memory_order_acquire) != r->epoch) {
+            if (++spins >= REDUCE_SPIN_LIMIT) {
+                sched_yield();
+                spins = 0;
+            }
+        }
+        mine->value += other->value;
+    }
+    atomic_store_explicit(&mine->ready, r->epoch, memory_order_release);
+}
+
+void reducer_contribute(reducer_t *r, int tid, double partial) {
+    switch (r->mode) {
+    case REDUCE_MUTEX:
+        pthread_mutex_lock(&r->mutex);
+        r->total += partial;
+        pthread_mutex_unlock(&r->mutex);
+        break;
+    case REDUCE_ATOMIC: {
+        double expected = atomic_load_explicit(&r->atomic_total, memory_order_relaxed);
+        while (!atomic_compare_exchange_weak_explicit(&r->atomic_total, &expected, expected + partial,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+            // expected now holds the current total; retry with it.
+        }
+        break;
+    }
+    case REDUCE_SLOTS:
+        r->slots[tid].value = partial;
+        break;
+    case REDUCE_TREE:
+        tree_contribute(r, tid, partial);
+        break;
+    }
+}
+
+double reducer_result(reducer_t *r) {
+    switch (r->mode) {
+    case REDUCE_MUTEX:
+        return r->total;
+    case REDUCE_ATOMIC:
+        return atomic_load_explicit(&r->atomic_total, memory_order_relaxed);
+    case REDUCE_SLOTS: {
+        double sum = 0.0;
+        for (int t = 0; t < r->nthreads; t++) {
+            sum += r->slots[t].value;
+        }
+        return sum;
+    }
+    case REDUCE_TREE:
+        return r->slots[0].value;
+    }
+    return 0.0;
+}
@@ -0,0 +1,58 @@
+// File: reduce.h
+// Name: Bradley Stephen
+// Date: October 16, 2026
+// Assignment: MP1 - Thread Reductions
+//
+// Description:
+//   Selectable ways for threads to combine their partial sums into one result:
+//     mutex  - lock a mutex and add into a shared total (the original scheme)
+//     atomic - lock-free compare-and-swap loop on a shared double
+//     slots  - each thread writes its own cache-line-padded slot; the caller sums them
+//     tree   - padded slots combined by the threads themselves in a binary tree
+//   mutex and atomic have every thread write the same shared total, so its cache line moves
+//   between cores on each add; only slots and tree keep each thread's writes on its own line.
+//
+#ifndef REDUCE_H
+#define REDUCE_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+#define REDUCE_CACHE_LINE 64
+
+typedef enum { REDUCE_MUTEX, REDUCE_ATOMIC, REDUCE_SLOTS, REDUCE_TREE } reduce_mode_t;
+
+// One partial sum per cache line.
+typedef struct {
+    double value;
+    _Atomic unsigned ready;  // Epoch in which value was published (tree mode).
+} __attribute__((aligned(REDUCE_CACHE_LINE))) reduce_slot_t;
+
+typedef struct {
+    reduce_mode_t mode;
+    int nthreads;
+    unsigned epoch;
+    reduce_slot_t *slots;
+    pthread_mutex_t mutex;
+    _Alignas(REDUCE_CACHE_LINE) double total;        // mutex mode
+    _Alignas(REDUCE_CACHE_LINE) _Atomic double atomic_total;  // atomic mode
+} reducer_t;
+
+// Parse "mutex", "atomic", "slots" or "tree". Returns 0 on success, -1 otherwise.
+int reduce_mode_parse(const char *name, reduce_mode_t *mode);
+const char* reduce_mode_name(reduce_mode_t mode);
+
+// Returns 0 on success, -1 if the slots cannot be allocated.
+int reducer_init(reducer_t *r, reduce_mode_t mode, int nthreads);
+void reducer_destroy(reducer_t *r);
+
+// Start a new reduction. Must not overlap with contributions.
+void reducer_reset(reducer_t *r);
+
+// Called exactly once per thread per reduction with that thread's id.
+void reducer_contribute(reducer_t *r, int tid, double partial);
+
+// Combined value, valid once every thread's reducer_contribute has returned.
+double reducer_result(reducer_t *r);
+
+#endif
@@ -0,0 +1,110 @@
+// File: repro.c
+// Name: Bradley Stephen
+// Date: October 16, 2026
+// Assignment: MP1 - Reproducible Summation
+//
+// Description:
+//   Implementation of repro.h. A double is m * 2^e with |m| < 2^53; shifted to its digit
+//   position, m spans at most three 32-bit digits, each added as a value below 2^32. An int64_t
+//   digit can take 2^30 such additions before a carry propagation is needed.
+//
+#include <math.h>
+#include <string.h>
+#include "repro.h"
+
+#define REPRO_MAX_PENDING (1LL << 30)
+
+void repro_init(repro_acc_t *acc) {
+    memset(acc, 0, sizeof(*acc));
+}
+
+void repro_add(repro_acc_t *acc, double x) {
+    if (x == 0.0) {
+        return;
+    }
+    if (acc->pending >= REPRO_MAX_PENDING) {
+        repro_normalize(acc);
+    }
+    int e;
+    double f = frexp(x, &e);                   // x = f * 2^e, 0.5 <= |f| < 1
+    int64_t m = (int64_t) ldexp(f, 53);        // Exact: x = m * 2^(e - 53)
+    int p = e - 53 - REPRO_BASE;               // Bit position of m's lowest bit, >= 0 for any double.
+    unsigned __int128 v = (unsigned __int128) (m < 0 ? -m : m) << (p % 32);
+    int64_t lo = (int64_t) (v & 0xffffffffu);
+    int64_t mid = (int64_t) ((v >> 32) & 0xffffffffu);
+    int64_t hi = (int64_t) (v >> 64);
+    int d = p / 32;
+    if (m < 0) {
+        acc->digit[d] -= lo;
+        acc->digit[d + 1] -= mid;
+        acc->digit[d + 2] -= hi;
+    } else {
+        acc->digit[d] += lo;
+        acc->digit[d + 1] += mid;
+        acc->digit[d + 2] += hi;
+    }
+    acc->pending++;
+}
+
+void repro_merge(repro_acc_t *into, const repro_acc_t *from) {
+    repro_acc_t copy;
+    if (from->pending >= REPRO_MAX_PENDING / 2) {
+        copy = *from;
+        repro_normalize(&copy);
+        from = &copy;
+    }
+    if (into->pending + from->pending >= REPRO_MAX_PENDING) {
+        repro_normalize(into);
+    }
+    for (int i = 0; i < REPRO_DIGITS; i++) {
+        into->digit[i] += from->digit[i];
+    }
+    into->pending += from->pending;
+}
+
+void repro_normalize(repro_acc_t *acc) {
+    for (int i = 0; i < REPRO_DIGITS - 1; i++) {
+        // Floor division by 2^32, also for negative digits.
+        int64_t carry = (acc->digit[i] >= 0) ? acc->digit[i] >> 32 : -((-acc->digit[i] + 0xffffffffLL) >> 32);
+        acc->digit[i] -= carry * (1LL << 32);
+        acc->digit[i + 1] += carry;
+    }
+    acc->pending = 1;
+}
+
+double repro_result(repro_acc_t *acc) {
+    repro_acc_t magnitude = *acc;
+    repro_normalize(&magnitude);
+    int negative = magnitude.digit[REPRO_DIGITS - 1] < 0;
+    if (negative) {
+        for (int i = 0; i < REPRO_DIGITS; i++) {
+            magnitude.digit[i] = -magnitude.digit[i];
+        }
+        repro_normalize(&magnitude);
+    }
+    // All digits are now non-negative and canonical; add them from the most significant down.
+    double result = 0.0;
+    for (int i = REPRO_DIGITS - 1; i >= 0; i--) {
+        if (magnitude.digit[i] != 0) {
+            result += ldexp((double) magnitude.digit[i], 32 * i + REPRO_BASE);
+        }
+    }
+    return negative ? -result : result;
+}
+
+void repro_dot(repro_acc_t *acc, dot_kernel_fn kernel, const double *A, const double *B, long n) {
+    for (long i = 0; i < n; i += REPRO_BLOCK) {
+        long len = (n - i < REPRO_BLOCK) ? n - i : REPRO_BLOCK;
+        repro_add(acc, kernel(A + i, B + i, len));
+    }
+}
+
+void repro_range(long n, int part, int parts, long *start, long *end) {
+    long blocks = (n + REPRO_BLOCK - 1) / REPRO_BLOCK;
+    long chunk = blocks / parts;
+    long remainder = blocks % parts;
+    long first = part * chunk + (part < remainder ? part : remainder);
+    long last = first + chunk + (part < remainder ? 1 : 0);
+    *start = first * REPRO_BLOCK < n ? first * REPRO_BLOCK : n;
+    *end = last * REPRO_BLOCK < n ? last * REPRO_BLOCK : n;
+}
@@ -0,0 +1,59 @@
+// File: repro.h
+// Name: Bradley Stephen
+// Date: October 16, 2026
+// Assignment: MP1 - Reproducible Summation
+//
+// Description:
+//   Reproducible dot products: the same bits for any thread count, rank count or scheduling.
+//   The vectors are cut into fixed blocks of REPRO_BLOCK elements counted from global index 0,
+//   and every block's partial sum comes from one kernel call on exactly that block, so it does
+//   not depend on who computes it. Workers own whole blocks (repro_range), and the partials are
+//   added into an exact accumulator: a fixed-point number of REPRO_DIGITS 32-bit digits held in
+//   int64_t, wide enough for any finite double. Integer addition is associative, so accumulators
+//   can be merged in any order, across threads or with MPI_SUM on REPRO_DIGITS MPI_INT64_T,
+//   and repro_result() rounds the exact total the same way every time.
+//   The result still depends on the kernel (--kernel) and REPRO_BLOCK, which must match between
+//   runs being compared. Inputs must be finite.
+//
+#ifndef REPRO_H
+#define REPRO_H
+
+#include <stdint.h>
+#include "dot_kernels.h"
+
+// Elements per block; block b covers global indices [b * REPRO_BLOCK, (b + 1) * REPRO_BLOCK).
+#define REPRO_BLOCK 2048
+
+// Digit i weighs 2^(32 * i + REPRO_BASE); 72 digits span 2^-1152 .. 2^1152.
+#define REPRO_DIGITS 72
+#define REPRO_BASE (-1152)
+
+typedef struct {
+    int64_t digit[REPRO_DIGITS];
+    int64_t pending;  // Additions since the last carry propagation (bounds the digits' size).
+} repro_acc_t;
+
+void repro_init(repro_acc_t *acc);
+
+// Add x exactly.
+void repro_add(repro_acc_t *acc, double x);
+
+// Add the exact value of from into into.
+void repro_merge(repro_acc_t *into, const repro_acc_t *from);
+
+// Propagate carries so digits 0 .. REPRO_DIGITS-2 lie in [0, 2^32). Equal values then have equal
+// digits; accumulators must be normalized before their digits are summed with MPI.
+void repro_normalize(repro_acc_t *acc);
+
+// The accumulated value rounded to double (within an ulp, and identical for identical totals).
+double repro_result(repro_acc_t *acc);
+
+// Add the block partials of sum(A[i] * B[i]) over i in [0, n). A and B must start on a block
+// boundary of the global vectors; a last partial block is summed on its own.
+void repro_dot(repro_acc_t *acc, dot_kernel_fn kernel, const double *A, const double *B, long n);
+
+// Elements [start, end) of an n-element vector owned by part `part` of `parts` when whole blocks
+// are dealt out contiguously (the chunk + remainder split, in blocks).
+void repro_range(long n, int part, int parts, long *start, long *end);
+
+#endif
@@ -6,18 +6,77 @@
 BASE_VECTOR=1000000    
 DOT_NUM_RUNS=5
 
+# Dot product kernel variant (auto, scalar, sse, avx2, avx512)
+KERNEL=${KERNEL:-auto}
+
+# How the dot product's partial sums are combined (reduce, allreduce, iallreduce, recursive-doubling)
+COLLECTIVE=${COLLECTIVE:-reduce}
+
+# Dot product summation (fast, or repro: the same bits for any process and thread count)
+SUM=${SUM:-fast}
+
+# Input data (ones, uniform, normal, ill, sparse); see input.h
+INIT=${INIT:-uniform}
+
+# Storage format (fp64, fp32, bf16, fp16) and accumulation (fp64, fp32) of the vector and matrix
+# data; see mixed.h. The matrix-vector test needs LAYOUT=flat, DIST=local, DECOMP=1d and BATCH=1 for a narrower DTYPE.
+DTYPE=${DTYPE:-fp64}
+ACCUM=${ACCUM:-fp64}
+
+# Small-message latency sweep: elements per process and runs per point
+LATENCY_SIZES=(1 16 256)
+LATENCY_RUNS=${LATENCY_RUNS:-10000}
+
 # Base parameters for MPI Matrix-Vector Multiplication
 BASE_M=1000            
 BASE_N=1000           
 MV_NUM_RUNS=5
 
+# Number of vectors multiplied against the same matrix per run
+BATCH=${BATCH:-1}
+
+# Data distribution: local (each rank generates its own block), scatter (root scatters the global data
+# once), rescatter (root scatters again before every run) or, for matrix-vector only, pipeline (rows are
+# scattered in CHUNK-row chunks every run and computed as they arrive; the dot product uses rescatter)
+DIST=${DIST:-local}
+DOT_DIST=${DIST/pipeline/rescatter}
+CHUNK=${CHUNK:-256}
+
+# Matrix-vector decomposition: 1d (row blocks) or 2d (block-cyclic process grid, BLOCK x BLOCK blocks,
+# needs DIST=local). The grid shape is chosen by MPI_Dims_create.
+DECOMP=${DECOMP:-1d}
+BLOCK=${BLOCK:-64}
+
+# Matrix-vector storage: flat, or a generated sparse matrix (csr or sell, needs DIST=local and DECOMP=1d)
+# with its pattern (banded:W or powerlaw:D), SELL slice sort window and row split (nnz or rows); see
+# sparse.h. HALO picks how the entries of B owned by other ranks are fetched (neighbor or allgather).
+LAYOUT=${LAYOUT:-flat}
+SPARSE=${SPARSE:-banded:8}
+SIGMA=${SIGMA:-256}
+BALANCE=${BALANCE:-nnz}
+HALO=${HALO:-neighbor}
+
+# Set SHARED_B=1 to keep one copy of B per node in an MPI shared-memory window (1d only)
+SHARED_B=${SHARED_B:-0}
+MV_SHARED=$([ "$SHARED_B" = 1 ] && echo --shared-b)
+
+# Warm-up runs dropped before timing, and the machine-readable records (json or csv) for the sweep
+WARMUP=${WARMUP:-1}
+FORMAT=${FORMAT:-csv}
+RESULTS=${RESULTS:-mpi_results.$FORMAT}
+
 # Process counts to test
 PROCESS_COUNTS=(1 2 4 8 16 32)
 
+# Hybrid MPI + OpenMP sweep: CORES cores split as ranks x threads-per-rank, one rank bound to each
+# THREADS-core slot (OpenMP threads are kept on those cores with OMP_PLACES/OMP_PROC_BIND)
+CORES=${CORES:-32}
+THREADS_PER_RANK=(1 2 4 8 16 32)
+
 echo "Compiling MPI programs for Part 3..."
 
-mpicc mpi_dot_product.c -o mpi_dot_product
-mpicc mpi_matrix_vector.c -o mpi_matrix_vector
+mpicc -O2 -fopenmp mpi_dot_product.c dot_kernels.c bench.c verify.c phase_timer.c repro.c input.c mixed.c -o mpi_dot_product -lm
+mpicc -O2 -fopenmp mpi_matrix_vector.c gemv_kernels.c matrix.c dot_kernels.c bench.c verify.c phase_timer.c input.c matfile.c sparse.c halo.c mixed.c -o mpi_matrix_vector -lm
 
 echo "Compilation complete."
 
@@ -26,7 +85,7 @@ echo "Running MPI Dot Product (Strong Scaling) Tests..."
 for proc in "${PROCESS_COUNTS[@]}"; do
     echo "------------------------------------------------------------" | tee -a mpi_dot_product_strong.txt
     echo "Processes: $proc, Global Vector Size (strong): $BASE_VECTOR" | tee -a mpi_dot_product_strong.txt
-    mpirun -np $proc ./mpi_dot_product $BASE_VECTOR $DOT_NUM_RUNS | tee -a mpi_dot_product_strong.txt
+    mpirun -np $proc ./mpi_dot_product $BASE_VECTOR $DOT_NUM_RUNS --kernel=$KERNEL --scaling=strong --dist=$DOT_DIST --reduce=$COLLECTIVE --sum=$SUM --init=$INIT --dtype=$DTYPE --accum=$ACCUM --warmup=$WARMUP --format=$FORMAT --output=$RESULTS | tee -a mpi_dot_product_strong.txt
 done
 
 echo "Running MPI Dot Product (Weak Scaling) Tests..."
@@ -34,7 +93,19 @@ for proc in "${PROCESS_COUNTS[@]}"; do
     weak_vector=$(($BASE_VECTOR * proc))
     echo "------------------------------------------------------------" | tee -a mpi_dot_product_weak.txt
     echo "Processes: $proc, Global Vector Size (weak): $weak_vector" | tee -a mpi_dot_product_weak.txt
-    mpirun -np $proc ./mpi_dot_product $weak_vector $DOT_NUM_RUNS | tee -a mpi_dot_product_weak.txt
+    mpirun -np $proc ./mpi_dot_product $weak_vector $DOT_NUM_RUNS --kernel=$KERNEL --scaling=weak --dist=$DOT_DIST --reduce=$COLLECTIVE --sum=$SUM --init=$INIT --dtype=$DTYPE --accum=$ACCUM --warmup=$WARMUP --format=$FORMAT --output=$RESULTS | tee -a mpi_dot_product_weak.txt
+done
+
+echo "Running MPI Dot Product Small-Message Latency Sweep..."
+for collective in reduce allreduce iallreduce recursive-doubling; do
+    for proc in "${PROCESS_COUNTS[@]}"; do
+        for per_rank in "${LATENCY_SIZES[@]}"; do
+            tiny_vector=$(($per_rank * proc))
+            echo "------------------------------------------------------------" | tee -a mpi_dot_latency.txt
+            echo "Processes: $proc, Reduction: $collective, Global Vector Size: $tiny_vector" | tee -a mpi_dot_latency.txt
+            mpirun -np $proc ./mpi_dot_product $tiny_vector $LATENCY_RUNS --kernel=$KERNEL --scaling=latency --reduce=$collective --init=$INIT --dtype=$DTYPE --accum=$ACCUM --warmup=$WARMUP --format=$FORMAT --output=$RESULTS | tee -a mpi_dot_latency.txt
+        done
+    done
 done
 
 # MPI Matrix-Vector Multiplication Tests
@@ -42,7 +113,7 @@ echo "Running MPI Matrix-Vector Multiplication (Strong Scaling) Tests..."
 for proc in "${PROCESS_COUNTS[@]}"; do
     echo "------------------------------------------------------------" | tee -a mpi_matrix_vector_strong.txt
     echo "Processes: $proc, Global Matrix Size (strong): ${BASE_M}x${BASE_N}" | tee -a mpi_matrix_vector_strong.txt
-    mpirun -np $proc ./mpi_matrix_vector $BASE_M $BASE_N strong $MV_NUM_RUNS | tee -a mpi_matrix_vector_strong.txt
+    mpirun -np $proc ./mpi_matrix_vector $BASE_M $BASE_N strong $MV_NUM_RUNS --batch=$BATCH --dist=$DIST --chunk=$CHUNK --decomp=$DECOMP --block=$BLOCK $MV_SHARED --layout=$LAYOUT --sparse=$SPARSE --sigma=$SIGMA --balance=$BALANCE --halo=$HALO --init=$INIT --dtype=$DTYPE --accum=$ACCUM --warmup=$WARMUP --format=$FORMAT --output=$RESULTS | tee -a mpi_matrix_vector_strong.txt
 done
 
 echo "Running MPI Matrix-Vector Multiplication (Weak Scaling) Tests..."
@@ -51,7 +122,21 @@ for proc in "${PROCESS_COUNTS[@]}"; do
     EFFECTIVE_M=$(($BASE_M * proc))
     echo "------------------------------------------------------------" | tee -a mpi_matrix_vector_weak.txt
     echo "Processes: $proc, Global Matrix Size (weak): ${EFFECTIVE_M}x${BASE_N}" | tee -a mpi_matrix_vector_weak.txt
-    mpirun -np $proc ./mpi_matrix_vector $BASE_M $BASE_N weak $MV_NUM_RUNS | tee -a mpi_matrix_vector_weak.txt
+    mpirun -np $proc ./mpi_matrix_vector $BASE_M $BASE_N weak $MV_NUM_RUNS --batch=$BATCH --dist=$DIST --chunk=$CHUNK --decomp=$DECOMP --block=$BLOCK $MV_SHARED --layout=$LAYOUT --sparse=$SPARSE --sigma=$SIGMA --balance=$BALANCE --halo=$HALO --init=$INIT --dtype=$DTYPE --accum=$ACCUM --warmup=$WARMUP --format=$FORMAT --output=$RESULTS | tee -a mpi_matrix_vector_weak.txt
+done
+
+echo "Running Hybrid MPI + OpenMP (Strong Scaling, $CORES cores) Tests..."
+for threads in "${THREADS_PER_RANK[@]}"; do
+    if [ $(($CORES % $threads)) -ne 0 ]; then
+        continue
+    fi
+    ranks=$(($CORES / $threads))
+    echo "------------------------------------------------------------" | tee -a mpi_hybrid.txt
+    echo "Ranks: $ranks, Threads per rank: $threads" | tee -a mpi_hybrid.txt
+    OMP_PLACES=cores OMP_PROC_BIND=close mpirun -np $ranks --map-by slot:PE=$threads --bind-to core -x OMP_PLACES -x OMP_PROC_BIND \
+        ./mpi_dot_product $BASE_VECTOR $DOT_NUM_RUNS --kernel=$KERNEL --scaling=strong --dist=$DOT_DIST --reduce=$COLLECTIVE --sum=$SUM --threads=$threads --init=$INIT --dtype=$DTYPE --accum=$ACCUM --warmup=$WARMUP --format=$FORMAT --output=$RESULTS | tee -a mpi_hybrid.txt
+    OMP_PLACES=cores OMP_PROC_BIND=close mpirun -np $ranks --map-by slot:PE=$threads --bind-to core -x OMP_PLACES -x OMP_PROC_BIND \
+        ./mpi_matrix_vector $BASE_M $BASE_N strong $MV_NUM_RUNS --batch=$BATCH --dist=$DIST --chunk=$CHUNK --decomp=$DECOMP --block=$BLOCK $MV_SHARED --layout=$LAYOUT --sparse=$SPARSE --sigma=$SIGMA --balance=$BALANCE --halo=$HALO --threads=$threads --init=$INIT --dtype=$DTYPE --accum=$ACCUM --warmup=$WARMUP --format=$FORMAT --output=$RESULTS | tee -a mpi_hybrid.txt
 done
 
 echo "MPI tests complete lets go."
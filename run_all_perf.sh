@@ -8,15 +8,69 @@ MAT_BASE_M=1000
 MAT_BASE_N=1000        
 NUM_RUNS=5                  
 
+# Dot product kernel variant (auto, scalar, sse, avx2, avx512); override with KERNEL=... ./run_all_perf.sh
+KERNEL=${KERNEL:-auto}
+
+# Pthreads dispatch (pool: persistent workers, spawn: pthread_create per run)
+DISPATCH=${DISPATCH:-pool}
+
+# Pthreads reduction (mutex, atomic, slots, tree)
+REDUCE=${REDUCE:-tree}
+
+# Thread placement: pthreads pinning policy (none, compact, spread), OpenMP binding through
+# OMP_PLACES/OMP_PROC_BIND, and who first-touches the data (serial or parallel)
+PIN=${PIN:-compact}
+export OMP_PLACES=${OMP_PLACES:-cores}
+export OMP_PROC_BIND=${OMP_PROC_BIND:-close}
+FIRST_TOUCH=${FIRST_TOUCH:-parallel}
+
+# Summation (fast, or repro: bit-identical results for any thread count, timed against fast)
+SUM=${SUM:-fast}
+
+# Input data (ones, uniform, normal, ill, sparse); see input.h
+INIT=${INIT:-uniform}
+
+# Storage format (fp64, fp32, bf16, fp16) and accumulation (fp64, fp32) of the vector and matrix
+# data; see mixed.h. The matrix-vector test needs LAYOUT=flat, MV_KERNEL=blocked and BATCH=1 for a narrower DTYPE.
+DTYPE=${DTYPE:-fp64}
+ACCUM=${ACCUM:-fp64}
+
+# Data allocation: reuse (allocate and warm once from a huge-page arena) or cold (every run)
+ALLOC=${ALLOC:-reuse}
+
+# Matrix storage for the matrix-vector test (flat, rowptr, or the sparse csr and sell)
+LAYOUT=${LAYOUT:-flat}
+
+# Sparse matrices (LAYOUT=csr or sell): pattern (banded:W or powerlaw:D), SELL slice sort window,
+# and whether the threads' parts balance nonzeros or rows (nnz or rows); see sparse.h
+SPARSE=${SPARSE:-banded:8}
+SIGMA=${SIGMA:-256}
+BALANCE=${BALANCE:-nnz}
+
+# Matrix-vector loop (naive or blocked; blocked needs LAYOUT=flat)
+MV_KERNEL=${MV_KERNEL:-naive}
+
+# Number of vectors multiplied against the same matrix per run
+BATCH=${BATCH:-1}
+
+# Loop schedule for the Pthreads dot product and the matrix-vector test (static, dynamic, guided or
+# steal, each with an optional :C chunk size); see schedule.h
+SCHEDULE=${SCHEDULE:-static}
+
+# Warm-up runs dropped before timing, and the machine-readable records (json or csv) for the sweep
+WARMUP=${WARMUP:-1}
+FORMAT=${FORMAT:-csv}
+RESULTS=${RESULTS:-perf_results.$FORMAT}
+
 # Thread counts to test
 THREADS=(1 2 4 8 16 32)
 
 echo "Compiling performance evaluation codes..."
 
 # Compile the dot product tests for Pthreads and OpenMP, and the matrix-vector multiplication test
-gcc -fopenmp perf_dot_product_omp.c -o perf_dot_product_omp
-gcc perf_dot_product_pthreads.c -o perf_dot_product_pthreads -lpthread
-gcc -fopenmp perf_matrix_vector_omp.c -o perf_matrix_vector_omp
+gcc -O2 -fopenmp perf_dot_product_omp.c dot_kernels.c affinity.c arena.c bench.c verify.c repro.c input.c mixed.c -o perf_dot_product_omp -lm
+gcc -O2 perf_dot_product_pthreads.c dot_kernels.c thread_pool.c reduce.c affinity.c arena.c bench.c verify.c repro.c input.c mixed.c schedule.c -o perf_dot_product_pthreads -lpthread -lm
+gcc -O2 -fopenmp perf_matrix_vector_omp.c matrix.c gemv_kernels.c dot_kernels.c affinity.c arena.c bench.c verify.c input.c matfile.c sparse.c mixed.c schedule.c -o perf_matrix_vector_omp -lm
 
 echo "Compilation complete."
 
@@ -24,35 +78,35 @@ echo "Running performance tests for Dot Product (Pthreads) - Strong Scaling"
 for t in "${THREADS[@]}"; do
     echo "------------------------------------------------------------" | tee -a perf_dot_product_pthreads_strong.txt
     echo "Threads: $t, Vector Size (strong): $DOT_BASE_SIZE" | tee -a perf_dot_product_pthreads_strong.txt
-    ./perf_dot_product_pthreads $t $DOT_BASE_SIZE strong $NUM_RUNS | tee -a perf_dot_product_pthreads_strong.txt
+    ./perf_dot_product_pthreads $t $DOT_BASE_SIZE strong $NUM_RUNS --kernel=$KERNEL --dispatch=$DISPATCH --reduce=$REDUCE --pin=$PIN --first-touch=$FIRST_TOUCH --sum=$SUM --alloc=$ALLOC --init=$INIT --dtype=$DTYPE --accum=$ACCUM --schedule=$SCHEDULE --warmup=$WARMUP --format=$FORMAT --output=$RESULTS | tee -a perf_dot_product_pthreads_strong.txt
 done
 
 echo "Running performance tests for Dot Product (Pthreads) - Weak Scaling"
 for t in "${THREADS[@]}"; do
     echo "------------------------------------------------------------" | tee -a perf_dot_product_pthreads_weak.txt
     echo "Threads: $t, Vector Size (weak): $(($DOT_BASE_SIZE * t))" | tee -a perf_dot_product_pthreads_weak.txt
-    ./perf_dot_product_pthreads $t $DOT_BASE_SIZE weak $NUM_RUNS | tee -a perf_dot_product_pthreads_weak.txt
+    ./perf_dot_product_pthreads $t $DOT_BASE_SIZE weak $NUM_RUNS --kernel=$KERNEL --dispatch=$DISPATCH --reduce=$REDUCE --pin=$PIN --first-touch=$FIRST_TOUCH --sum=$SUM --alloc=$ALLOC --init=$INIT --dtype=$DTYPE --accum=$ACCUM --schedule=$SCHEDULE --warmup=$WARMUP --format=$FORMAT --output=$RESULTS | tee -a perf_dot_product_pthreads_weak.txt
 done
 
 echo "Running performance tests for Dot Product (OpenMP) - Strong Scaling"
 for t in "${THREADS[@]}"; do
     echo "------------------------------------------------------------" | tee -a perf_dot_product_omp_strong.txt
     echo "Threads: $t, Vector Size (strong): $DOT_BASE_SIZE" | tee -a perf_dot_product_omp_strong.txt
-    ./perf_dot_product_omp $t $DOT_BASE_SIZE strong $NUM_RUNS | tee -a perf_dot_product_omp_strong.txt
+    ./perf_dot_product_omp $t $DOT_BASE_SIZE strong $NUM_RUNS --kernel=$KERNEL --first-touch=$FIRST_TOUCH --sum=$SUM --alloc=$ALLOC --init=$INIT --dtype=$DTYPE --accum=$ACCUM --warmup=$WARMUP --format=$FORMAT --output=$RESULTS | tee -a perf_dot_product_omp_strong.txt
 done
 
 echo "Running performance tests for Dot Product (OpenMP) - Weak Scaling"
 for t in "${THREADS[@]}"; do
     echo "------------------------------------------------------------" | tee -a perf_dot_product_omp_weak.txt
     echo "Threads: $t, Vector Size (weak): $(($DOT_BASE_SIZE * t))" | tee -a perf_dot_product_omp_weak.txt
-    ./perf_dot_product_omp $t $DOT_BASE_SIZE weak $NUM_RUNS | tee -a perf_dot_product_omp_weak.txt
+    ./perf_dot_product_omp $t $DOT_BASE_SIZE weak $NUM_RUNS --kernel=$KERNEL --first-touch=$FIRST_TOUCH --sum=$SUM --alloc=$ALLOC --init=$INIT --dtype=$DTYPE --accum=$ACCUM --warmup=$WARMUP --format=$FORMAT --output=$RESULTS | tee -a perf_dot_product_omp_weak.txt
 done
 
 echo "Running performance tests for Matrix-Vector Multiplication (OpenMP) - Strong Scaling"
 for t in "${THREADS[@]}"; do
     echo "------------------------------------------------------------" | tee -a perf_matrix_vector_omp_strong.txt
     echo "Threads: $t, Matrix Size (strong): ${MAT_BASE_M}x${MAT_BASE_N}" | tee -a perf_matrix_vector_omp_strong.txt
-    ./perf_matrix_vector_omp $t $MAT_BASE_M $MAT_BASE_N strong $NUM_RUNS | tee -a perf_matrix_vector_omp_strong.txt
+    ./perf_matrix_vector_omp $t $MAT_BASE_M $MAT_BASE_N strong $NUM_RUNS --layout=$LAYOUT --sparse=$SPARSE --sigma=$SIGMA --balance=$BALANCE --kernel=$MV_KERNEL --batch=$BATCH --first-touch=$FIRST_TOUCH --alloc=$ALLOC --init=$INIT --dtype=$DTYPE --accum=$ACCUM --schedule=$SCHEDULE --warmup=$WARMUP --format=$FORMAT --output=$RESULTS | tee -a perf_matrix_vector_omp_strong.txt
 done
 
 echo "Running performance tests for Matrix-Vector Multiplication (OpenMP) - Weak Scaling"
@@ -61,7 +115,7 @@ for t in "${THREADS[@]}"; do
     EFFECTIVE_M=$(($MAT_BASE_M * t))
     echo "------------------------------------------------------------" | tee -a perf_matrix_vector_omp_weak.txt
     echo "Threads: $t, Matrix Size (weak): ${EFFECTIVE_M}x${MAT_BASE_N}" | tee -a perf_matrix_vector_omp_weak.txt
-    ./perf_matrix_vector_omp $t $MAT_BASE_M $MAT_BASE_N weak $NUM_RUNS | tee -a perf_matrix_vector_omp_weak.txt
+    ./perf_matrix_vector_omp $t $MAT_BASE_M $MAT_BASE_N weak $NUM_RUNS --layout=$LAYOUT --sparse=$SPARSE --sigma=$SIGMA --balance=$BALANCE --kernel=$MV_KERNEL --batch=$BATCH --first-touch=$FIRST_TOUCH --alloc=$ALLOC --init=$INIT --dtype=$DTYPE --accum=$ACCUM --schedule=$SCHEDULE --warmup=$WARMUP --format=$FORMAT --output=$RESULTS | tee -a perf_matrix_vector_omp_weak.txt
 done
 
 echo "Tets Complete lets gooo"
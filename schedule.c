@@ -0,0 +1,279 @@
+// File: schedule.c
+// Name: Bradley Stephen
+// Date: October 16, 2026
+// Assignment: MP1 - Loop Scheduling
+//
+// Description:
+//   Implementation of schedule.h. A steal deque is a range of chunk indices packed into one 64-bit
+//   word, so the owner taking the front chunk and a thief cutting off the back half are both a
+//   single compare-and-swap on it, and neither needs a lock. A stolen range is taken out of the
+//   victim's deque before the thief publishes it in its own (now empty) deque, so every chunk is in
+//   at most one deque and is run exactly once. Work only ever moves between deques, so a thread
+//   that finds every deque empty can stop: the rest belongs to threads still running.
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "schedule.h"
+
+#define DEQUE(first, last) (((uint64_t) (last) << 32) | (uint64_t) (first))
+#define DEQUE_FIRST(d) ((uint32_t) (d))
+#define DEQUE_LAST(d) ((uint32_t) ((d) >> 32))
+
+static const char *kind_names[] = { "static", "dynamic", "guided", "steal" };
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ull + (uint64_t) ts.tv_nsec;
+}
+
+// Share [*first, *last) of n items for part p of parts (the drivers' chunk formula).
+static void share(long n, int p, int parts, long *first, long *last) {
+    long chunk = n / parts;
+    long remainder = n % parts;
+    *first = p * chunk + (p < remainder ? p : remainder);
+    *last = *first + chunk + (p < remainder ? 1 : 0);
+}
+
+void sched_defaults(sched_opts_t *o) {
+    o->kind = SCHED_STATIC;
+    o->chunk = 0;
+}
+
+int sched_parse_arg(sched_opts_t *o, const char *arg) {
+    if (strncmp(arg, "--schedule=", 11) != 0) {
+        return 0;
+    }
+    const char *value = arg + 11;
+    const char *colon = strchr(value, ':');
+    size_t len = colon ? (size_t) (colon - value) : strlen(value);
+    int kind = -1;
+    for (int k = 0; k < 4; k++) {
+        if (strlen(kind_names[k]) == len && strncmp(value, kind_names[k], len) == 0) {
+            kind = k;
+        }
+    }
+    long chunk = 0;
+    if (colon) {
+        char *end;
+        chunk = strtol(colon + 1, &end, 10);
+        if (*end != '\0' || chunk < 1) {
+            return -1;
+        }
+    }
+    if (kind < 0) {
+        return -1;
+    }
+    o->kind = (sched_kind_t) kind;
+    o->chunk = chunk;
+    return 1;
+}
+
+void sched_name(const sched_opts_t *o, char *buf, int size) {
+    if (o->chunk > 0)
+        snprintf(buf, size, "%s:%ld", kind_names[o->kind], o->chunk);
+    else
+        snprintf(buf, size, "%s", kind_names[o->kind]);
+}
+
+int sched_init(sched_t *s, const sched_opts_t *o, int nthreads) {
+    memset(s, 0, sizeof(*s));
+    s->opts = *o;
+    s->nthreads = nthreads;
+    s->team = nthreads;
+    atomic_init(&s->claimed, 0);
+    if (posix_memalign((void**) &s->slots, SCHED_CACHE_LINE, nthreads * sizeof(sched_slot_t)) != 0) {
+        s->slots = NULL;
+        return -1;
+    }
+    memset(s->slots, 0, nthreads * sizeof(sched_slot_t));
+    for (int t = 0; t < nthreads; t++) {
+        atomic_init(&s->slots[t].deque, 0);
+    }
+    return 0;
+}
+
+void sched_start(sched_t *s, long n, int team) {
+    s->n = n;
+    s->team = (team < 1) ? 1 : (team > s->nthreads) ? s->nthreads : team;
+    s->chunk = s->opts.chunk;
+    if (s->chunk == 0) {
+        long parts = (long) s->team * (s->opts.kind == SCHED_STATIC ? 1 : SCHED_AUTO_CHUNKS);
+        s->chunk = (n + parts - 1) / parts;
+    }
+    if (s->chunk < 1) {
+        s->chunk = 1;
+    }
+    long chunks = (n + s->chunk - 1) / s->chunk;
+    if (s->opts.kind == SCHED_STEAL && chunks > UINT32_MAX) {
+        // Chunk indices must fit the deque's 32-bit halves.
+        s->chunk = (n + UINT32_MAX - 1) / UINT32_MAX;
+        chunks = (n + s->chunk - 1) / s->chunk;
+    }
+    atomic_store_explicit(&s->claimed, 0, memory_order_relaxed);
+    for (int t = 0; t < s->nthreads; t++) {
+        // Threads outside the team get nothing, so no work is left waiting for them.
+        sched_slot_t *slot = &s->slots[t];
+        slot->state = 0;
+        if (t >= s->team) {
+            slot->next = slot->end = 0;
+            atomic_store_explicit(&slot->deque, 0, memory_order_relaxed);
+        } else if (sched_is_static(&s->opts)) {
+            share(n, t, s->team, &slot->next, &slot->end);
+        } else if (s->opts.kind == SCHED_STATIC) {
+            slot->next = t;
+            slot->end = chunks;
+        } else if (s->opts.kind == SCHED_STEAL) {
+            long first, last;
+            share(chunks, t, s->team, &first, &last);
+            atomic_store_explicit(&slot->deque, DEQUE(first, last), memory_order_relaxed);
+        }
+    }
+}
+
+// Take the front chunk of a deque.
+static int deque_pop(sched_slot_t *slot, long *chunk) {
+    uint64_t d = atomic_load_explicit(&slot->deque, memory_order_relaxed);
+    while (DEQUE_FIRST(d) < DEQUE_LAST(d)) {
+        if (atomic_compare_exchange_weak_explicit(&slot->deque, &d, d + 1, memory_order_relaxed,
+                                                  memory_order_relaxed)) {
+            *chunk = DEQUE_FIRST(d);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Cut the back half off the first non-empty deque after tid's, run its first chunk now and keep
+// the rest in tid's deque.
+static int deque_steal(sched_t *s, int tid, long *chunk) {
+    for (int k = 1; k < s->team; k++) {
+        sched_slot_t *victim = &s->slots[(tid + k) % s->team];
+        uint64_t d = atomic_load_explicit(&victim->deque, memory_order_relaxed);
+        while (DEQUE_FIRST(d) < DEQUE_LAST(d)) {
+            uint32_t first = DEQUE_FIRST(d), last = DEQUE_LAST(d);
+            uint32_t mid = last - (last - first + 1) / 2;
+            if (atomic_compare_exchange_weak_explicit(&victim->deque, &d, DEQUE(first, mid), memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                atomic_store_explicit(&s->slots[tid].deque, DEQUE(mid + 1, last), memory_order_relaxed);
+                s->slots[tid].steals++;
+                *chunk = mid;
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+int sched_next(sched_t *s, int tid, long *begin, long *end) {
+    sched_slot_t *slot = &s->slots[tid];
+    if (slot->state == 2) {
+        return 0;
+    }
+    if (slot->state == 0) {
+        slot->since = now_ns();
+        slot->state = 1;
+        slot->loops++;
+    }
+    long first = 0, size = 0;
+    switch (s->opts.kind) {
+    case SCHED_STATIC:
+        if (sched_is_static(&s->opts)) {
+            first = slot->next;
+            size = slot->end - slot->next;
+            slot->next = slot->end;
+        } else if (slot->next < slot->end) {
+            first = slot->next * s->chunk;
+            size = s->chunk;
+            slot->next += s->team;
+        }
+        break;
+    case SCHED_DYNAMIC:
+        first = atomic_fetch_add_explicit(&s->claimed, s->chunk, memory_order_relaxed);
+        size = s->chunk;
+        break;
+    case SCHED_GUIDED: {
+        first = atomic_load_explicit(&s->claimed, memory_order_relaxed);
+        do {
+            size = (s->n - first) / s->team;
+            if (size < s->chunk)
+                size = s->chunk;
+        } while (first < s->n && !atomic_compare_exchange_weak_explicit(&s->claimed, &first, first + size,
+                                                                         memory_order_relaxed, memory_order_relaxed));
+        break;
+    }
+    case SCHED_STEAL: {
+        long chunk;
+        if (deque_pop(slot, &chunk) || deque_steal(s, tid, &chunk)) {
+            first = chunk * s->chunk;
+            size = s->chunk;
+        }
+        break;
+    }
+    }
+    if (size <= 0 || first >= s->n) {
+        slot->busy_ns += now_ns() - slot->since;
+        slot->state = 2;
+        return 0;
+    }
+    *begin = first;
+    *end = (first + size < s->n) ? first + size : s->n;
+    slot->chunks++;
+    return 1;
+}
+
+void sched_clear(sched_t *s) {
+    for (int t = 0; t < s->nthreads; t++) {
+        s->slots[t].busy_ns = 0;
+        s->slots[t].chunks = 0;
+        s->slots[t].steals = 0;
+        s->slots[t].loops = 0;
+    }
+}
+
+void sched_report(const sched_t *s, const char *unit, int runs) {
+    if (runs < 1) {
+        runs = 1;
+    }
+    char name[32];
+    sched_name(&s->opts, name, sizeof(name));
+    long chunks = 0, steals = 0;
+    double max = 0.0, sum = 0.0;
+    int active = 0;
+    for (int t = 0; t < s->nthreads; t++) {
+        chunks += s->slots[t].chunks;
+        steals += s->slots[t].steals;
+        if (s->slots[t].loops == 0) {
+            continue;  // Never in the team: not part of the imbalance.
+        }
+        double us = s->slots[t].busy_ns / 1e3 / runs;
+        max = (us > max) ? us : max;
+        sum += us;
+        active++;
+    }
+    if (sched_is_static(&s->opts) && unit)
+        printf("Schedule: static, one share of about %ld %s per thread\n", s->chunk, unit);
+    else if (sched_is_static(&s->opts))
+        printf("Schedule: static, one share per thread\n");
+    else if (s->opts.kind == SCHED_STEAL)
+        printf("Schedule: %s, chunks of %ld %s, %.1f chunks and %.1f steals per run\n", name, s->chunk, unit,
+               (double) chunks / runs, (double) steals / runs);
+    else
+        printf("Schedule: %s, chunks of %ld %s, %.1f chunks per run\n", name, s->chunk, unit, (double) chunks / runs);
+    printf("Busy (us per run):");
+    for (int t = 0; t < s->nthreads; t++) {
+        printf(" t%d=%.1f", t, s->slots[t].busy_ns / 1e3 / runs);
+    }
+    if (active < s->nthreads) {
+        printf(" (%d of %d threads ran)", active, s->nthreads);
+    }
+    double mean = active > 0 ? sum / active : 0.0;
+    printf(", max %.1f, mean %.1f, imbalance %.1f%%\n", max, mean, mean > 0.0 ? 100.0 * (max / mean - 1.0) : 0.0);
+}
+
+void sched_destroy(sched_t *s) {
+    free(s->slots);
+    s->slots = NULL;
+}
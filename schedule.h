@@ -0,0 +1,96 @@
+// File: schedule.h
+// Name: Bradley Stephen
+// Date: October 16, 2026
+// Assignment: MP1 - Loop Scheduling
+//
+// Description:
+//   Selectable ways to hand the items of a parallel loop (rows, slices or vector elements) to
+//   threads, for any back end: OpenMP threads and pthread workers call the same sched_next().
+//     static[:C]  - one contiguous share per thread (the drivers' original split), or with C,
+//                   chunks of C items dealt round-robin
+//     dynamic[:C] - chunks of C items claimed in order from a shared counter
+//     guided[:C]  - like dynamic, but each chunk is the remaining items / threads, at least C
+//     steal[:C]   - every thread starts with a deque holding its static share of C-item chunks,
+//                   takes chunks from the front, and when it runs dry steals the back half of
+//                   another thread's deque, so work moves only when a thread is actually idle
+//   Without C the chunk is n / (SCHED_AUTO_CHUNKS * threads) items. Uniform rows gain nothing from
+//   moving work, but rows of uneven cost (sparse, triangular) or cores of uneven speed do.
+//   Each thread's busy time (from its first request for work to finding none left) is recorded,
+//   so the idle time at the end of a loop, the imbalance, is visible.
+//   Every loop is split among the team that actually runs it, which may be smaller than the
+//   threads the scheduler was set up for (an OpenMP team under OMP_DYNAMIC or a thread limit).
+//
+#ifndef SCHEDULE_H
+#define SCHEDULE_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+#define SCHED_CACHE_LINE 64
+#define SCHED_AUTO_CHUNKS 16  // Chunks per thread when no chunk size is given.
+
+typedef enum { SCHED_STATIC, SCHED_DYNAMIC, SCHED_GUIDED, SCHED_STEAL } sched_kind_t;
+
+typedef struct {
+    sched_kind_t kind;
+    long chunk;  // Items per chunk (the smallest chunk for guided), or 0 for the default.
+} sched_opts_t;
+
+// One thread's state, on its own cache line.
+typedef struct {
+    _Atomic uint64_t deque;  // steal: chunks [low 32 bits, high 32 bits) not taken yet.
+    long next, end;          // static: next item (or chunk with C) of this thread, and its end.
+    int state;               // 0 before the thread's first request in a loop, 1 working, 2 done.
+    uint64_t since;          // When the thread asked for its first chunk of the loop.
+    uint64_t busy_ns;        // Totals since sched_clear().
+    long chunks, steals;
+    long loops;              // Loops the thread took part in since sched_clear().
+} __attribute__((aligned(SCHED_CACHE_LINE))) sched_slot_t;
+
+typedef struct {
+    sched_opts_t opts;
+    int nthreads;
+    int team;       // Threads running the current loop, tids 0 .. team-1 (at most nthreads).
+    long n, chunk;  // Items and chunk size of the current loop.
+    sched_slot_t *slots;
+    _Alignas(SCHED_CACHE_LINE) _Atomic long claimed;  // dynamic, guided: items handed out so far.
+} sched_t;
+
+// Set the defaults (static: the drivers' original split).
+void sched_defaults(sched_opts_t *o);
+
+// Consume --schedule=static|dynamic|guided|steal[:C]. Returns 1 if arg was one, 0 if it is not
+// ours, -1 if its value is bad (the bench_parse_arg() convention).
+int sched_parse_arg(sched_opts_t *o, const char *arg);
+
+// "steal:64", or "guided" when the chunk is the default.
+void sched_name(const sched_opts_t *o, char *buf, int size);
+
+// 1 for static without a chunk size: one contiguous share per thread, in thread order.
+static inline int sched_is_static(const sched_opts_t *o) {
+    return o->kind == SCHED_STATIC && o->chunk == 0;
+}
+
+// Set up a scheduler for loops run by nthreads threads. Returns 0 on success, -1 on failure.
+int sched_init(sched_t *s, const sched_opts_t *o, int nthreads);
+
+// Prepare a loop over items [0, n) run by team threads (at most nthreads). Call from one thread
+// before the threads start on it, e.g. from an omp single with omp_get_num_threads(); every one of
+// the team threads must then call sched_next() until it returns 0.
+void sched_start(sched_t *s, long n, int team);
+
+// Give thread tid its next chunk [*begin, *end). Returns 1, or 0 once no work is left for it.
+int sched_next(sched_t *s, int tid, long *begin, long *end);
+
+// Zero the busy times and counts (e.g. after the warm-up runs).
+void sched_clear(sched_t *s);
+
+// Print the schedule, chunks (and steals for steal), and every thread's busy time per run over `runs` runs:
+// "Busy (us per run): t0=1234.5 t1=... max 1300.0, mean 1200.0, imbalance 8.3%" (max / mean - 1, over
+// the threads that took part). unit names the items ("rows"), or is NULL when the static shares are
+// not of a fixed size.
+void sched_report(const sched_t *s, const char *unit, int runs);
+
+void sched_destroy(sched_t *s);
+
+#endif
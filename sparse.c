@@ -0,0 +1,331 @@
+// File: sparse.c
+// Name: Bradley Stephen
+// Date: October 16, 2026
+// Assignment: MP1 - Sparse Matrix-Vector Multiplication
+//
+// Description:
+//   Implementation of sparse.h. The SELL slice kernels are dispatched at runtime like the GEMV
+//   kernels: AVX-512 multiplies a whole slice column with one 8-wide gather of B and one FMA,
+//   AVX2 with two 4-wide halves. Power-law columns are placed by stratified sampling: entry k of
+//   a row of length L falls in the k-th of L equal strata before the skew is applied, then is
+//   pushed past its predecessor, so a row never repeats a column and needs no sort.
+//
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sparse.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SPARSE_X86 1
+#include <immintrin.h>
+#endif
+
+void sparse_defaults(sparse_opts_t *o) {
+    o->pattern = SPARSE_BANDED;
+    o->param = SPARSE_DEFAULT_BAND;
+    o->sigma = SPARSE_DEFAULT_SIGMA;
+    o->balance_nnz = 1;
+}
+
+int sparse_parse_arg(sparse_opts_t *o, const char *arg) {
+    if (strncmp(arg, "--sparse=", 9) == 0) {
+        int param;
+        char tail;
+        if (sscanf(arg + 9, "banded:%d%c", &param, &tail) == 1 && param >= 0) {
+            o->pattern = SPARSE_BANDED;
+        } else if (sscanf(arg + 9, "powerlaw:%d%c", &param, &tail) == 1 && param >= 1) {
+            o->pattern = SPARSE_POWERLAW;
+        } else {
+            return -1;
+        }
+        o->param = param;
+        return 1;
+    } else if (strncmp(arg, "--sigma=", 8) == 0) {
+        int sigma = atoi(arg + 8);
+        if (sigma < SELL_C || sigma % SELL_C != 0) {
+            return -1;
+        }
+        o->sigma = sigma;
+        return 1;
+    } else if (strncmp(arg, "--balance=", 10) == 0) {
+        if (strcmp(arg + 10, "nnz") == 0) {
+            o->balance_nnz = 1;
+        } else if (strcmp(arg + 10, "rows") == 0) {
+            o->balance_nnz = 0;
+        } else {
+            return -1;
+        }
+        return 1;
+    }
+    return 0;
+}
+
+void sparse_name(const sparse_opts_t *o, char *buf, size_t size) {
+    snprintf(buf, size, "%s:%d", o->pattern == SPARSE_BANDED ? "banded" : "powerlaw", o->param);
+}
+
+// Band of global row `row`: columns [*first, *first + length).
+static long band(const sparse_opts_t *o, long global_rows, int cols, long row, long *first) {
+    long center = (long) ((double) row * cols / global_rows);
+    long lo = (center - o->param > 0) ? center - o->param : 0;
+    long hi = (center + o->param < cols - 1) ? center + o->param : cols - 1;
+    *first = lo;
+    return hi - lo + 1;
+}
+
+// Nonzeros of global row `row`.
+static long row_length(const sparse_opts_t *o, const input_t *in, long global_rows, int cols, long row) {
+    if (o->pattern == SPARSE_BANDED) {
+        long first;
+        return band(o, global_rows, cols, row, &first);
+    }
+    // Pareto with scale D * (shape - 1) / shape has mean D; the cap at cols lowers it slightly.
+    double scale = o->param * (SPARSE_POWERLAW_SHAPE - 1.0) / SPARSE_POWERLAW_SHAPE;
+    double u = input_unit(in, INPUT_PATTERN, row, 0);
+    double length = ceil(scale * pow(1.0 - u, -1.0 / SPARSE_POWERLAW_SHAPE));
+    return (length < 1.0) ? 1 : (length > cols) ? cols : (long) length;
+}
+
+int csr_alloc(csr_t *A, const sparse_opts_t *o, const input_t *in, long global_rows, int cols, long row_first,
+              int rows) {
+    memset(A, 0, sizeof(*A));
+    A->rows = rows;
+    A->cols = cols;
+    A->global_rows = global_rows;
+    A->row_first = row_first;
+    A->row_ptr = (long*) malloc((size_t) (rows + 1) * sizeof(long));
+    if (!A->row_ptr) {
+        return -1;
+    }
+    A->row_ptr[0] = 0;
+#pragma omp parallel for schedule(static)
+    for (int i = 0; i < rows; i++) {
+        A->row_ptr[i + 1] = row_length(o, in, global_rows, cols, row_first + i);
+    }
+    for (int i = 0; i < rows; i++) {
+        A->row_ptr[i + 1] += A->row_ptr[i];
+    }
+    A->nnz = A->row_ptr[rows];
+    A->col = (int*) malloc((size_t) (A->nnz > 0 ? A->nnz : 1) * sizeof(int));
+    A->val = (double*) malloc((size_t) (A->nnz > 0 ? A->nnz : 1) * sizeof(double));
+    return (A->col && A->val) ? 0 : -1;
+}
+
+void csr_fill(csr_t *A, const sparse_opts_t *o, const input_t *in, int row_begin, int row_end) {
+    for (int i = row_begin; i < row_end; i++) {
+        long row = A->row_first + i;
+        long length = A->row_ptr[i + 1] - A->row_ptr[i];
+        int *col = A->col + A->row_ptr[i];
+        double *val = A->val + A->row_ptr[i];
+        if (o->pattern == SPARSE_BANDED) {
+            long first;
+            band(o, A->global_rows, A->cols, row, &first);
+            for (long k = 0; k < length; k++) {
+                col[k] = (int) (first + k);
+            }
+        } else {
+            long prev = -1;
+            for (long k = 0; k < length; k++) {
+                double t = (k + input_unit(in, INPUT_PATTERN, row, k + 1)) / length;
+                long c = (long) (A->cols * pow(t, SPARSE_POWERLAW_SKEW));
+                c = (c > prev) ? c : prev + 1;
+                c = (c < A->cols - (length - k)) ? c : A->cols - (length - k);
+                col[k] = (int) c;
+                prev = c;
+            }
+        }
+        for (long k = 0; k < length; k++) {
+            val[k] = input_value(in, INPUT_A, row, col[k]);
+        }
+    }
+}
+
+void csr_spmv(const csr_t *A, const double *x, double *y, int row_begin, int row_end) {
+    for (int i = row_begin; i < row_end; i++) {
+        double sum = 0.0;
+        for (long p = A->row_ptr[i]; p < A->row_ptr[i + 1]; p++) {
+            sum += A->val[p] * x[A->col[p]];
+        }
+        y[i] = sum;
+    }
+}
+
+void csr_free(csr_t *A) {
+    free(A->row_ptr);
+    free(A->col);
+    free(A->val);
+    memset(A, 0, sizeof(*A));
+}
+
+static void slice_scalar(const double *val, const int *col, int width, const double *x, double *sum) {
+    for (int l = 0; l < SELL_C; l++) {
+        sum[l] = 0.0;
+    }
+    for (int j = 0; j < width; j++) {
+        for (int l = 0; l < SELL_C; l++) {
+            sum[l] += val[j * SELL_C + l] * x[col[j * SELL_C + l]];
+        }
+    }
+}
+
+#ifdef SPARSE_X86
+__attribute__((target("avx2,fma")))
+static void slice_avx2(const double *val, const int *col, int width, const double *x, double *sum) {
+    __m256d lo = _mm256_setzero_pd(), hi = _mm256_setzero_pd();
+    for (int j = 0; j < width; j++) {
+        const int *c = col + j * SELL_C;
+        __m256d xlo = _mm256_i32gather_pd(x, _mm_loadu_si128((const __m128i*) c), 8);
+        __m256d xhi = _mm256_i32gather_pd(x, _mm_loadu_si128((const __m128i*) (c + 4)), 8);
+        lo = _mm256_fmadd_pd(_mm256_loadu_pd(val + j * SELL_C), xlo, lo);
+        hi = _mm256_fmadd_pd(_mm256_loadu_pd(val + j * SELL_C + 4), xhi, hi);
+    }
+    _mm256_storeu_pd(sum, lo);
+    _mm256_storeu_pd(sum + 4, hi);
+}
+
+__attribute__((target("avx512f")))
+static void slice_avx512(const double *val, const int *col, int width, const double *x, double *sum) {
+    __m512d acc = _mm512_setzero_pd();
+    for (int j = 0; j < width; j++) {
+        __m256i c = _mm256_loadu_si256((const __m256i*) (col + j * SELL_C));
+        acc = _mm512_fmadd_pd(_mm512_loadu_pd(val + j * SELL_C), _mm512_i32gather_pd(c, x, 8), acc);
+    }
+    _mm512_storeu_pd(sum, acc);
+}
+#endif
+
+typedef struct {
+    long length;
+    int row;
+} sell_key_t;
+
+// Longest first; equal lengths keep their row order, so the layout does not depend on qsort.
+static int by_length(const void *a, const void *b) {
+    const sell_key_t *x = (const sell_key_t*) a, *y = (const sell_key_t*) b;
+    if (x->length != y->length) {
+        return (x->length > y->length) ? -1 : 1;
+    }
+    return (x->row > y->row) - (x->row < y->row);
+}
+
+int sell_alloc(sell_t *S, const csr_t *A, int sigma) {
+    memset(S, 0, sizeof(*S));
+    S->rows = A->rows;
+    S->cols = A->cols;
+    S->sigma = sigma;
+    S->slices = (A->rows + SELL_C - 1) / SELL_C;
+    size_t lanes = (size_t) S->slices * SELL_C;
+    int window = (sigma < A->rows) ? sigma : A->rows;
+    S->slice_ptr = (long*) malloc((size_t) (S->slices + 1) * sizeof(long));
+    S->slice_width = (int*) malloc((size_t) (S->slices > 0 ? S->slices : 1) * sizeof(int));
+    S->row = (int*) malloc((lanes > 0 ? lanes : 1) * sizeof(int));
+    sell_key_t *keys = (sell_key_t*) malloc((size_t) (window > 0 ? window : 1) * sizeof(sell_key_t));
+    if (!S->slice_ptr || !S->slice_width || !S->row || !keys) {
+        free(keys);
+        return -1;
+    }
+    // Sort each window of sigma rows by length; sigma is a multiple of SELL_C, so no slice spans two windows.
+    for (int w = 0; w < A->rows; w += sigma) {
+        int n = (A->rows - w < sigma) ? A->rows - w : sigma;
+        for (int i = 0; i < n; i++) {
+            keys[i].length = A->row_ptr[w + i + 1] - A->row_ptr[w + i];
+            keys[i].row = w + i;
+        }
+        qsort(keys, n, sizeof(sell_key_t), by_length);
+        for (int i = 0; i < n; i++) {
+            S->row[w + i] = keys[i].row;
+        }
+    }
+    free(keys);
+    for (size_t l = (size_t) A->rows; l < lanes; l++) {
+        S->row[l] = -1;
+    }
+    S->slice_ptr[0] = 0;
+    for (int s = 0; s < S->slices; s++) {
+        long width = 0;
+        for (int l = 0; l < SELL_C; l++) {
+            int r = S->row[(size_t) s * SELL_C + l];
+            long length = (r >= 0) ? A->row_ptr[r + 1] - A->row_ptr[r] : 0;
+            width = (length > width) ? length : width;
+        }
+        S->slice_width[s] = (int) width;
+        S->slice_ptr[s + 1] = S->slice_ptr[s] + width * SELL_C;
+    }
+    long stored = S->slice_ptr[S->slices];
+    S->col = (int*) malloc((size_t) (stored > 0 ? stored : 1) * sizeof(int));
+    S->val = (double*) malloc((size_t) (stored > 0 ? stored : 1) * sizeof(double));
+
+    S->isa = "scalar";
+    S->slice = slice_scalar;
+#ifdef SPARSE_X86
+    if (__builtin_cpu_supports("avx512f")) {
+        S->isa = "avx512";
+        S->slice = slice_avx512;
+    } else if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        S->isa = "avx2";
+        S->slice = slice_avx2;
+    }
+#endif
+    return (S->col && S->val) ? 0 : -1;
+}
+
+void sell_fill(sell_t *S, const csr_t *A, int slice_begin, int slice_end) {
+    for (int s = slice_begin; s < slice_end; s++) {
+        for (int l = 0; l < SELL_C; l++) {
+            int r = S->row[(size_t) s * SELL_C + l];
+            long start = (r >= 0) ? A->row_ptr[r] : 0;
+            long length = (r >= 0) ? A->row_ptr[r + 1] - start : 0;
+            for (long j = 0; j < S->slice_width[s]; j++) {
+                long at = S->slice_ptr[s] + j * SELL_C + l;
+                S->col[at] = (j < length) ? A->col[start + j] : 0;
+                S->val[at] = (j < length) ? A->val[start + j] : 0.0;
+            }
+        }
+    }
+}
+
+void sell_spmv(const sell_t *S, const double *x, double *y, int slice_begin, int slice_end) {
+    double sum[SELL_C];
+    for (int s = slice_begin; s < slice_end; s++) {
+        S->slice(S->val + S->slice_ptr[s], S->col + S->slice_ptr[s], S->slice_width[s], x, sum);
+        for (int l = 0; l < SELL_C; l++) {
+            int r = S->row[(size_t) s * SELL_C + l];
+            if (r >= 0) {
+                y[r] = sum[l];
+            }
+        }
+    }
+}
+
+void sell_free(sell_t *S) {
+    free(S->slice_ptr);
+    free(S->slice_width);
+    free(S->row);
+    free(S->col);
+    free(S->val);
+    memset(S, 0, sizeof(*S));
+}
+
+void sparse_partition(const long *prefix, int n, int parts, int by_weight, int *bounds) {
+    bounds[0] = 0;
+    for (int t = 1; t < parts; t++) {
+        if (by_weight) {
+            // First item whose preceding weight reaches t / parts of the total.
+            double target = (double) prefix[n] * t / parts;
+            int lo = bounds[t - 1], hi = n;
+            while (lo < hi) {
+                int mid = lo + (hi - lo) / 2;
+                if (prefix[mid] >= target) {
+                    hi = mid;
+                } else {
+                    lo = mid + 1;
+                }
+            }
+            bounds[t] = lo;
+        } else {
+            bounds[t] = t * (n / parts) + (t < n % parts ? t : n % parts);
+        }
+    }
+    bounds[parts] = n;
+}
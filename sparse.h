@@ -0,0 +1,108 @@
+// File: sparse.h
+// Name: Bradley Stephen
+// Date: October 16, 2026
+// Assignment: MP1 - Sparse Matrix-Vector Multiplication
+//
+// Description:
+//   Sparse matrices for the matrix-vector drivers, in two formats:
+//     CSR        row_ptr / col / val, one row after another.
+//     SELL-C-s   Sliced ELLPACK: rows are sorted by length inside windows of sigma rows, then cut
+//                into slices of SELL_C rows. A slice is stored column by column, padded to its
+//                longest row, so its SELL_C rows are multiplied lane by lane with one SIMD gather
+//                of B per column. Sorting keeps the rows of a slice of similar length, which bounds
+//                the padding; sigma trades that against how far rows move from their place.
+//   Matrices are generated, never read: every row is a pure function of (seed, global row), like
+//   input.h, so a thread or rank builds any block of rows on its own:
+//     banded:W    row i holds the 2W + 1 columns around its diagonal position i * cols / rows
+//     powerlaw:D  row lengths follow a Pareto law (shape SPARSE_POWERLAW_SHAPE) with mean about D,
+//                 and column c is picked with density ~ c^(1/SPARSE_POWERLAW_SKEW - 1), so a few
+//                 low columns are shared by most rows, like the hubs of a scale-free graph
+//   The structure comes from stream INPUT_PATTERN and the values from stream INPUT_A (--init).
+//   Work is split between threads with sparse_partition(): by nonzeros (stored elements for SELL)
+//   by default, since with skewed rows an equal number of rows is far from equal work.
+//
+#ifndef SPARSE_H
+#define SPARSE_H
+
+#include <stddef.h>
+#include "input.h"
+
+#define SELL_C 8                     // Rows per slice: one AVX-512 register of doubles.
+#define SPARSE_DEFAULT_SIGMA 256
+#define SPARSE_DEFAULT_BAND 8
+#define SPARSE_POWERLAW_SHAPE 1.5
+#define SPARSE_POWERLAW_SKEW 3.0
+
+typedef enum { SPARSE_BANDED, SPARSE_POWERLAW } sparse_pattern_t;
+
+typedef struct {
+    sparse_pattern_t pattern;
+    int param;        // Band half-width W, or mean nonzeros per row D.
+    int sigma;        // SELL sorting window in rows, a multiple of SELL_C.
+    int balance_nnz;  // Split rows between threads by nonzeros (1) or by count (0).
+} sparse_opts_t;
+
+// Set the defaults (banded:SPARSE_DEFAULT_BAND, sigma SPARSE_DEFAULT_SIGMA, balanced by nonzeros).
+void sparse_defaults(sparse_opts_t *o);
+
+// Consume --sparse=banded:W|powerlaw:D, --sigma=S or --balance=nnz|rows. Returns 1 if arg was
+// one, 0 if it is not ours, -1 if its value is bad (the bench_parse_arg() convention).
+int sparse_parse_arg(sparse_opts_t *o, const char *arg);
+
+// "banded:W" or "powerlaw:D".
+void sparse_name(const sparse_opts_t *o, char *buf, size_t size);
+
+typedef struct {
+    int rows, cols;
+    long global_rows;  // The block is global rows [row_first, row_first + rows) of global_rows.
+    long row_first;
+    long nnz;
+    long *row_ptr;     // rows + 1 offsets into col and val.
+    int *col;          // Column of every nonzero, ascending within a row.
+    double *val;
+} csr_t;
+
+// Allocate rows [row_first, row_first + rows) of the generated global_rows x cols matrix with
+// row_ptr filled in; col and val are written by csr_fill(). Returns 0 on success, -1 if an
+// allocation fails.
+int csr_alloc(csr_t *A, const sparse_opts_t *o, const input_t *in, long global_rows, int cols, long row_first,
+              int rows);
+
+// Generate local rows [row_begin, row_end).
+void csr_fill(csr_t *A, const sparse_opts_t *o, const input_t *in, int row_begin, int row_end);
+
+// y[i] = row i of A . x for row_begin <= i < row_end.
+void csr_spmv(const csr_t *A, const double *x, double *y, int row_begin, int row_end);
+
+void csr_free(csr_t *A);
+
+typedef struct {
+    int rows, cols, sigma;
+    int slices;         // ceil(rows / SELL_C).
+    long *slice_ptr;    // slices + 1 offsets into col and val; slice s holds slice_width[s] * SELL_C.
+    int *slice_width;   // Longest row of each slice.
+    int *row;           // slices * SELL_C: the row in lane l of slice s, or -1 past the last row.
+    int *col;           // Entry j of lane l of slice s at slice_ptr[s] + j * SELL_C + l; padding
+    double *val;        // reads column 0 with value 0.
+    const char *isa;    // SIMD variant picked for this CPU.
+    void (*slice)(const double *val, const int *col, int width, const double *x, double *sum);
+} sell_t;
+
+// Lay out a SELL-C-sigma copy of A (only its row lengths are read). Returns 0 on success, -1 if
+// an allocation fails.
+int sell_alloc(sell_t *S, const csr_t *A, int sigma);
+
+// Copy slices [slice_begin, slice_end) from A, which must be filled.
+void sell_fill(sell_t *S, const csr_t *A, int slice_begin, int slice_end);
+
+// y[row] = row . x for every row of slices [slice_begin, slice_end).
+void sell_spmv(const sell_t *S, const double *x, double *y, int slice_begin, int slice_end);
+
+void sell_free(sell_t *S);
+
+// Split n items into parts: part t gets [bounds[t], bounds[t + 1]). With by_weight the parts get
+// about equal shares of the cumulative weights prefix[0..n] (prefix[0] = 0; a CSR row_ptr or a
+// SELL slice_ptr); otherwise equal counts.
+void sparse_partition(const long *prefix, int n, int parts, int by_weight, int *bounds);
+
+#endif
@@ -0,0 +1,177 @@
+// File: thread_pool.c
+// Name: Bradley Stephen
+// Date: October 16, 2026
+// Assignment: MP1 - Persistent Pthread Worker Pool
+//
+// Description:
+//   Epoch-counter thread pool (see thread_pool.h). Workers spin briefly on the epoch word
+//   and then sleep in FUTEX_WAIT, so idle workers do not burn a core. Completion is a countdown
+//   plus a second futex word. Each word has a count of the threads parked on it, and FUTEX_WAKE
+//   is only issued when that count is non-zero, so back-to-back runs whose waiters are still
+//   spinning are dispatched and completed without a syscall.
+//   When the pool has more threads than online CPUs, spinning only delays the thread being
+//   waited for, so waiters go straight to the futex.
+// Usage:
+//   Compile together with a driver and link with -lpthread.
+//
+#include <limits.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include "thread_pool.h"
+
+#define POOL_SPIN_LIMIT 4000
+
+struct thread_pool {
+    int nthreads;
+    int spin_limit;           // Spins before sleeping (0 when oversubscribed).
+    pthread_t *threads;
+    _Atomic unsigned epoch;   // Incremented to publish a task (futex word for workers).
+    _Atomic unsigned done;    // Incremented when the last worker finishes (futex word for the caller).
+    _Atomic int epoch_sleepers;  // Threads in FUTEX_WAIT on epoch, and on done.
+    _Atomic int done_sleepers;
+    _Atomic int remaining;    // Workers still running the current task.
+    _Atomic int shutdown;
+    pool_task_fn fn;
+    void *arg;
+};
+
+typedef struct {
+    thread_pool_t *pool;
+    int tid;
+} WorkerArg;
+
+static void futex_wait(_Atomic unsigned *word, unsigned expected) {
+    syscall(SYS_futex, (unsigned*) word, FUTEX_WAIT_PRIVATE, expected, NULL, NULL, 0);
+}
+
+static void futex_wake(_Atomic unsigned *word) {
+    syscall(SYS_futex, (unsigned*) word, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+}
+
+// Increment *word and wake its sleepers, if any. Both this and wait_for_change() use seq_cst, so
+// either the sleeper count read here includes a thread about to sleep, or that thread's
+// FUTEX_WAIT sees the new value and returns at once.
+static void bump_and_wake(_Atomic unsigned *word, _Atomic int *sleepers) {
+    atomic_fetch_add_explicit(word, 1, memory_order_seq_cst);
+    if (atomic_load_explicit(sleepers, memory_order_seq_cst) > 0) {
+        futex_wake(word);
+    }
+}
+
+static inline void cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+// Spin for a while, then sleep, until *word no longer equals seen. Returns the new value.
+static unsigned wait_for_change(_Atomic unsigned *word, _Atomic int *sleepers, unsigned seen, int spin_limit) {
+    unsigned now;
+    int spins = 0;
+    while ((now = atomic_load_explicit(word, memory_order_acquire)) == seen) {
+        if (++spins < spin_limit) {
+            cpu_relax();
+        } else {
+            atomic_fetch_add_explicit(sleepers, 1, memory_order_seq_cst);
+            futex_wait(word, seen);
+            atomic_fetch_sub_explicit(sleepers, 1, memory_order_relaxed);
+        }
+    }
+    return now;
+}
+
+static void* pool_worker(void *arg) {
+    WorkerArg *w = (WorkerArg*) arg;
+    thread_pool_t *pool = w->pool;
+    int tid = w->tid;
+    free(w);
+
+    unsigned seen = 0;
+    for (;;) {
+        seen = wait_for_change(&pool->epoch, &pool->epoch_sleepers, seen, pool->spin_limit);
+        if (atomic_load_explicit(&pool->shutdown, memory_order_acquire)) {
+            break;
+        }
+        pool->fn(tid, pool->nthreads, pool->arg);
+        if (atomic_fetch_sub_explicit(&pool->remaining, 1, memory_order_acq_rel) == 1) {
+            bump_and_wake(&pool->done, &pool->done_sleepers);
+        }
+    }
+    return NULL;
+}
+
+thread_pool_t* pool_create(int nthreads) {
+    if (nthreads < 1) {
+        return NULL;
+    }
+    thread_pool_t *pool = (thread_pool_t*) calloc(1, sizeof(thread_pool_t));
+    if (!pool) {
+        return NULL;
+    }
+    pool->nthreads = nthreads;
+    pool->spin_limit = (nthreads <= sysconf(_SC_NPROCESSORS_ONLN)) ? POOL_SPIN_LIMIT : 0;
+    pool->threads = (pthread_t*) malloc(nthreads * sizeof(pthread_t));
+    if (!pool->threads) {
+        free(pool);
+        return NULL;
+    }
+    atomic_init(&pool->epoch, 0);
+    atomic_init(&pool->done, 0);
+    atomic_init(&pool->epoch_sleepers, 0);
+    atomic_init(&pool->done_sleepers, 0);
+    atomic_init(&pool->remaining, 0);
+    atomic_init(&pool->shutdown, 0);
+
+    for (int t = 1; t < nthreads; t++) {
+        WorkerArg *w = (WorkerArg*) malloc(sizeof(WorkerArg));
+        if (w) {
+            w->pool = pool;
+            w->tid = t;
+        }
+        if (!w || pthread_create(&pool->threads[t], NULL, pool_worker, w) != 0) {
+            free(w);
+            // Shut down the workers that did start.
+            pool->nthreads = t;
+            pool_destroy(pool);
+            return NULL;
+        }
+    }
+    return pool;
+}
+
+void pool_run(thread_pool_t *pool, pool_task_fn fn, void *arg) {
+    pool->fn = fn;
+    pool->arg = arg;
+    atomic_store_explicit(&pool->remaining, pool->nthreads - 1, memory_order_relaxed);
+    unsigned done = atomic_load_explicit(&pool->done, memory_order_relaxed);
+    if (pool->nthreads > 1) {
+        bump_and_wake(&pool->epoch, &pool->epoch_sleepers);
+    }
+
+    fn(0, pool->nthreads, arg);
+
+    if (pool->nthreads > 1) {
+        wait_for_change(&pool->done, &pool->done_sleepers, done, pool->spin_limit);
+    }
+}
+
+void pool_destroy(thread_pool_t *pool) {
+    if (!pool) {
+        return;
+    }
+    atomic_store_explicit(&pool->shutdown, 1, memory_order_release);
+    bump_and_wake(&pool->epoch, &pool->epoch_sleepers);
+    for (int t = 1; t < pool->nthreads; t++) {
+        pthread_join(pool->threads[t], NULL);
+    }
+    free(pool->threads);
+    free(pool);
+}
+
+int pool_size(const thread_pool_t *pool) {
+    return pool->nthreads;
+}
@@ -0,0 +1,30 @@
+// File: thread_pool.h
+// Name: Bradley Stephen
+// Date: October 16, 2026
+// Assignment: MP1 - Persistent Pthread Worker Pool
+//
+// Description:
+//   A fixed-size pool of pthreads created once and reused for every run.
+//   pool_run() publishes a task by bumping an epoch counter; parked workers wake on a futex,
+//   run the task with their thread id, and the last one to finish wakes the caller.
+//   The calling thread takes part as thread 0, so a pool of n threads starts n - 1 pthreads.
+//
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+typedef void (*pool_task_fn)(int tid, int nthreads, void *arg);
+
+typedef struct thread_pool thread_pool_t;
+
+// Start a pool of nthreads threads (including the caller). Returns NULL on failure.
+thread_pool_t* pool_create(int nthreads);
+
+// Run fn(tid, nthreads, arg) once on every thread of the pool and wait for all of them.
+void pool_run(thread_pool_t *pool, pool_task_fn fn, void *arg);
+
+// Stop and join the workers, then free the pool.
+void pool_destroy(thread_pool_t *pool);
+
+int pool_size(const thread_pool_t *pool);
+
+#endif
@@ -0,0 +1,80 @@
+// File: verify.c
+// Name: Bradley Stephen
+// Date: October 16, 2026
+// Assignment: MP1 - Result Verification
+//
+// Description:
+//   Implementation of verify.h. Each product is rounded once before it is summed; that error
+//   is covered by the n * u bound together with the summation error.
+//
+#include <float.h>
+#include <math.h>
+#include "verify.h"
+
+void verify_dot_ref(const double *A, const double *B, long b_stride, long n, verify_ref_t *ref) {
+    kahan_t value = {0.0, 0.0};
+    double magnitude = 0.0;
+    for (long i = 0; i < n; i++) {
+        double p = A[i] * B[i * b_stride];
+        kahan_add(&value, p);
+        magnitude += fabs(p);
+    }
+    ref->value = value;
+    ref->magnitude = magnitude;
+    ref->n = n;
+}
+
+void verify_gather_ref(const double *A, const int *index, const double *B, long n, verify_ref_t *ref) {
+    kahan_t value = {0.0, 0.0};
+    double magnitude = 0.0;
+    for (long i = 0; i < n; i++) {
+        double p = A[i] * B[index[i]];
+        kahan_add(&value, p);
+        magnitude += fabs(p);
+    }
+    ref->value = value;
+    ref->magnitude = magnitude;
+    ref->n = n;
+}
+
+void verify_ref_merge(verify_ref_t *into, const verify_ref_t *part) {
+    kahan_add(&into->value, part->value.sum);
+    kahan_add(&into->value, part->value.comp);
+    into->magnitude += part->magnitude;
+    into->n += part->n;
+}
+
+double verify_ref_value(const verify_ref_t *ref) {
+    return kahan_result(&ref->value);
+}
+
+double verify_tolerance(const verify_ref_t *ref) {
+    return verify_tolerance_mixed(ref, 0.0, DBL_EPSILON / 2);
+}
+
+int verify_check(double got, const verify_ref_t *ref) {
+    return fabs(got - verify_ref_value(ref)) <= verify_tolerance(ref);
+}
+
+double verify_tolerance_mixed(const verify_ref_t *ref, double u_store, double u_sum) {
+    double ref_value = verify_ref_value(ref);
+    double ulp = nextafter(fabs(ref_value), INFINITY) - fabs(ref_value);
+    // The rounded terms are up to (1 + u_store)^2 times larger than the reference's, and the
+    // magnitude itself was summed with up to n roundings; (n + 1) covers that too.
+    double grow = (1 + u_store) * (1 + u_store);
+    return ((grow - 1) + (ref->n + 1) * u_sum * grow) * ref->magnitude + VERIFY_ULPS * ulp;
+}
+
+int verify_check_mixed(double got, const verify_ref_t *ref, double u_store, double u_sum) {
+    return fabs(got - verify_ref_value(ref)) <= verify_tolerance_mixed(ref, u_store, u_sum);
+}
+
+double verify_scaled_error(double got, const verify_ref_t *ref) {
+    double error = fabs(got - verify_ref_value(ref));
+    return (ref->magnitude > 0) ? error / ref->magnitude : error;
+}
+
+double verify_ulp_error(double got, double ref) {
+    double ulp = nextafter(fabs(ref), INFINITY) - fabs(ref);
+    return fabs(got - ref) / ulp;
+}
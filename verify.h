@@ -0,0 +1,79 @@
+// File: verify.h
+// Name: Bradley Stephen
+// Date: October 16, 2026
+// Assignment: MP1 - Result Verification
+//
+// Description:
+//   Tolerant verification for the dot product and matrix-vector drivers. The reference is a
+//   compensated (Neumaier) sum, so it is accurate to about one rounding regardless of length.
+//   A result passes when it is within the worst-case error of any summation order:
+//       |got - ref| <= n * u * sum|a_i * b_i| + VERIFY_ULPS ulp(ref)
+//   where u = DBL_EPSILON / 2. This accepts SIMD kernels, reordered and parallel reductions
+//   and arbitrary input data, which exact equality against a serial loop does not.
+//   References are built per chunk with verify_dot_ref() and combined with verify_ref_merge(),
+//   so callers can compute them in parallel over the same chunks as the timed kernel.
+//
+#ifndef VERIFY_H
+#define VERIFY_H
+
+// Slack on top of the n-scaled bound, for the final rounding of the result itself.
+#define VERIFY_ULPS 4
+
+// Neumaier's variant of Kahan summation: the lost low-order bits are kept in comp.
+typedef struct {
+    double sum;
+    double comp;
+} kahan_t;
+
+static inline void kahan_add(kahan_t *k, double x) {
+    double t = k->sum + x;
+    if ((k->sum >= 0 ? k->sum : -k->sum) >= (x >= 0 ? x : -x)) {
+        k->comp += (k->sum - t) + x;
+    } else {
+        k->comp += (x - t) + k->sum;
+    }
+    k->sum = t;
+}
+
+static inline double kahan_result(const kahan_t *k) {
+    return k->sum + k->comp;
+}
+
+// Reference for one dot product (or a chunk of one).
+typedef struct {
+    kahan_t value;     // Compensated sum of a_i * b_i.
+    double magnitude;  // Sum of |a_i * b_i|, which scales the rounding error.
+    long n;            // Terms summed.
+} verify_ref_t;
+
+// Reference for sum(A[i] * B[i * b_stride]) over i in [0, n).
+void verify_dot_ref(const double *A, const double *B, long b_stride, long n, verify_ref_t *ref);
+
+// Reference for sum(A[i] * B[index[i]]) over i in [0, n): a sparse row against a dense vector.
+void verify_gather_ref(const double *A, const int *index, const double *B, long n, verify_ref_t *ref);
+
+// Add the chunk `part` into `into` (an all-zero verify_ref_t is the empty reference).
+void verify_ref_merge(verify_ref_t *into, const verify_ref_t *part);
+
+double verify_ref_value(const verify_ref_t *ref);
+
+// Largest error allowed for a result checked against ref.
+double verify_tolerance(const verify_ref_t *ref);
+
+// Returns 1 if got is within verify_tolerance of the reference, 0 otherwise.
+int verify_check(double got, const verify_ref_t *ref);
+
+// verify_tolerance() when every operand was rounded with relative error at most u_store before the
+// multiply and the products were summed with unit roundoff u_sum (verify_tolerance() is u_store = 0,
+// u_sum = DBL_EPSILON / 2): each product is then off by up to (1 + u_store)^2 - 1 before the sum.
+double verify_tolerance_mixed(const verify_ref_t *ref, double u_store, double u_sum);
+
+int verify_check_mixed(double got, const verify_ref_t *ref, double u_store, double u_sum);
+
+// |got - ref| / sum|a_i * b_i|: the error relative to the terms, which stays meaningful when they cancel.
+double verify_scaled_error(double got, const verify_ref_t *ref);
+
+// Distance from got to ref in units in the last place of ref.
+double verify_ulp_error(double got, double ref);
+
+#endif